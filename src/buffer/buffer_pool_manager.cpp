@@ -1,168 +1,239 @@
 #include "buffer/buffer_pool_manager.h"
 
+#include <algorithm>
+#include <chrono>
+#include <unordered_set>
+
 #include "glog/logging.h"
 #include "page/bitmap_page.h"
 
-static const char EMPTY_PAGE_DATA[PAGE_SIZE] = {0};
-
-BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager)
+BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager, size_t num_instances,
+                                     ReplacerType replacer_type)
     : pool_size_(pool_size), disk_manager_(disk_manager) {
-  pages_ = new Page[pool_size_];
-  replacer_ = new LRUReplacer(pool_size_);
-  for (size_t i = 0; i < pool_size_; i++) {
-    free_list_.emplace_back(i);
+  ASSERT(num_instances > 0 && pool_size > 0, "Invalid number of buffer pool instances.");
+  // every instance needs a frame, a small pool gets fewer instances
+  num_instances = std::min(num_instances, pool_size);
+  // spread the frames as evenly as possible, the first (pool_size % num_instances) instances get one more frame
+  for (size_t i = 0; i < num_instances; i++) {
+    size_t instance_size = pool_size / num_instances + (i < pool_size % num_instances ? 1 : 0);
+    instances_.emplace_back(new BufferPoolManagerInstance(instance_size, disk_manager_, replacer_type));
   }
 }
 
 BufferPoolManager::~BufferPoolManager() {
-  for (auto page : page_table_) {
-    FlushPage(page.first);
+  {
+    std::scoped_lock<std::mutex> lock(prefetch_latch_);
+    prefetch_stop_ = true;
+  }
+  prefetch_cv_.notify_all();
+  if (prefetcher_.joinable()) {
+    prefetcher_.join();
+  }
+  StopFlusher();
+  FlushAllPages();
+  for (auto instance : instances_) {
+    delete instance;
   }
-  delete[] pages_;
-  delete replacer_;
 }
 
-/**
- * Student Implement
- */
 Page *BufferPoolManager::FetchPage(page_id_t page_id) {
-  // 1.     Search the page table for the requested page (P).
-  if (page_table_.find(page_id) != page_table_.end()) {
-    // 1.1    If P exists, pin it and return it immediately.
-    frame_id_t frame_id = page_table_[page_id];
-    pages_[frame_id].pin_count_++;
-    replacer_->Pin(frame_id);
-    return &pages_[frame_id];
-  } else {
-    // 1.2    If P does not exist, find a replacement page (R) from either the free list or the replacer.
-    //        Note that pages are always found from the free list first.
-    frame_id_t frame_id = INVALID_PAGE_ID;
-    if (!free_list_.empty()) {
-      frame_id = free_list_.front();
-      free_list_.pop_front();
-    } else {
-      if (!replacer_->Victim(&frame_id)) {
-        return nullptr;
-      }
-    }
-    // 2.     If R is dirty, write it back to the disk.
-    if (pages_[frame_id].IsDirty()) {
-      FlushPage(pages_[frame_id].GetPageId());
-    }
-    // 3.     Delete R from the page table and insert P.
-    page_table_.erase(pages_[frame_id].GetPageId());
-    page_table_[page_id] = frame_id;
-    // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
-    pages_[frame_id].page_id_ = page_id;
-    pages_[frame_id].pin_count_ = 1;
-    pages_[frame_id].ResetMemory();
-    disk_manager_->ReadPage(page_id, pages_[frame_id].GetData());
-    replacer_->Pin(frame_id);
-    return &pages_[frame_id];
-  } 
+  return GetInstance(page_id)->FetchPage(page_id);
+}
+
+ReadPageGuard BufferPoolManager::FetchPageRead(page_id_t page_id) {
+  Page *page = FetchPage(page_id);
+  if (page == nullptr) {
+    return {};
+  }
+  page->RLatch();
+  return {this, page};
+}
+
+WritePageGuard BufferPoolManager::FetchPageWrite(page_id_t page_id) {
+  if (IsReadOnly()) {
+    return {};
+  }
+  Page *page = FetchPage(page_id);
+  if (page == nullptr) {
+    return {};
+  }
+  page->WLatch();
+  return {this, page};
 }
 
 /**
- * Student Implement
+ * The page id is handed out by the disk manager first, since only then do we know which instance owns the page. If
+ * that instance has no frame to spare, the id is held on to and another one is allocated, which usually belongs to
+ * another instance; giving the id back right away would only hand out the same id again. Once a page got a frame,
+ * every instance had a try or twice as many ids as instances were tried, the ids held on to are given back to the disk
+ * manager.
  */
 Page *BufferPoolManager::NewPage(page_id_t &page_id) {
-  // 0.   Make sure you call AllocatePage!
-  // 1.   If all the pages in the buffer pool are pinned, return nullptr.
-  if (free_list_.empty() && replacer_->Size() == 0) {
-    return nullptr;
-  }
-  // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
-  frame_id_t frame_id = INVALID_PAGE_ID;
-  if (!free_list_.empty()) {
-    frame_id = free_list_.front();
-    free_list_.pop_front();
-  } else {
-    if (!replacer_->Victim(&frame_id)) {
-      return nullptr;
+  vector<page_id_t> skipped_page_ids;
+  vector<bool> is_full(instances_.size(), false);
+  size_t num_full = 0;
+  Page *page = nullptr;
+  while (page == nullptr && num_full < instances_.size() && skipped_page_ids.size() < 2 * instances_.size()) {
+    page_id_t new_page_id = AllocatePage();
+    if (new_page_id == INVALID_PAGE_ID) {
+      break;
     }
+    page = GetInstance(new_page_id)->NewPage(new_page_id);
+    if (page == nullptr) {
+      skipped_page_ids.push_back(new_page_id);
+      size_t index = static_cast<size_t>(new_page_id) % instances_.size();
+      num_full += is_full[index] ? 0 : 1;
+      is_full[index] = true;
+    } else {
+      page_id = new_page_id;
+    }
+  }
+  for (auto skipped_page_id : skipped_page_ids) {
+    DeallocatePage(skipped_page_id);
   }
-  // 3.   Update P's metadata, zero out memory and add P to the page table.
-  // 4.   Set the page ID output parameter. Return a pointer to P.
-  page_table_.erase(pages_[frame_id].GetPageId());
-  page_id = AllocatePage();
-  page_table_[page_id] = frame_id;
-  pages_[frame_id].page_id_ = page_id;
-  pages_[frame_id].pin_count_ = 1;
-  pages_[frame_id].is_dirty_ = false;
-  pages_[frame_id].ResetMemory();
-  replacer_->Pin(frame_id);
-  return &pages_[frame_id];
+  return page;
+}
+
+WritePageGuard BufferPoolManager::NewPageWrite(page_id_t &page_id) {
+  if (IsReadOnly()) {
+    return {};
+  }
+  Page *page = NewPage(page_id);
+  if (page == nullptr) {
+    return {};
+  }
+  page->WLatch();
+  WritePageGuard guard(this, page);
+  guard.MarkDirty();
+  return guard;
 }
 
-/**
- * Student Implement
- */
 bool BufferPoolManager::DeletePage(page_id_t page_id) {
-  // 0.   Make sure you call DeallocatePage!
-  // 1.   Search the page table for the requested page (P).
-  if (page_table_.find(page_id) == page_table_.end()) {
-    // 1.1   If P does not exist, return true.
-    return true;
-  } else {
-    // 1.2   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
-    frame_id_t frame_id = page_table_[page_id];
-    if (pages_[frame_id].pin_count_ != 0) {
-      return false;
-    }
-    // 2.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
-    page_table_.erase(page_id);
+  if (disk_manager_->IsMapped()) {
+    return false;
+  }
+  if (!GetInstance(page_id)->DeletePage(page_id)) {
+    return false;
+  }
+  // a page which is not resident is deallocated as well, unless it was never allocated
+  if (!IsPageFree(page_id)) {
     DeallocatePage(page_id);
-    pages_[frame_id].page_id_ = INVALID_PAGE_ID;
-    pages_[frame_id].pin_count_ = 0;
-    pages_[frame_id].is_dirty_ = false;
-    pages_[frame_id].ResetMemory();
-    free_list_.push_back(frame_id);
-    return true;
   }
+  return true;
 }
 
-/**
- * Student Implement
- */
 bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
-  // 1.   Search the page table for the requested page (P).
-  if (page_table_.find(page_id) == page_table_.end()) {
-    // 1.1   If P does not exist, return true.
-    return true;
-  } else {
-    frame_id_t frame_id = page_table_[page_id];
-    // 1.2   If P exists, but has a zero pin-count, return false.
-    if (pages_[frame_id].pin_count_ == 0) {
-      return false;
-    } else {
-      // 2.   Otherwise, unpin P and, if is_dirty is true, set the dirty flag of P.
-      pages_[frame_id].pin_count_--;
-      if (is_dirty) {
-        pages_[frame_id].is_dirty_ = true;
+  return GetInstance(page_id)->UnpinPage(page_id, is_dirty);
+}
+
+bool BufferPoolManager::FlushPage(page_id_t page_id) {
+  return GetInstance(page_id)->FlushPage(page_id);
+}
+
+void BufferPoolManager::FlushAllPages() {
+  for (auto instance : instances_) {
+    instance->FlushAllPages();
+  }
+  // the pages written are only found again if their allocation is on disk as well
+  disk_manager_->FlushMetadata();
+}
+
+void BufferPoolManager::StartFlusher(double target_clean_ratio, int interval_ms) {
+  std::scoped_lock<std::mutex> lock(flusher_latch_);
+  if (flusher_.joinable()) {
+    return;
+  }
+  flusher_stop_ = false;
+  flusher_ = std::thread(&BufferPoolManager::FlusherLoop, this, target_clean_ratio, interval_ms);
+}
+
+void BufferPoolManager::StopFlusher() {
+  {
+    std::scoped_lock<std::mutex> lock(flusher_latch_);
+    if (!flusher_.joinable()) {
+      return;
+    }
+    flusher_stop_ = true;
+  }
+  flusher_cv_.notify_all();
+  flusher_.join();
+}
+
+void BufferPoolManager::FlusherLoop(double target_clean_ratio, int interval_ms) {
+  std::unique_lock<std::mutex> lock(flusher_latch_);
+  while (!flusher_cv_.wait_for(lock, std::chrono::milliseconds(interval_ms), [this] { return flusher_stop_; })) {
+    lock.unlock();
+    for (auto instance : instances_) {
+      auto max_dirty_pages = static_cast<size_t>(instance->GetPoolSize() * (1 - target_clean_ratio));
+      instance->FlushDirtyPages(max_dirty_pages, DEFAULT_FLUSHER_BATCH_SIZE);
+    }
+    lock.lock();
+  }
+}
+
+void BufferPoolManager::PrefetchPages(const vector<page_id_t> &page_ids) {
+  if (disk_manager_->IsMapped()) {
+    disk_manager_->WillNeedPages(page_ids);
+    return;
+  }
+  {
+    std::scoped_lock<std::mutex> lock(prefetch_latch_);
+    if (prefetch_stop_) {
+      return;
+    }
+    for (auto page_id : page_ids) {
+      if (prefetch_queue_.size() >= static_cast<size_t>(PREFETCH_QUEUE_SIZE)) {
+        break;
       }
-      // 3.   If the pin-count of P is equal to zero, put P in the replacer.
-      if (pages_[frame_id].pin_count_ == 0) {
-        replacer_->Unpin(frame_id);
+      if (page_id >= 0) {
+        prefetch_queue_.push_back(page_id);
       }
-      return true;
+    }
+    if (!prefetcher_.joinable()) {
+      prefetcher_ = std::thread(&BufferPoolManager::PrefetchLoop, this);
     }
   }
+  prefetch_cv_.notify_one();
 }
 
-/**
- * Student Implement
- */
-bool BufferPoolManager::FlushPage(page_id_t page_id) {
-  // 1.   Search the page table for the requested page (P).
-  if (page_table_.find(page_id) == page_table_.end()) {
-    // 1.1   If P does not exist, return false.
-    return false;
-  } else {
-    // 1.2   If P exists, then write P to disk and reset its dirty flag.
-    frame_id_t frame_id = page_table_[page_id];
-    disk_manager_->WritePage(page_id, pages_[frame_id].GetData());
-    pages_[frame_id].is_dirty_ = false;
-    return true;
+void BufferPoolManager::PrefetchLoop() {
+  std::unique_lock<std::mutex> lock(prefetch_latch_);
+  while (true) {
+    prefetch_cv_.wait(lock, [this] { return prefetch_stop_ || !prefetch_queue_.empty(); });
+    if (prefetch_stop_) {
+      return;
+    }
+    vector<vector<page_id_t>> page_ids(instances_.size());
+    for (size_t i = 0; i < static_cast<size_t>(PREFETCH_BATCH_SIZE) && !prefetch_queue_.empty(); i++) {
+      page_id_t page_id = prefetch_queue_.front();
+      prefetch_queue_.pop_front();
+      page_ids[static_cast<size_t>(page_id) % instances_.size()].push_back(page_id);
+    }
+    lock.unlock();
+    // reserve frames in every instance, read all pages with one batch, then install them
+    vector<pair<page_id_t, char *>> reads;
+    for (size_t i = 0; i < instances_.size(); i++) {
+      instances_[i]->StartPrefetch(page_ids[i], reads);
+    }
+    // a page which does not match its checksum is discarded, FetchPage reports it; the others are installed
+    vector<bool> valid_reads;
+    disk_manager_->ReadPages(reads, &valid_reads);
+    std::unordered_set<page_id_t> invalid_pages;
+    for (size_t i = 0; i < reads.size(); i++) {
+      if (!valid_reads[i]) {
+        invalid_pages.insert(reads[i].first);
+      }
+    }
+    for (size_t i = 0; i < instances_.size(); i++) {
+      vector<page_id_t> valid_ids;
+      vector<page_id_t> invalid_ids;
+      for (auto page_id : page_ids[i]) {
+        (invalid_pages.count(page_id) == 0 ? valid_ids : invalid_ids).push_back(page_id);
+      }
+      instances_[i]->FinishPrefetch(valid_ids);
+      instances_[i]->FinishPrefetch(invalid_ids, true);
+    }
+    lock.lock();
   }
 }
 
@@ -179,14 +250,35 @@ bool BufferPoolManager::IsPageFree(page_id_t page_id) {
   return disk_manager_->IsPageFree(page_id);
 }
 
+size_t BufferPoolManager::GetNumHits() {
+  size_t num_hits = 0;
+  for (auto instance : instances_) {
+    num_hits += instance->GetNumHits();
+  }
+  return num_hits;
+}
+
+size_t BufferPoolManager::GetNumMisses() {
+  size_t num_misses = 0;
+  for (auto instance : instances_) {
+    num_misses += instance->GetNumMisses();
+  }
+  return num_misses;
+}
+
+size_t BufferPoolManager::GetNumPrefetches() {
+  size_t num_prefetches = 0;
+  for (auto instance : instances_) {
+    num_prefetches += instance->GetNumPrefetches();
+  }
+  return num_prefetches;
+}
+
 // Only used for debug
 bool BufferPoolManager::CheckAllUnpinned() {
   bool res = true;
-  for (size_t i = 0; i < pool_size_; i++) {
-    if (pages_[i].pin_count_ != 0) {
-      res = false;
-      LOG(ERROR) << "page " << pages_[i].page_id_ << " pin count:" << pages_[i].pin_count_ << endl;
-    }
+  for (auto instance : instances_) {
+    res = instance->CheckAllUnpinned() && res;
   }
   return res;
-}
\ No newline at end of file
+}
@@ -0,0 +1,385 @@
+#include "buffer/buffer_pool_manager_instance.h"
+
+#include <algorithm>
+#include <memory>
+
+#include "glog/logging.h"
+
+BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager,
+                                                     ReplacerType replacer_type)
+    : pool_size_(pool_size), disk_manager_(disk_manager) {
+  if (!disk_manager_->IsMapped()) {
+    // aligned, so that O_DIRECT reads and writes need no bounce buffer
+    frame_data_ = static_cast<char *>(aligned_alloc(DiskManager::DIRECT_IO_ALIGNMENT, pool_size_ * PAGE_SIZE));
+    memset(frame_data_, 0, pool_size_ * PAGE_SIZE);
+  }
+  // the pages use the frames' memory instead of owning some
+  pages_ = static_cast<Page *>(::operator new[](pool_size_ * sizeof(Page)));
+  for (size_t i = 0; i < pool_size_; i++) {
+    new (&pages_[i]) Page(frame_data_ == nullptr ? nullptr : frame_data_ + i * PAGE_SIZE);
+  }
+  switch (replacer_type) {
+    case ReplacerType::kLRU:
+      replacer_ = new LRUReplacer(pool_size_);
+      break;
+    case ReplacerType::kLRUK:
+      replacer_ = new LRUKReplacer(pool_size_);
+      break;
+    case ReplacerType::kClock:
+      replacer_ = new CLOCKReplacer(pool_size_);
+      break;
+  }
+  for (size_t i = 0; i < pool_size_; i++) {
+    free_list_.emplace_back(i);
+  }
+}
+
+BufferPoolManagerInstance::~BufferPoolManagerInstance() {
+  FlushAllPages();
+  for (size_t i = 0; i < pool_size_; i++) {
+    pages_[i].~Page();
+  }
+  ::operator delete[](pages_);
+  free(frame_data_);
+  delete replacer_;
+}
+
+Page *BufferPoolManagerInstance::FetchPage(page_id_t page_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  // 1.     Search the page table for the requested page (P).
+  auto iter = page_table_.find(page_id);
+  if (iter != page_table_.end()) {
+    // 1.1    If P exists, pin it and return it immediately.
+    frame_id_t frame_id = iter->second;
+    num_hits_++;
+    pages_[frame_id].pin_count_++;
+    replacer_->Pin(frame_id);
+    return &pages_[frame_id];
+  }
+  // 1.2    If P does not exist, find a replacement page (R) from either the free list or the replacer.
+  // 2.     If R is dirty, write it back to the disk.
+  // 3.     Delete R from the page table and insert P.
+  frame_id_t frame_id = TryToFindFreePage();
+  if (frame_id == INVALID_FRAME_ID) {
+    return nullptr;
+  }
+  num_misses_++;
+  page_table_[page_id] = frame_id;
+  // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
+  pages_[frame_id].page_id_ = page_id;
+  pages_[frame_id].pin_count_ = 1;
+  pages_[frame_id].is_dirty_ = false;
+  bool is_valid = true;
+  if (disk_manager_->IsMapped()) {
+    pages_[frame_id].data_ = const_cast<char *>(disk_manager_->GetMappedPage(page_id));
+    is_valid = pages_[frame_id].data_ != nullptr;
+  } else {
+    pages_[frame_id].ResetMemory();
+    is_valid = disk_manager_->ReadPage(page_id, pages_[frame_id].GetData());
+  }
+  // a page which does not match its checksum is not handed out
+  if (!is_valid) {
+    page_table_.erase(page_id);
+    pages_[frame_id].page_id_ = INVALID_PAGE_ID;
+    pages_[frame_id].pin_count_ = 0;
+    free_list_.push_back(frame_id);
+    return nullptr;
+  }
+  replacer_->Pin(frame_id);
+  return &pages_[frame_id];
+}
+
+Page *BufferPoolManagerInstance::NewPage(page_id_t page_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  InvalidatePrefetch(page_id);
+  // 1.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
+  //      If all the pages in the buffer pool are pinned, return nullptr.
+  //      A stale copy of the page may still be resident, e.g. read ahead after it was freed, its frame is reused.
+  frame_id_t frame_id = INVALID_FRAME_ID;
+  auto iter = page_table_.find(page_id);
+  if (iter != page_table_.end()) {
+    frame_id = iter->second;
+    ASSERT(pages_[frame_id].pin_count_ == 0, "Allocated a page which is still pinned.");
+  } else {
+    frame_id = TryToFindFreePage();
+  }
+  if (frame_id == INVALID_FRAME_ID) {
+    return nullptr;
+  }
+  // 2.   Update P's metadata, zero out memory and add P to the page table.
+  page_table_[page_id] = frame_id;
+  pages_[frame_id].page_id_ = page_id;
+  pages_[frame_id].pin_count_ = 1;
+  pages_[frame_id].is_dirty_ = false;
+  pages_[frame_id].ResetMemory();
+  replacer_->Pin(frame_id);
+  return &pages_[frame_id];
+}
+
+bool BufferPoolManagerInstance::DeletePage(page_id_t page_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  InvalidatePrefetch(page_id);
+  // 1.   Search the page table for the requested page (P).
+  auto iter = page_table_.find(page_id);
+  if (iter == page_table_.end()) {
+    // 1.1   If P does not exist, return true.
+    return true;
+  }
+  // 1.2   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
+  frame_id_t frame_id = iter->second;
+  if (pages_[frame_id].pin_count_ != 0) {
+    return false;
+  }
+  // 2.   Otherwise, P can be deleted. Remove P from the page table and the replacer, reset its metadata and return it
+  //      to the free list.
+  page_table_.erase(iter);
+  replacer_->Remove(frame_id);
+  pages_[frame_id].page_id_ = INVALID_PAGE_ID;
+  pages_[frame_id].pin_count_ = 0;
+  pages_[frame_id].is_dirty_ = false;
+  pages_[frame_id].ResetMemory();
+  free_list_.push_back(frame_id);
+  return true;
+}
+
+bool BufferPoolManagerInstance::UnpinPage(page_id_t page_id, bool is_dirty) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  // 1.   Search the page table for the requested page (P).
+  auto iter = page_table_.find(page_id);
+  if (iter == page_table_.end()) {
+    // 1.1   If P does not exist, return true.
+    return true;
+  }
+  frame_id_t frame_id = iter->second;
+  // 1.2   If P exists, but has a zero pin-count, return false.
+  if (pages_[frame_id].pin_count_ == 0) {
+    return false;
+  }
+  // 2.   Otherwise, unpin P and, if is_dirty is true, set the dirty flag of P. The pages of a mapped file are never
+  //      written back, e.g. when the pool is destroyed, so a dirty unpin is rejected instead.
+  pages_[frame_id].pin_count_--;
+  bool is_rejected = is_dirty && disk_manager_->IsMapped();
+  if (is_dirty && !is_rejected) {
+    pages_[frame_id].is_dirty_ = true;
+  }
+  // 3.   If the pin-count of P is equal to zero, put P in the replacer.
+  if (pages_[frame_id].pin_count_ == 0) {
+    replacer_->Unpin(frame_id);
+  }
+  return !is_rejected;
+}
+
+bool BufferPoolManagerInstance::FlushPage(page_id_t page_id) {
+  std::unique_lock<std::mutex> lock(latch_);
+  // 1.   Search the page table for the requested page (P).
+  auto iter = page_table_.find(page_id);
+  if (iter == page_table_.end()) {
+    // 1.1   If P does not exist, return false.
+    return false;
+  }
+  // 1.2   If P exists, then write P to disk and reset its dirty flag.
+  FlushFrames(lock, {iter->second});
+  return true;
+}
+
+void BufferPoolManagerInstance::FlushAllPages() {
+  std::unique_lock<std::mutex> lock(latch_);
+  vector<frame_id_t> frame_ids;
+  for (auto &page : page_table_) {
+    if (pages_[page.second].IsDirty()) {
+      frame_ids.push_back(page.second);
+    }
+  }
+  SortByPageId(frame_ids);
+  vector<page_id_t> page_ids;
+  page_ids.reserve(frame_ids.size());
+  for (auto frame_id : frame_ids) {
+    page_ids.push_back(pages_[frame_id].GetPageId());
+  }
+  // latch_ is released while a batch is written, so the frames of the next one are looked up again
+  for (size_t begin = 0; begin < page_ids.size(); begin += DEFAULT_FLUSHER_BATCH_SIZE) {
+    size_t end = std::min(page_ids.size(), begin + DEFAULT_FLUSHER_BATCH_SIZE);
+    frame_ids.clear();
+    for (size_t i = begin; i < end; i++) {
+      auto iter = page_table_.find(page_ids[i]);
+      if (iter != page_table_.end() && pages_[iter->second].IsDirty()) {
+        frame_ids.push_back(iter->second);
+      }
+    }
+    FlushFrames(lock, frame_ids);
+  }
+}
+
+size_t BufferPoolManagerInstance::FlushDirtyPages(size_t max_dirty_pages, size_t batch_size) {
+  size_t num_written = 0;
+  while (true) {
+    std::unique_lock<std::mutex> lock(latch_);
+    size_t num_dirty = 0;
+    vector<frame_id_t> frame_ids;
+    for (auto &page : page_table_) {
+      if (!pages_[page.second].IsDirty()) {
+        continue;
+      }
+      num_dirty++;
+      // pinned pages are likely to be dirtied again, leave them to FlushAllPages
+      if (pages_[page.second].GetPinCount() == 0) {
+        frame_ids.push_back(page.second);
+      }
+    }
+    if (num_dirty <= max_dirty_pages || frame_ids.empty()) {
+      return num_written;
+    }
+    size_t num_to_write = std::min({batch_size, num_dirty - max_dirty_pages, frame_ids.size()});
+    SortByPageId(frame_ids);
+    frame_ids.resize(num_to_write);
+    FlushFrames(lock, frame_ids);
+    num_written += num_to_write;
+  }
+}
+
+void BufferPoolManagerInstance::StartPrefetch(const vector<page_id_t> &page_ids,
+                                              vector<pair<page_id_t, char *>> &reads) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  for (auto page_id : page_ids) {
+    if (page_table_.find(page_id) != page_table_.end() || prefetching_.find(page_id) != prefetching_.end()) {
+      continue;
+    }
+    frame_id_t frame_id = TryToFindFreePage();
+    if (frame_id == INVALID_FRAME_ID) {
+      return;
+    }
+    pages_[frame_id].page_id_ = INVALID_PAGE_ID;
+    pages_[frame_id].pin_count_ = 0;
+    pages_[frame_id].is_dirty_ = false;
+    prefetching_[page_id] = {frame_id, true};
+    reads.emplace_back(page_id, pages_[frame_id].GetData());
+  }
+}
+
+size_t BufferPoolManagerInstance::FinishPrefetch(const vector<page_id_t> &page_ids, bool discard) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  size_t num_installed = 0;
+  for (auto page_id : page_ids) {
+    auto iter = prefetching_.find(page_id);
+    if (iter == prefetching_.end()) {
+      continue;
+    }
+    frame_id_t frame_id = iter->second.first;
+    bool is_valid = !discard && iter->second.second && page_table_.find(page_id) == page_table_.end();
+    prefetching_.erase(iter);
+    if (!is_valid) {
+      pages_[frame_id].ResetMemory();
+      free_list_.push_back(frame_id);
+      continue;
+    }
+    page_table_[page_id] = frame_id;
+    pages_[frame_id].page_id_ = page_id;
+    replacer_->Unpin(frame_id);
+    num_installed++;
+  }
+  num_prefetches_ += num_installed;
+  return num_installed;
+}
+
+size_t BufferPoolManagerInstance::GetNumHits() {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return num_hits_;
+}
+
+size_t BufferPoolManagerInstance::GetNumMisses() {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return num_misses_;
+}
+
+size_t BufferPoolManagerInstance::GetNumPrefetches() {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return num_prefetches_;
+}
+
+frame_id_t BufferPoolManagerInstance::TryToFindFreePage() {
+  frame_id_t frame_id = INVALID_FRAME_ID;
+  if (!free_list_.empty()) {
+    frame_id = free_list_.front();
+    free_list_.pop_front();
+    return frame_id;
+  }
+  if (!replacer_->Victim(&frame_id)) {
+    return INVALID_FRAME_ID;
+  }
+  if (pages_[frame_id].IsDirty()) {
+    FlushFrame(frame_id);
+  }
+  page_table_.erase(pages_[frame_id].GetPageId());
+  return frame_id;
+}
+
+void BufferPoolManagerInstance::FlushFrame(frame_id_t frame_id) {
+  InvalidatePrefetch(pages_[frame_id].GetPageId());
+  disk_manager_->WritePage(pages_[frame_id].GetPageId(), pages_[frame_id].GetData());
+  pages_[frame_id].is_dirty_ = false;
+}
+
+void BufferPoolManagerInstance::FlushFrames(std::unique_lock<std::mutex> &lock, const vector<frame_id_t> &frame_ids) {
+  if (frame_ids.empty()) {
+    return;
+  }
+  // the frames stay pinned while latch_ is released, a dirty unpin meanwhile marks a frame dirty again
+  vector<pair<page_id_t, const char *>> writes;
+  writes.reserve(frame_ids.size());
+  for (auto frame_id : frame_ids) {
+    InvalidatePrefetch(pages_[frame_id].GetPageId());
+    writes.emplace_back(pages_[frame_id].GetPageId(), nullptr);
+    pages_[frame_id].pin_count_++;
+    pages_[frame_id].is_dirty_ = false;
+    flushing_[frame_id]++;
+    replacer_->Pin(frame_id);
+  }
+  lock.unlock();
+  // a page is copied under its read latch, so that a writer cannot change it while it is written
+  std::unique_ptr<char, decltype(&free)> copies(
+      static_cast<char *>(aligned_alloc(DiskManager::DIRECT_IO_ALIGNMENT, frame_ids.size() * PAGE_SIZE)), &free);
+  for (size_t i = 0; i < frame_ids.size(); i++) {
+    Page &page = pages_[frame_ids[i]];
+    page.RLatch();
+    memcpy(copies.get() + i * PAGE_SIZE, page.GetData(), PAGE_SIZE);
+    page.RUnlatch();
+    writes[i].second = copies.get() + i * PAGE_SIZE;
+  }
+  disk_manager_->WritePages(writes);
+  lock.lock();
+  for (auto frame_id : frame_ids) {
+    if (--flushing_[frame_id] == 0) {
+      flushing_.erase(frame_id);
+    }
+    if (--pages_[frame_id].pin_count_ == 0) {
+      replacer_->Unpin(frame_id);
+    }
+  }
+}
+
+void BufferPoolManagerInstance::InvalidatePrefetch(page_id_t page_id) {
+  auto iter = prefetching_.find(page_id);
+  if (iter != prefetching_.end()) {
+    iter->second.second = false;
+  }
+}
+
+void BufferPoolManagerInstance::SortByPageId(vector<frame_id_t> &frame_ids) {
+  std::sort(frame_ids.begin(), frame_ids.end(),
+            [this](frame_id_t a, frame_id_t b) { return pages_[a].GetPageId() < pages_[b].GetPageId(); });
+}
+
+// Only used for debug
+bool BufferPoolManagerInstance::CheckAllUnpinned() {
+  std::scoped_lock<std::mutex> lock(latch_);
+  bool res = true;
+  for (size_t i = 0; i < pool_size_; i++) {
+    // pins of a write back in progress, e.g. by the background flusher, are not leaked
+    auto iter = flushing_.find(static_cast<frame_id_t>(i));
+    if (pages_[i].pin_count_ != (iter == flushing_.end() ? 0 : iter->second)) {
+      res = false;
+      LOG(ERROR) << "page " << pages_[i].page_id_ << " pin count:" << pages_[i].pin_count_ << endl;
+    }
+  }
+  return res;
+}
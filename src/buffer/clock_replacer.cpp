@@ -0,0 +1,45 @@
+#include "buffer/clock_replacer.h"
+
+#include "common/macros.h"
+
+CLOCKReplacer::CLOCKReplacer(size_t num_pages) : capacity_(num_pages), states_(new atomic<uint8_t>[num_pages]) {
+  for (size_t i = 0; i < capacity_; i++) {
+    states_[i].store(kNotEvictable, std::memory_order_relaxed);
+  }
+}
+
+CLOCKReplacer::~CLOCKReplacer() = default;
+
+bool CLOCKReplacer::Victim(frame_id_t *frame_id) {
+  while (size_.load() > 0) {
+    size_t index = hand_.fetch_add(1) % capacity_;
+    uint8_t state = states_[index].load();
+    if (state == kReferenced) {
+      // second chance, a concurrent Pin or Unpin may win and that is fine
+      states_[index].compare_exchange_strong(state, kEvictable);
+    } else if (state == kEvictable && states_[index].compare_exchange_strong(state, kNotEvictable)) {
+      size_--;
+      *frame_id = static_cast<frame_id_t>(index);
+      return true;
+    }
+  }
+  return false;
+}
+
+void CLOCKReplacer::Pin(frame_id_t frame_id) {
+  ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < capacity_, "Invalid frame id.");
+  if (states_[frame_id].exchange(kNotEvictable) != kNotEvictable) {
+    size_--;
+  }
+}
+
+void CLOCKReplacer::Unpin(frame_id_t frame_id) {
+  ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < capacity_, "Invalid frame id.");
+  if (states_[frame_id].exchange(kReferenced) == kNotEvictable) {
+    size_++;
+  }
+}
+
+size_t CLOCKReplacer::Size() {
+  return size_.load();
+}
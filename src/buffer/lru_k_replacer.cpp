@@ -0,0 +1,91 @@
+#include "buffer/lru_k_replacer.h"
+
+#include <algorithm>
+
+#include "common/macros.h"
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k, size_t correlated_period)
+    : num_pages_(num_pages), k_(k), correlated_period_(correlated_period), nodes_(num_pages), history_(num_pages * k) {
+  ASSERT(k_ > 0, "K must be positive.");
+}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+/**
+ * Frames with less than k references are tried first. Frames which have been accessed within the correlated period
+ * are skipped, there can be at most correlated_period + 1 of them.
+ */
+bool LRUKReplacer::Victim(frame_id_t *frame_id) {
+  if (Size() == 0) {
+    return false;
+  }
+  for (auto pool : {&history_pool_, &cache_pool_}) {
+    for (auto &key : *pool) {
+      if (current_tick_ - nodes_[key.second].last_access_ > correlated_period_) {
+        *frame_id = key.second;
+        Reset(*frame_id);
+        return true;
+      }
+    }
+  }
+  *frame_id = history_pool_.empty() ? cache_pool_.begin()->second : history_pool_.begin()->second;
+  Reset(*frame_id);
+  return true;
+}
+
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+  ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < num_pages_, "Invalid frame id.");
+  LRUKNode &node = nodes_[frame_id];
+  if (node.evictable_) {
+    PoolOf(frame_id).erase(KeyOf(frame_id));
+    node.evictable_ = false;
+  }
+  RecordAccess(frame_id);
+}
+
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+  ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < num_pages_, "Invalid frame id.");
+  LRUKNode &node = nodes_[frame_id];
+  if (node.evictable_) {
+    return;
+  }
+  // a frame which was never pinned behaves as if it was accessed now
+  if (node.num_refs_ == 0) {
+    RecordAccess(frame_id);
+  }
+  node.evictable_ = true;
+  PoolOf(frame_id).insert(KeyOf(frame_id));
+}
+
+void LRUKReplacer::Remove(frame_id_t frame_id) {
+  ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < num_pages_, "Invalid frame id.");
+  Reset(frame_id);
+}
+
+size_t LRUKReplacer::Size() {
+  return history_pool_.size() + cache_pool_.size();
+}
+
+void LRUKReplacer::RecordAccess(frame_id_t frame_id) {
+  LRUKNode &node = nodes_[frame_id];
+  size_t now = ++current_tick_;
+  if (node.num_refs_ > 0 && now - node.last_access_ <= correlated_period_) {
+    node.last_access_ = now;
+    return;
+  }
+  size_t *history = &history_[frame_id * k_];
+  for (size_t i = std::min(node.num_refs_, k_ - 1); i > 0; i--) {
+    history[i] = history[i - 1];
+  }
+  history[0] = now;
+  node.num_refs_ = std::min(node.num_refs_ + 1, k_);
+  node.last_access_ = now;
+}
+
+void LRUKReplacer::Reset(frame_id_t frame_id) {
+  LRUKNode &node = nodes_[frame_id];
+  if (node.evictable_) {
+    PoolOf(frame_id).erase(KeyOf(frame_id));
+  }
+  node = LRUKNode();
+}
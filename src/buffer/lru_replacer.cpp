@@ -1,46 +1,56 @@
 #include "buffer/lru_replacer.h"
 
-LRUReplacer::LRUReplacer(size_t num_pages){}
+#include "common/macros.h"
+
+LRUReplacer::LRUReplacer(size_t num_pages) : head_(static_cast<frame_id_t>(num_pages)), nodes_(num_pages + 1) {
+  nodes_[head_].prev_ = head_;
+  nodes_[head_].next_ = head_;
+}
 
 LRUReplacer::~LRUReplacer() = default;
 
-/**
- * Student Implement
- */
 bool LRUReplacer::Victim(frame_id_t *frame_id) {
-  if (lru_list.empty()) {
-    frame_id = nullptr;
+  if (size_ == 0) {
     return false;
   }
-  *frame_id = lru_list.front();
-  lru_list.pop_front();
-  lru_set.erase(*frame_id);
+  *frame_id = nodes_[head_].next_;
+  Unlink(*frame_id);
   return true;
 }
 
-/**
- * Student Implement
- */
 void LRUReplacer::Pin(frame_id_t frame_id) {
-  if (lru_set.find(frame_id) != lru_set.end()) {
-    lru_list.remove(frame_id);
-    lru_set.erase(frame_id);
+  ASSERT(frame_id >= 0 && frame_id < head_, "Invalid frame id.");
+  if (nodes_[frame_id].in_list_) {
+    Unlink(frame_id);
   }
 }
 
-/**
- * Student Implement
- */
 void LRUReplacer::Unpin(frame_id_t frame_id) {
-  if (lru_set.find(frame_id) == lru_set.end()) {
-    lru_list.push_back(frame_id);
-    lru_set.insert(frame_id);
+  ASSERT(frame_id >= 0 && frame_id < head_, "Invalid frame id.");
+  if (!nodes_[frame_id].in_list_) {
+    PushBack(frame_id);
   }
 }
 
-/**
- * Student Implement
- */
 size_t LRUReplacer::Size() {
-  return lru_list.size();
-}
\ No newline at end of file
+  return size_;
+}
+
+void LRUReplacer::Unlink(frame_id_t frame_id) {
+  LRUNode &node = nodes_[frame_id];
+  nodes_[node.prev_].next_ = node.next_;
+  nodes_[node.next_].prev_ = node.prev_;
+  node.prev_ = node.next_ = INVALID_FRAME_ID;
+  node.in_list_ = false;
+  size_--;
+}
+
+void LRUReplacer::PushBack(frame_id_t frame_id) {
+  LRUNode &node = nodes_[frame_id];
+  node.prev_ = nodes_[head_].prev_;
+  node.next_ = head_;
+  nodes_[node.prev_].next_ = frame_id;
+  nodes_[head_].prev_ = frame_id;
+  node.in_list_ = true;
+  size_++;
+}
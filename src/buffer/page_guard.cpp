@@ -0,0 +1,64 @@
+#include "buffer/page_guard.h"
+
+#include <utility>
+
+#include "buffer/buffer_pool_manager.h"
+
+ReadPageGuard::ReadPageGuard(BufferPoolManager *buffer_pool_manager, Page *page)
+    : buffer_pool_manager_(buffer_pool_manager), page_(page) {}
+
+ReadPageGuard::ReadPageGuard(ReadPageGuard &&that) noexcept
+    : buffer_pool_manager_(std::exchange(that.buffer_pool_manager_, nullptr)),
+      page_(std::exchange(that.page_, nullptr)) {}
+
+ReadPageGuard &ReadPageGuard::operator=(ReadPageGuard &&that) noexcept {
+  if (this != &that) {
+    Drop();
+    buffer_pool_manager_ = std::exchange(that.buffer_pool_manager_, nullptr);
+    page_ = std::exchange(that.page_, nullptr);
+  }
+  return *this;
+}
+
+ReadPageGuard::~ReadPageGuard() { Drop(); }
+
+void ReadPageGuard::Drop() {
+  if (page_ == nullptr) {
+    return;
+  }
+  page_->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page_->GetPageId(), false);
+  buffer_pool_manager_ = nullptr;
+  page_ = nullptr;
+}
+
+WritePageGuard::WritePageGuard(BufferPoolManager *buffer_pool_manager, Page *page)
+    : buffer_pool_manager_(buffer_pool_manager), page_(page) {}
+
+WritePageGuard::WritePageGuard(WritePageGuard &&that) noexcept
+    : buffer_pool_manager_(std::exchange(that.buffer_pool_manager_, nullptr)),
+      page_(std::exchange(that.page_, nullptr)),
+      is_dirty_(std::exchange(that.is_dirty_, false)) {}
+
+WritePageGuard &WritePageGuard::operator=(WritePageGuard &&that) noexcept {
+  if (this != &that) {
+    Drop();
+    buffer_pool_manager_ = std::exchange(that.buffer_pool_manager_, nullptr);
+    page_ = std::exchange(that.page_, nullptr);
+    is_dirty_ = std::exchange(that.is_dirty_, false);
+  }
+  return *this;
+}
+
+WritePageGuard::~WritePageGuard() { Drop(); }
+
+void WritePageGuard::Drop() {
+  if (page_ == nullptr) {
+    return;
+  }
+  page_->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page_->GetPageId(), is_dirty_);
+  buffer_pool_manager_ = nullptr;
+  page_ = nullptr;
+  is_dirty_ = false;
+}
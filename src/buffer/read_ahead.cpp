@@ -0,0 +1,49 @@
+#include "buffer/read_ahead.h"
+
+#include <algorithm>
+#include <vector>
+
+void ReadAhead::OnNewPage(BufferPoolManager *buffer_pool_manager, page_id_t page_id, page_id_t next_page_id) {
+  if (!ahead_.empty() && ahead_.front() == page_id) {
+    ahead_.pop_front();
+    window_ = window_ == 0 ? READ_AHEAD_MIN_WINDOW : std::min(window_ * 2, READ_AHEAD_MAX_WINDOW);
+  } else {
+    ahead_.clear();
+    window_ = 0;
+  }
+  if (next_page_id == INVALID_PAGE_ID) {
+    ahead_.clear();
+    return;
+  }
+  // the pages requested ahead were guessed wrong
+  if (!ahead_.empty() && ahead_.front() != next_page_id) {
+    ahead_.clear();
+    window_ = 0;
+  }
+  std::vector<page_id_t> page_ids;
+  if (ahead_.empty()) {
+    page_ids.push_back(next_page_id);
+    ahead_.push_back(next_page_id);
+  }
+  // top the window up once half of it has been consumed
+  bool chain_known = chain_pages_ != nullptr;
+  bool looks_sequential = chain_known || next_page_id == page_id + 1;
+  if (window_ > 0 && looks_sequential && ahead_.size() <= static_cast<size_t>(window_) / 2) {
+    size_t count = window_ - ahead_.size();
+    size_t first = page_ids.size();
+    if (chain_known) {
+      chain_pages_(ahead_.back(), count, &page_ids);
+    } else {
+      // stop at the first page id which is not allocated, the chain does not go on in page id order there
+      for (page_id_t id = ahead_.back() + 1; page_ids.size() - first < count && !buffer_pool_manager->IsPageFree(id);
+           id++) {
+        page_ids.push_back(id);
+      }
+    }
+    ahead_.insert(ahead_.end(), page_ids.begin() + first, page_ids.end());
+  }
+  if (page_ids.empty()) {
+    return;
+  }
+  buffer_pool_manager->PrefetchPages(page_ids);
+}
@@ -1,7 +1,9 @@
 #include "catalog/catalog.h"
 
+#include "storage/table_scanner.h"
+
 void CatalogMeta::SerializeTo(char *buf) const {
-  ASSERT(GetSerializedSize() <= PAGE_SIZE, "Failed to serialize catalog metadata to disk.");
+  ASSERT(GetSerializedSize() <= PAGE_USABLE_SIZE, "Failed to serialize catalog metadata to disk.");
   MACH_WRITE_UINT32(buf, CATALOG_METADATA_MAGIC_NUM);
   buf += 4;
   MACH_WRITE_UINT32(buf, table_meta_pages_.size());
@@ -108,10 +110,13 @@ CatalogManager::~CatalogManager() {
  * @param schema the schema of the table
  * @param txn the transaction that is creating the table
  * @param table_info the table info that is created
- * @return DB_SUCCESS if the table is created successfully, DB_ALREADY_EXIST if the table already exists
+ * @return DB_SUCCESS if the table is created successfully, DB_ALREADY_EXIST if the table already exists, DB_FAILED if the file is mapped read-only
  * @brief Create a table with the given name and schema
  */
 dberr_t CatalogManager::CreateTable(const string &table_name, TableSchema *schema, Txn *txn, TableInfo *&table_info) {
+  if (buffer_pool_manager_->IsReadOnly()) {
+    return DB_FAILED;
+  }
   // Check if table already exists
   if (table_names_.find(table_name) != table_names_.end()) {
     return DB_TABLE_ALREADY_EXIST;
@@ -131,7 +136,8 @@ dberr_t CatalogManager::CreateTable(const string &table_name, TableSchema *schem
     auto table_schema = TableSchema::DeepCopySchema(schema);
     auto table_heap = TableHeap::Create(buffer_pool_manager_, heap_root_page_id, table_schema, log_manager_, lock_manager_);
     // Create table metadata
-    auto table_meta_data = TableMetadata::Create(table_id, table_name, heap_root_page_id, table_schema);
+    auto table_meta_data = TableMetadata::Create(table_id, table_name, heap_root_page_id, table_schema,
+                                                 table_heap->GetFreeSpaceMapPageId());
     // Serialize table metadata
     table_meta_data->SerializeTo(table_meta_page->GetData());
     buffer_pool_manager_->UnpinPage(page_id, true);
@@ -183,12 +189,15 @@ dberr_t CatalogManager::GetTables(vector<TableInfo *> &tables) const {
  * @param txn the transaction that is creating the index
  * @param index_info the index info that is created
  * @param index_type the type of the index that is created
- * @return DB_TABLE_NOT_EXIST if the table does not exist, DB_INDEX_ALREADY_EXIST if the index already exists, DB_COLUMN_NAME_NOT_EXIST if the column name does not exist in the schema, DB_SUCCESS if the index is created successfully
+ * @return DB_TABLE_NOT_EXIST if the table does not exist, DB_INDEX_ALREADY_EXIST if the index already exists, DB_COLUMN_NAME_NOT_EXIST if the column name does not exist in the schema, DB_FAILED if the rows of the table have duplicate keys or the file is mapped read-only, DB_SUCCESS if the index is created successfully
  * @brief Create an index on a table
  */
 dberr_t CatalogManager::CreateIndex(const std::string &table_name, const string &index_name,
                                     const std::vector<std::string> &index_keys, Txn *txn, IndexInfo *&index_info,
                                     const string &index_type) {
+  if (buffer_pool_manager_->IsReadOnly()) {
+    return DB_FAILED;
+  }
   auto table = table_names_.find(table_name);
   // Check if table exists
   if (table == table_names_.end()) {
@@ -226,18 +235,24 @@ dberr_t CatalogManager::CreateIndex(const std::string &table_name, const string
       // Create index info
       index_info = IndexInfo::Create();
       index_info->Init(index_meta_data, table_info, buffer_pool_manager_);
-      // Insert record into index
-      auto table_heap = table_info->GetTableHeap();
-      vector<Field> fields;
-      for (auto ite = table_heap->Begin(nullptr); ite != table_heap->End(); ite++) {
-        fields.clear();
-        for (auto key : key_map) {
-          fields.push_back(*(ite->GetField(key)));
-        }
-        Row row(fields);
-        index_info->GetIndex()->InsertEntry(row, ite->GetRowId(), txn);
-      }
+      // Build the index from the rows already in the table at once
+      TableScanner scanner(table_info->GetTableHeap(), txn);
+      dberr_t result = index_info->GetIndex()->BulkLoad(
+          [&](Row *key, RowId *row_id) {
+            return scanner.Next([&](const RowView &view) {
+              view.ToRow(key_map, key);
+              *row_id = view.GetRowId();
+              return true;
+            });
+          },
+          txn);
       indexes_.emplace(index_id, index_info);
+      if (result != DB_SUCCESS) {
+        // a unique index cannot be built on duplicate keys, drop what was built of it
+        DropIndex(table_name, index_name);
+        index_info = nullptr;
+        return result;
+      }
       FlushCatalogMetaPage();
       return DB_SUCCESS;
     }
@@ -288,10 +303,13 @@ dberr_t CatalogManager::GetTableIndexes(const std::string &table_name, std::vect
 
 /**
  * @param table_name the name of the table stored in the table_names_ map
- * @return DB_TABLE_NOT_EXIST if the table does not exist, DB_SUCCESS if the table is dropped
+ * @return DB_TABLE_NOT_EXIST if the table does not exist, DB_FAILED if the file is mapped read-only, DB_SUCCESS if the table is dropped
  * @brief Drop a table
  */
 dberr_t CatalogManager::DropTable(const string &table_name) {
+  if (buffer_pool_manager_->IsReadOnly()) {
+    return DB_FAILED;
+  }
   auto table = table_names_.find(table_name);
   if (table == table_names_.end()) {
     return DB_TABLE_NOT_EXIST;
@@ -326,10 +344,13 @@ dberr_t CatalogManager::DropTable(const string &table_name) {
 /**
  * @param table_name the name of the table stored in the table_names_ map
  * @param index_name the name of the index stored in the index_names_ map
- * @return DB_TABLE_NOT_EXIST if the table does not exist, DB_INDEX_NOT_FOUND if the index does not exist, DB_SUCCESS if the index is dropped
+ * @return DB_TABLE_NOT_EXIST if the table does not exist, DB_INDEX_NOT_FOUND if the index does not exist, DB_FAILED if the file is mapped read-only, DB_SUCCESS if the index is dropped
  * @brief Drop an index of a table
  */
 dberr_t CatalogManager::DropIndex(const string &table_name, const string &index_name) {
+  if (buffer_pool_manager_->IsReadOnly()) {
+    return DB_FAILED;
+  }
   auto index_tuple = index_names_.find(table_name);
   if (index_tuple == index_names_.end()) {
     return DB_TABLE_NOT_EXIST;
@@ -364,6 +385,9 @@ dberr_t CatalogManager::DropIndex(const string &table_name, const string &index_
  * @brief Flush the catalog metadata page
  */
 dberr_t CatalogManager::FlushCatalogMetaPage() const {
+  if (buffer_pool_manager_->IsReadOnly()) {
+    return DB_FAILED;
+  }
   auto catalog_page = buffer_pool_manager_->FetchPage(CATALOG_META_PAGE_ID);
   this->catalog_meta_->SerializeTo(catalog_page->GetData());
   buffer_pool_manager_->UnpinPage(CATALOG_META_PAGE_ID, true);
@@ -388,7 +412,8 @@ dberr_t CatalogManager::LoadTable(const table_id_t table_id, const page_id_t pag
     TableMetadata::DeserializeFrom(table_meta_page->GetData(), table_meta_data);
     // restore table heap
     auto table_schema = TableSchema::DeepCopySchema(table_meta_data->GetSchema());
-    auto table_heap = TableHeap::Create(buffer_pool_manager_, table_meta_data->GetFirstPageId(), table_schema, log_manager_, lock_manager_);
+    auto table_heap = TableHeap::Create(buffer_pool_manager_, table_meta_data->GetFirstPageId(), table_schema, log_manager_,
+                                        lock_manager_, table_meta_data->GetFreeSpaceMapPageId());
     // restore table info
     auto table_info = TableInfo::Create();
     table_info->Init(table_meta_data, table_heap);
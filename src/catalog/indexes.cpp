@@ -12,7 +12,7 @@ IndexMetadata *IndexMetadata::Create(const index_id_t index_id, const string &in
 uint32_t IndexMetadata::SerializeTo(char *buf) const {
   char *p = buf;
   uint32_t ofs = GetSerializedSize();
-  ASSERT(ofs <= PAGE_SIZE, "Failed to serialize index info.");
+  ASSERT(ofs <= PAGE_USABLE_SIZE, "Failed to serialize index info.");
   // magic num
   MACH_WRITE_UINT32(buf, INDEX_METADATA_MAGIC_NUM);
   buf += 4;
@@ -82,17 +82,7 @@ uint32_t IndexMetadata::DeserializeFrom(char *buf, IndexMetadata *&index_meta) {
 }
 
 Index *IndexInfo::CreateIndex(BufferPoolManager *buffer_pool_manager, const string &index_type) {
-  size_t max_size = 0;
-  uint32_t column_cnt = key_schema_->GetColumns().size();
-  size_t size_bitmap = (column_cnt % 8) ? column_cnt / 8 + 1 : column_cnt / 8;
-  // column_cnt + bitmap
-  max_size += 4 + sizeof(unsigned char) * size_bitmap;
-  for (auto col : key_schema_->GetColumns()) {
-    // length of char column
-    if(col->GetType() == TypeId::kTypeChar)
-      max_size += 4;
-    max_size += col->GetLength();
-  }
+  size_t max_size = KeyManager::GetNormalizedKeySize(key_schema_);
 
   if (index_type == "bptree") {
     if (max_size <= 8)
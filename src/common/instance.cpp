@@ -3,16 +3,25 @@
 //
 #include "common/instance.h"
 
-DBStorageEngine::DBStorageEngine(std::string db_name, bool init, uint32_t buffer_pool_size)
+DBStorageEngine::DBStorageEngine(std::string db_name, bool init, uint32_t buffer_pool_size,
+                                 uint32_t buffer_pool_instances, ReplacerType replacer_type, bool direct_io,
+                                 bool mmap_read_only, bool page_checksums)
     : db_file_name_(std::move(db_name)), init_(init) {
+  // a read-only database must already exist
+  if (init_ && mmap_read_only) {
+    throw logic_error("Cannot initialize a read-only database.");
+  }
   // Init database file if needed
   db_file_name_ = "./databases/" + db_file_name_;
   if (init_) {
     remove(db_file_name_.c_str());
   }
   // Initialize components
-  disk_mgr_ = new DiskManager(db_file_name_);
-  bpm_ = new BufferPoolManager(buffer_pool_size, disk_mgr_);
+  disk_mgr_ = new DiskManager(db_file_name_, direct_io, IOBackendType::kIOUring, mmap_read_only, page_checksums);
+  bpm_ = new BufferPoolManager(buffer_pool_size, disk_mgr_, buffer_pool_instances, replacer_type);
+  if (!mmap_read_only) {
+    bpm_->StartFlusher();
+  }
 
   // Allocate static page for db storage engine
   if (init) {
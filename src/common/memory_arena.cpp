@@ -0,0 +1,27 @@
+#include "common/memory_arena.h"
+
+void MemoryArena::Reset() {
+  if (blocks_.size() > 1) {
+    blocks_.resize(1);
+  }
+  large_blocks_.clear();
+  cur_ = blocks_.empty() ? nullptr : blocks_.front().get();
+  remaining_ = blocks_.empty() ? 0 : block_size_;
+  allocated_bytes_ = 0;
+}
+
+void *MemoryArena::AllocateSlow(size_t size, [[maybe_unused]] size_t alignment) {
+  // operator new[] aligns to max_align_t, more is not supported
+  ASSERT(alignment <= alignof(std::max_align_t), "Unsupported alignment.");
+  allocated_bytes_ += size;
+  block_allocations_++;
+  if (size > block_size_ / 4) {
+    // a large allocation does not throw away the rest of the current block
+    large_blocks_.emplace_back(new char[size]);
+    return large_blocks_.back().get();
+  }
+  blocks_.emplace_back(new char[block_size_]);
+  cur_ = blocks_.back().get() + size;
+  remaining_ = block_size_ - size;
+  return blocks_.back().get();
+}
@@ -5,6 +5,7 @@
 #include <sys/types.h>
 
 #include <chrono>
+#include <fstream>
 
 #include "common/result_writer.h"
 #include "executor/executors/delete_executor.h"
@@ -43,7 +44,12 @@ ExecuteEngine::ExecuteEngine() {
         strcmp( stdir->d_name , "..") == 0 ||
         stdir->d_name[0] == '.')
       continue;
-    dbs_[stdir->d_name] = new DBStorageEngine(stdir->d_name, false);
+    // a database this build cannot open is skipped, the others stay usable
+    try {
+      dbs_[stdir->d_name] = new DBStorageEngine(stdir->d_name, false);
+    } catch (const exception &ex) {
+      LOG(ERROR) << "Cannot open database " << stdir->d_name << ": " << ex.what() << std::endl;
+    }
   }
   closedir(dir);
 }
@@ -144,6 +150,8 @@ dberr_t ExecuteEngine::Execute(pSyntaxNode ast) {
       return ExecuteTrxRollback(ast, context.get());
     case kNodeExecFile:
       return ExecuteExecfile(ast, context.get());
+    case kNodeVacuum:
+      return ExecuteVacuum(ast, context.get());
     case kNodeQuit:
       return ExecuteQuit(ast, context.get());
     default:
@@ -159,7 +167,9 @@ dberr_t ExecuteEngine::Execute(pSyntaxNode ast) {
   try {
     planner.PlanQuery(ast);
     // Execute the query.
-    ExecutePlan(planner.plan_, &result_set, nullptr, context.get());
+    if (ExecutePlan(planner.plan_, &result_set, nullptr, context.get()) != DB_SUCCESS) {
+      return DB_FAILED;
+    }
   } catch (const exception &ex) {
     std::cout << "Error Encountered in Planner: " << ex.what() << std::endl;
     return DB_FAILED;
@@ -560,6 +570,42 @@ dberr_t ExecuteEngine::ExecuteDropIndex(pSyntaxNode ast, ExecuteContext *context
   return DB_SUCCESS;
 }
 
+dberr_t ExecuteEngine::ExecuteVacuum(pSyntaxNode ast, ExecuteContext *context) {
+#ifdef ENABLE_EXECUTE_DEBUG
+  LOG(INFO) << "ExecuteVacuum" << std::endl;
+#endif
+  if (current_db_.empty()) {
+    cout << "No database selected" << endl;
+    return DB_FAILED;
+  }
+  string table_name = ast->child_->val_;
+  TableInfo *table_info = nullptr;
+  if (dbs_[current_db_]->catalog_mgr_->GetTable(table_name, table_info) != DB_SUCCESS) {
+    return DB_TABLE_NOT_EXIST;
+  }
+  vector<IndexInfo *> indexes;
+  dbs_[current_db_]->catalog_mgr_->GetTableIndexes(table_name, indexes);
+  std::vector<std::pair<RowId, Row>> moved_rows;
+  Txn *txn = context->GetTransaction();
+  bool finished = table_info->GetTableHeap()->Vacuum(txn, &moved_rows);
+  // the moved tuples are found under their new rids
+  for (auto &[old_rid, row] : moved_rows) {
+    for (auto index : indexes) {
+      Row key_row;
+      row.GetKeyFromRow(table_info->GetSchema(), index->GetIndexKeySchema(), key_row);
+      index->GetIndex()->RemoveEntry(key_row, old_rid, txn);
+      index->GetIndex()->InsertEntry(key_row, row.GetRowId(), txn);
+    }
+  }
+  if (!finished) {
+    cout << "Table " << table_name << " could not be vacuumed as a whole, " << moved_rows.size() << " rows moved"
+         << endl;
+    return DB_FAILED;
+  }
+  cout << "Table " << table_name << " vacuumed, " << moved_rows.size() << " rows moved" << endl;
+  return DB_SUCCESS;
+}
+
 dberr_t ExecuteEngine::ExecuteTrxBegin(pSyntaxNode ast, ExecuteContext *context) {
 #ifdef ENABLE_EXECUTE_DEBUG
   LOG(INFO) << "ExecuteTrxBegin" << std::endl;
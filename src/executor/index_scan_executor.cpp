@@ -10,9 +10,14 @@ IndexScanExecutor::IndexScanExecutor(ExecuteContext *exec_ctx, const IndexScanPl
 
 void IndexScanExecutor::Init() {
   exec_ctx_->GetCatalog()->GetTable(plan_->GetTableName(), table_info_);
-  auto first_row = table_info_->GetTableHeap()->Begin(nullptr);
   result_ = IndexScan(plan_->GetPredicate());
+  cursor_ = 0;
   is_schema_same_ = SchemaEqual(table_info_->GetSchema(), plan_->OutputSchema());
+  view_ = std::make_unique<RowView>(table_info_->GetSchema());
+  output_columns_.clear();
+  for (const auto column : plan_->OutputSchema()->GetColumns()) {
+    output_columns_.push_back(column->GetTableInd());
+  }
 }
 
 bool IndexScanExecutor::SchemaEqual(const Schema *table_schema, const Schema *output_schema) {
@@ -84,26 +89,25 @@ vector<RowId> IndexScanExecutor::IndexScan(AbstractExpressionRef predicate) {
 
 bool IndexScanExecutor::Next(Row *row, RowId *rid) {
   auto predicate = plan_->GetPredicate();
-  auto table_schema = table_info_->GetSchema();
   while (cursor_ < result_.size()) {
-    auto p_row = new Row(result_[cursor_]);
-    table_info_->GetTableHeap()->GetTuple(p_row, nullptr);
-    if (plan_->need_filter_) {
-      if (!predicate->Evaluate(p_row).CompareEquals(Field(kTypeInt, 1))) {
-        cursor_++;
-        delete p_row;
-        continue;
+    // the predicate is evaluated in place, only a matching tuple is copied out of the page
+    bool is_matched = false;
+    table_info_->GetTableHeap()->VisitTuple(result_[cursor_], view_.get(), nullptr, [&](const RowView &view) {
+      if (plan_->need_filter_ && !predicate->Evaluate(view).CompareEquals(Field(kTypeInt, 1))) {
+        return;
       }
-    }
-    *rid = result_[cursor_];
-    if (!is_schema_same_) {
-      TupleTransfer(table_schema, plan_->OutputSchema(), p_row, row);
-    } else {
-      *row = *p_row;
-    }
-    delete p_row;
+      if (!is_schema_same_) {
+        view.ToRow(output_columns_, row, exec_ctx_->GetArena());
+      } else {
+        view.ToRow(row, exec_ctx_->GetArena());
+      }
+      is_matched = true;
+    });
     cursor_++;
-    return true;
+    if (is_matched) {
+      *rid = result_[cursor_ - 1];
+      return true;
+    }
   }
   return false;
 }
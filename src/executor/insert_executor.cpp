@@ -4,39 +4,85 @@
 
 #include "executor/executors/insert_executor.h"
 
+#include <stdexcept>
+#include <unordered_set>
+
 InsertExecutor::InsertExecutor(ExecuteContext *exec_ctx, const InsertPlanNode *plan,
                                std::unique_ptr<AbstractExecutor> &&child_executor)
     : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
 
 void InsertExecutor::Init() {
+  if (exec_ctx_->GetBufferPoolManager()->IsReadOnly()) {
+    throw std::runtime_error("Cannot modify a database opened read-only.");
+  }
   child_executor_->Init();
   exec_ctx_->GetCatalog()->GetTable(plan_->GetTableName(), table_info_);
   schema_ = table_info_->GetSchema();
   exec_ctx_->GetCatalog()->GetTableIndexes(table_info_->GetTableName(), index_info_);
+  pending_count_ = 0;
+  is_done_ = false;
 }
 
 bool InsertExecutor::Next([[maybe_unused]] Row *row, RowId *rid) {
+  if (pending_count_ == 0 && !is_done_) {
+    InsertBatch();
+  }
+  if (pending_count_ == 0) {
+    return false;
+  }
+  pending_count_--;
+  return true;
+}
+
+void InsertExecutor::InsertBatch() {
+  std::vector<Row> insert_rows;
+  // serialized keys of the batch per index, the indexes do not know them yet
+  std::vector<std::unordered_set<std::string>> batch_keys(index_info_.size());
+  while (insert_rows.size() < INSERT_BATCH_SIZE) {
     Row insert_row;
     RowId insert_rid;
-    if (child_executor_->Next(&insert_row, &insert_rid)) {
-        for (auto info: index_info_) {
-            Row key_row;
-            insert_row.GetKeyFromRow(table_info_->GetSchema(), info->GetIndexKeySchema(), key_row);
-            std::vector<RowId> result;
-            if (!key_row.GetFields().empty() &&
-                info->GetIndex()->ScanKey(key_row, result, exec_ctx_->GetTransaction()) == DB_SUCCESS) {
-                std::cout << "key already exists" << std::endl;
-                return false;
-            }
-        }
-        if (table_info_->GetTableHeap()->InsertTuple(insert_row, exec_ctx_->GetTransaction())) {
-            Row key_row;
-            for (auto info: index_info_) {  // 更新索引
-                insert_row.GetKeyFromRow(schema_, info->GetIndexKeySchema(), key_row);
-                info->GetIndex()->InsertEntry(key_row, insert_row.GetRowId(), exec_ctx_->GetTransaction());
-            }
-            return true;
-        }
-  }
-  return false;
-}
\ No newline at end of file
+    if (!child_executor_->Next(&insert_row, &insert_rid)) {
+      is_done_ = true;
+      break;
+    }
+    bool is_duplicate = false;
+    for (size_t i = 0; i < index_info_.size() && !is_duplicate; i++) {
+      Row key_row;
+      auto key_schema = index_info_[i]->GetIndexKeySchema();
+      insert_row.GetKeyFromRow(schema_, key_schema, key_row);
+      if (key_row.GetFields().empty()) {
+        continue;
+      }
+      std::vector<RowId> result;
+      std::string key(key_row.GetSerializedSize(key_schema), '\0');
+      key_row.SerializeTo(key.data(), key_schema);
+      is_duplicate = index_info_[i]->GetIndex()->ScanKey(key_row, result, exec_ctx_->GetTransaction()) == DB_SUCCESS ||
+                     !batch_keys[i].insert(std::move(key)).second;
+    }
+    if (is_duplicate) {
+      std::cout << "key already exists" << std::endl;
+      is_done_ = true;
+      break;
+    }
+    insert_rows.emplace_back(std::move(insert_row));
+  }
+  if (insert_rows.empty()) {
+    return;
+  }
+  pending_count_ = table_info_->GetTableHeap()->InsertTuples(insert_rows, exec_ctx_->GetTransaction());
+  if (pending_count_ < insert_rows.size()) {
+    is_done_ = true;
+  }
+  // 更新索引
+  std::vector<RowId> row_ids(pending_count_);
+  for (size_t i = 0; i < pending_count_; i++) {
+    row_ids[i] = insert_rows[i].GetRowId();
+  }
+  for (auto info : index_info_) {
+    std::vector<Row> key_rows(pending_count_);
+    for (size_t i = 0; i < pending_count_; i++) {
+      insert_rows[i].GetKeyFromRow(schema_, info->GetIndexKeySchema(), key_rows[i]);
+    }
+    info->GetIndex()->InsertEntries(key_rows, row_ids, exec_ctx_->GetTransaction());
+  }
+}
@@ -4,10 +4,7 @@
 #include "executor/executors/seq_scan_executor.h"
 
 SeqScanExecutor::SeqScanExecutor(ExecuteContext *exec_ctx, const SeqScanPlanNode *plan)
-    : AbstractExecutor(exec_ctx),
-      plan_(plan),
-      iterator_(nullptr, RowId(INVALID_PAGE_ID, 0), nullptr),
-      is_schema_same_(false) {}
+    : AbstractExecutor(exec_ctx), plan_(plan), is_schema_same_(false) {}
 
 bool SeqScanExecutor::SchemaEqual(const Schema *table_schema, const Schema *output_schema) {
   auto table_columns = table_schema->GetColumns();
@@ -40,31 +37,27 @@ void SeqScanExecutor::TupleTransfer(const Schema *table_schema, const Schema *ou
 
 void SeqScanExecutor::Init() {
   exec_ctx_->GetCatalog()->GetTable(plan_->GetTableName(), table_info_);
-  auto first_row = table_info_->GetTableHeap()->Begin(nullptr);
-  iterator_ = (table_info_->GetTableHeap()->Begin(exec_ctx_->GetTransaction()));
+  scanner_ = std::make_unique<TableScanner>(table_info_->GetTableHeap(), exec_ctx_->GetTransaction());
   schema_ = plan_->OutputSchema();
   is_schema_same_ = SchemaEqual(table_info_->GetSchema(), schema_);
+  output_columns_.clear();
+  for (const auto column : schema_->GetColumns()) {
+    output_columns_.push_back(column->GetTableInd());
+  }
 }
 
 bool SeqScanExecutor::Next(Row *row, RowId *rid) {
   auto predicate = plan_->GetPredicate();
-  auto table_schema = table_info_->GetSchema();
-  while (iterator_ != table_info_->GetTableHeap()->End()) {
-    auto p_row = &(*iterator_);
-    if (predicate != nullptr) {
-      if (!predicate->Evaluate(p_row).CompareEquals(Field(kTypeInt, 1))) {
-        iterator_++;
-        continue;
-      }
+  return scanner_->Next([&](const RowView &view) {
+    if (predicate != nullptr && !predicate->Evaluate(view).CompareEquals(Field(kTypeInt, 1))) {
+      return false;
     }
-    *rid = iterator_->GetRowId();
+    *rid = view.GetRowId();
     if (!is_schema_same_) {
-      TupleTransfer(table_schema, schema_, p_row, row);
+      view.ToRow(output_columns_, row, exec_ctx_->GetArena());
     } else {
-      *row = *p_row;
+      view.ToRow(row, exec_ctx_->GetArena());
     }
-    iterator_++;
     return true;
-  }
-  return false;
+  });
 }
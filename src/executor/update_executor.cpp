@@ -4,11 +4,16 @@
 
 #include "executor/executors/update_executor.h"
 
+#include <stdexcept>
+
 UpdateExecutor::UpdateExecutor(ExecuteContext *exec_ctx, const UpdatePlanNode *plan,
                                std::unique_ptr<AbstractExecutor> &&child_executor)
     : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
 
 void UpdateExecutor::Init() {
+  if (exec_ctx_->GetBufferPoolManager()->IsReadOnly()) {
+    throw std::runtime_error("Cannot modify a database opened read-only.");
+  }
   child_executor_->Init();
   exec_ctx_->GetCatalog()->GetTable(plan_->GetTableName(), table_info_);
   exec_ctx_->GetCatalog()->GetTableIndexes(table_info_->GetTableName(), index_info_);
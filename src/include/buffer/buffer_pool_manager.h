@@ -1,37 +1,117 @@
 #ifndef MINISQL_BUFFER_POOL_MANAGER_H
 #define MINISQL_BUFFER_POOL_MANAGER_H
 
-#include <list>
+#include <condition_variable>
+#include <deque>
 #include <mutex>
-#include <unordered_map>
+#include <thread>
+#include <vector>
 
-#include "buffer/lru_replacer.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/page_guard.h"
 #include "page/disk_file_meta_page.h"
 #include "page/page.h"
 #include "storage/disk_manager.h"
 
 using namespace std;
 
+/**
+ * BufferPoolManager splits its frames into several BufferPoolManagerInstance shards, and a page is always served by
+ * the instance (page_id % num_instances). Every instance has its own latch, so threads working on different pages
+ * rarely contend with each other. With num_instances = 1 it behaves exactly like a single buffer pool.
+ */
 class BufferPoolManager {
  public:
-  explicit BufferPoolManager(size_t pool_size, DiskManager *disk_manager);
+  /**
+   * @param num_instances number of shards, cut down to pool_size since every shard needs a frame
+   */
+  explicit BufferPoolManager(size_t pool_size, DiskManager *disk_manager, size_t num_instances = 1,
+                             ReplacerType replacer_type = ReplacerType::kLRU);
 
   ~BufferPoolManager();
 
   Page *FetchPage(page_id_t page_id);
 
+  /**
+   * Fetch the page and take its read latch. The guard releases both.
+   * @return an invalid guard if all frames are pinned
+   */
+  ReadPageGuard FetchPageRead(page_id_t page_id);
+
+  /**
+   * Fetch the page and take its write latch. The guard releases both.
+   * @return an invalid guard if all frames are pinned or the file is mapped read-only
+   */
+  WritePageGuard FetchPageWrite(page_id_t page_id);
+
   bool UnpinPage(page_id_t page_id, bool is_dirty);
 
   bool FlushPage(page_id_t page_id);
 
+  /**
+   * Write back every dirty page, each instance in page id order, then the disk manager's bitmaps and meta page. Used on
+   * shutdown and for checkpoints.
+   */
+  void FlushAllPages();
+
+  /**
+   * Start the background flusher. Every interval_ms it writes back unpinned dirty pages of each instance, in page id
+   * order, until at least target_clean_ratio of the frames are clean again, so that FetchPage seldom has to write back
+   * a dirty victim itself. Does nothing if the flusher is already running.
+   */
+  void StartFlusher(double target_clean_ratio = DEFAULT_FLUSHER_CLEAN_RATIO,
+                    int interval_ms = DEFAULT_FLUSHER_INTERVAL_MS);
+
+  /**
+   * Stop the background flusher and wait for it to exit.
+   */
+  void StopFlusher();
+
+  /**
+   * Ask the I/O thread to read the pages into the buffer pool ahead of time. Pages which are already resident are
+   * skipped, and requests are dropped while PREFETCH_QUEUE_SIZE requests are pending. Prefetched pages are not pinned.
+   * If the file is mapped, the OS is asked to read the pages into the page cache instead.
+   */
+  void PrefetchPages(const vector<page_id_t> &page_ids);
+
+  /**
+   * Allocate a new page and pin it.
+   * @return nullptr if no instance which owns one of the ids tried has a frame to spare
+   */
   Page *NewPage(page_id_t &page_id);
 
+  /**
+   * Allocate a new page and take its write latch. The guard releases both and unpins the page as dirty.
+   * @return an invalid guard if all frames are pinned or the file is mapped read-only
+   */
+  WritePageGuard NewPageWrite(page_id_t &page_id);
+
+  /**
+   * Drop the page from the pool and deallocate it on disk, whether it is resident or not.
+   * @return false if the page is pinned or the file is mapped read-only
+   */
   bool DeletePage(page_id_t page_id);
 
   bool IsPageFree(page_id_t page_id);
 
   bool CheckAllUnpinned();
 
+  inline size_t GetPoolSize() const { return pool_size_; }
+
+  inline size_t GetNumInstances() const { return instances_.size(); }
+
+  /** @return true if the file is mapped read-only, pages must not be modified then */
+  inline bool IsReadOnly() const { return disk_manager_->IsMapped(); }
+
+  /** @return number of FetchPage calls served without reading the disk, summed over all instances */
+  size_t GetNumHits();
+
+  /** @return number of FetchPage calls which had to read the page from disk, summed over all instances */
+  size_t GetNumMisses();
+
+  /** @return number of pages brought in by PrefetchPages, summed over all instances */
+  size_t GetNumPrefetches();
+
  private:
   /**
    * Allocate new page (operations like create index/table) For now just keep an increasing counter
@@ -43,16 +123,36 @@ class BufferPoolManager {
    */
   void DeallocatePage(page_id_t page_id);
 
-  frame_id_t TryToFindFreePage();
+  /**
+   * Body of the background flusher thread.
+   */
+  void FlusherLoop(double target_clean_ratio, int interval_ms);
+
+  /**
+   * Body of the I/O thread serving PrefetchPages.
+   */
+  void PrefetchLoop();
+
+  /**
+   * @return the instance responsible for the page
+   */
+  inline BufferPoolManagerInstance *GetInstance(page_id_t page_id) {
+    return instances_[static_cast<size_t>(page_id) % instances_.size()];
+  }
 
  private:
-  size_t pool_size_;                                 // number of pages in buffer pool
-  Page *pages_;                                      // array of pages
-  DiskManager *disk_manager_;                        // pointer to the disk manager.
-  unordered_map<page_id_t, frame_id_t> page_table_;  // to keep track of pages
-  Replacer *replacer_;                               // to find an unpinned page for replacement
-  list<frame_id_t> free_list_;                       // to find a free page for replacement
-  recursive_mutex latch_;                            // to protect shared data structure
+  size_t pool_size_;                                // number of pages in buffer pool
+  DiskManager *disk_manager_;                       // pointer to the disk manager.
+  vector<BufferPoolManagerInstance *> instances_;  // shards of the buffer pool
+  thread flusher_;                                  // background flusher, if started
+  mutex flusher_latch_;                             // protects flusher_stop_
+  condition_variable flusher_cv_;                   // wakes up the flusher to stop
+  bool flusher_stop_{false};
+  thread prefetcher_;                               // I/O thread, started by the first PrefetchPages
+  mutex prefetch_latch_;                            // protects prefetch_queue_ and prefetch_stop_
+  condition_variable prefetch_cv_;                  // signals new requests or stop
+  deque<page_id_t> prefetch_queue_;                 // pages waiting to be prefetched
+  bool prefetch_stop_{false};
 };
 
 #endif  // MINISQL_BUFFER_POOL_MANAGER_H
@@ -0,0 +1,154 @@
+#ifndef MINISQL_BUFFER_POOL_MANAGER_INSTANCE_H
+#define MINISQL_BUFFER_POOL_MANAGER_INSTANCE_H
+
+#include <list>
+#include <vector>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "page/page.h"
+#include "storage/disk_manager.h"
+
+using namespace std;
+
+/**
+ * BufferPoolManagerInstance is one shard of the buffer pool. It owns a fixed set of frames together with its own
+ * page table, free list and replacer, all of which are protected by a single per-instance latch. Page ids are
+ * allocated by the owning BufferPoolManager, the instance only maps pages to frames.
+ *
+ * If the disk manager maps the file read-only, frames have no memory of their own: a fetched page points into the
+ * mapping, so nothing is read, copied or zeroed.
+ */
+class BufferPoolManagerInstance {
+ public:
+  explicit BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager,
+                                     ReplacerType replacer_type = ReplacerType::kLRU);
+
+  ~BufferPoolManagerInstance();
+
+  DISALLOW_COPY_AND_MOVE(BufferPoolManagerInstance);
+
+  /**
+   * @return nullptr if all frames are pinned or the page does not match its checksum
+   */
+  Page *FetchPage(page_id_t page_id);
+
+  /**
+   * @return false if the page was not pinned, or if it is marked dirty while the file is mapped read-only; the page is
+   * unpinned but not marked dirty then
+   */
+  bool UnpinPage(page_id_t page_id, bool is_dirty);
+
+  bool FlushPage(page_id_t page_id);
+
+  /**
+   * Write back every dirty page of this instance, pinned or not, in page id order.
+   */
+  void FlushAllPages();
+
+  /**
+   * Write back unpinned dirty pages in page id order until at most max_dirty_pages frames are dirty. The latch is
+   * released after every batch_size pages so that foreground threads are not held up for long.
+   * @return number of pages written
+   */
+  size_t FlushDirtyPages(size_t max_dirty_pages, size_t batch_size);
+
+  /**
+   * First half of a prefetch. Reserve a frame for every page which is neither resident nor being prefetched already,
+   * and append a read of the page straight into that frame to reads. A reserved frame is in neither the free list nor
+   * the replacer until FinishPrefetch.
+   */
+  void StartPrefetch(const vector<page_id_t> &page_ids, vector<pair<page_id_t, char *>> &reads);
+
+  /**
+   * Second half of a prefetch, once the reads issued by StartPrefetch are done. The pages are installed unpinned,
+   * unless they were brought in, written back, allocated or deleted meanwhile; then the frame goes back to the free
+   * list.
+   * @param discard install none of the pages, e.g. because the read failed
+   * @return number of pages installed
+   */
+  size_t FinishPrefetch(const vector<page_id_t> &page_ids, bool discard = false);
+
+  /**
+   * Bring a freshly allocated page into a frame of this instance.
+   * @param page_id id of the page which has already been allocated on disk
+   * @return nullptr if all frames are pinned
+   */
+  Page *NewPage(page_id_t page_id);
+
+  /**
+   * Drop the page from this instance and return its frame to the free list, if it is resident.
+   * @return false if the page is still pinned by someone
+   */
+  bool DeletePage(page_id_t page_id);
+
+  bool CheckAllUnpinned();
+
+  inline size_t GetPoolSize() const { return pool_size_; }
+
+  /** @return number of FetchPage calls served without reading the disk */
+  size_t GetNumHits();
+
+  /** @return number of FetchPage calls which had to read the page from disk */
+  size_t GetNumMisses();
+
+  /** @return number of pages brought in by FinishPrefetch */
+  size_t GetNumPrefetches();
+
+ private:
+  /**
+   * Find a frame to hold a new page, from the free list first and then from the replacer. A dirty victim is written
+   * back and removed from the page table.
+   * Note: caller must hold latch_
+   * @return INVALID_FRAME_ID if all frames are pinned
+   */
+  frame_id_t TryToFindFreePage();
+
+  /**
+   * Write back an unpinned frame, e.g. a victim, which nobody can latch meanwhile.
+   * Note: caller must hold latch_
+   */
+  void FlushFrame(frame_id_t frame_id);
+
+  /**
+   * Write the frames back with one batch of disk requests. The frames are pinned and latch_ is released during the
+   * I/O; every page is copied under its read latch, so that a pinned page is not written while it is changed.
+   * Note: caller must hold latch_ through lock, it is held again on return
+   */
+  void FlushFrames(std::unique_lock<std::mutex> &lock, const vector<frame_id_t> &frame_ids);
+
+  /**
+   * Make sure an in-flight prefetch of the page is not installed.
+   * Note: caller must hold latch_
+   */
+  void InvalidatePrefetch(page_id_t page_id);
+
+  /**
+   * Sort the frames by the id of the page they hold, so that write backs hit the disk in ascending order.
+   * Note: caller must hold latch_
+   */
+  void SortByPageId(vector<frame_id_t> &frame_ids);
+
+ private:
+  size_t pool_size_;                                 // number of pages in this instance
+  Page *pages_;                                      // array of pages
+  char *frame_data_{nullptr};                        // memory of all frames, none if the file is mapped
+  DiskManager *disk_manager_;                        // pointer to the disk manager.
+  unordered_map<page_id_t, frame_id_t> page_table_;  // to keep track of pages
+  Replacer *replacer_;                               // to find an unpinned page for replacement
+  list<frame_id_t> free_list_;                       // to find a free page for replacement
+  mutex latch_;                                      // to protect shared data structure
+  size_t num_hits_{0};                               // FetchPage calls served from memory
+  size_t num_misses_{0};                             // FetchPage calls served from disk
+  size_t num_prefetches_{0};                         // pages installed by FinishPrefetch
+  // pages whose prefetch read is in flight, with the reserved frame and whether the read is still valid
+  unordered_map<page_id_t, pair<frame_id_t, bool>> prefetching_;
+  // frames pinned by FlushFrames while they are written back, with the number of such pins
+  unordered_map<frame_id_t, int> flushing_;
+};
+
+#endif  // MINISQL_BUFFER_POOL_MANAGER_INSTANCE_H
@@ -1,13 +1,8 @@
 #ifndef MINISQL_CLOCK_REPLACER_H
 #define MINISQL_CLOCK_REPLACER_H
 
-#include <algorithm>
-#include <list>
-#include <map>
-#include <mutex>
-#include <queue>
-#include <unordered_set>
-#include <vector>
+#include <atomic>
+#include <memory>
 
 #include "buffer/replacer.h"
 #include "common/config.h"
@@ -15,7 +10,12 @@
 using namespace std;
 
 /**
- * CLOCKReplacer implements the clock replacement.
+ * CLOCKReplacer implements the clock (second chance) replacement.
+ *
+ * Each frame has one atomic state in a flat array: not in the replacer, evictable, or evictable with its reference
+ * bit set. Pin and Unpin are a single atomic exchange and therefore wait-free. Victim sweeps the clock hand over the
+ * array, clearing reference bits and claiming the first evictable frame with a compare-and-swap, so it does not need
+ * a mutex either and concurrent sweeps never hand out the same frame twice.
  */
 class CLOCKReplacer : public Replacer {
  public:
@@ -39,9 +39,12 @@ class CLOCKReplacer : public Replacer {
   size_t Size() override;
 
  private:
-  size_t capacity;
-  list<frame_id_t> clock_list;               // replacer中可以被替换的数据页
-  map<frame_id_t, frame_id_t> clock_status;  // 数据页的存储状态
+  enum FrameState : uint8_t { kNotEvictable = 0, kEvictable, kReferenced };
+
+  size_t capacity_;
+  unique_ptr<atomic<uint8_t>[]> states_;  // FrameState of each frame
+  atomic<size_t> hand_{0};                // next frame the clock hand looks at, taken modulo capacity_
+  atomic<size_t> size_{0};                // number of evictable frames
 };
 
-#endif  // MINISQL_CLOCK_REPLACER_H
\ No newline at end of file
+#endif  // MINISQL_CLOCK_REPLACER_H
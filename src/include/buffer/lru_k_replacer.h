@@ -0,0 +1,85 @@
+#ifndef MINISQL_LRU_K_REPLACER_H
+#define MINISQL_LRU_K_REPLACER_H
+
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+using namespace std;
+
+/**
+ * LRUKReplacer implements the LRU-K replacement policy (O'Neil et al., 1993).
+ *
+ * Every Pin of a frame counts as an access to the page it holds. The victim is the frame whose K-th most recent
+ * access is the oldest. Frames with fewer than K accesses have an infinite backward K-distance and are evicted first,
+ * oldest access first, so pages touched once by a sequential scan go before hot index pages.
+ *
+ * A scan touches the same page again and again while it walks over the tuples of that page. Accesses which follow the
+ * previous access of the frame within correlated_period ticks (one tick per access to any frame) are therefore
+ * treated as one correlated reference and do not add to the history. A frame accessed within the correlated period
+ * is not chosen as victim while there is any other candidate.
+ */
+class LRUKReplacer : public Replacer {
+ public:
+  /**
+   * Create a new LRUKReplacer.
+   * @param num_pages the maximum number of pages the LRUKReplacer will be required to store
+   * @param k number of accesses remembered for each frame
+   * @param correlated_period accesses closer than this number of ticks are folded into one reference
+   */
+  explicit LRUKReplacer(size_t num_pages, size_t k = 2, size_t correlated_period = 16);
+
+  /**
+   * Destroys the LRUKReplacer.
+   */
+  ~LRUKReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  size_t Size() override;
+
+ private:
+  struct LRUKNode {
+    size_t last_access_{0};  // tick of the latest access, correlated or not
+    size_t num_refs_{0};     // number of uncorrelated references kept in the history, at most k
+    bool evictable_{false};
+  };
+
+  using PoolKey = pair<size_t, frame_id_t>;
+
+  /** Record an access to the frame at a new tick. */
+  void RecordAccess(frame_id_t frame_id);
+
+  /** @return the key of an evictable frame, its oldest remembered reference */
+  inline PoolKey KeyOf(frame_id_t frame_id) const {
+    return {history_[frame_id * k_ + nodes_[frame_id].num_refs_ - 1], frame_id};
+  }
+
+  /** @return the pool which holds the frame while it is evictable */
+  inline set<PoolKey> &PoolOf(frame_id_t frame_id) {
+    return nodes_[frame_id].num_refs_ < k_ ? history_pool_ : cache_pool_;
+  }
+
+  /** Take the frame out of its pool and forget its history. */
+  void Reset(frame_id_t frame_id);
+
+  size_t num_pages_;
+  size_t k_;
+  size_t correlated_period_;
+  size_t current_tick_{0};
+  vector<LRUKNode> nodes_;
+  vector<size_t> history_;     // k ticks for each frame, the most recent reference first
+  set<PoolKey> history_pool_;  // evictable frames with less than k references
+  set<PoolKey> cache_pool_;    // evictable frames with k references
+};
+
+#endif  // MINISQL_LRU_K_REPLACER_H
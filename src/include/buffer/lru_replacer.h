@@ -1,9 +1,6 @@
 #ifndef MINISQL_LRU_REPLACER_H
 #define MINISQL_LRU_REPLACER_H
 
-#include <list>
-#include <mutex>
-#include <unordered_set>
 #include <vector>
 
 #include "buffer/replacer.h"
@@ -13,6 +10,9 @@ using namespace std;
 
 /**
  * LRUReplacer implements the Least Recently Used replacement policy.
+ *
+ * The LRU list is intrusive: every frame owns one node in a frame-indexed array, and the node with index num_pages
+ * is the sentinel of the circular list. Pin, Unpin and Victim are therefore all O(1).
  */
 class LRUReplacer : public Replacer {
  public:
@@ -35,10 +35,22 @@ class LRUReplacer : public Replacer {
 
   size_t Size() override;
 
-private:
-  // add your own private member variables here
-  list<frame_id_t> lru_list;
-  unordered_set<frame_id_t> lru_set;
+ private:
+  struct LRUNode {
+    frame_id_t prev_{INVALID_FRAME_ID};
+    frame_id_t next_{INVALID_FRAME_ID};
+    bool in_list_{false};
+  };
+
+  /** Unlink a frame which is currently in the list. */
+  void Unlink(frame_id_t frame_id);
+
+  /** Link a frame at the most recently used end of the list. */
+  void PushBack(frame_id_t frame_id);
+
+  frame_id_t head_;        // index of the sentinel node, head_.next_ is the least recently used frame
+  vector<LRUNode> nodes_;  // nodes_[frame_id] for each frame, plus the sentinel
+  size_t size_{0};
 };
 
 #endif  // MINISQL_LRU_REPLACER_H
@@ -0,0 +1,132 @@
+#ifndef MINISQL_PAGE_GUARD_H
+#define MINISQL_PAGE_GUARD_H
+
+#include <type_traits>
+
+#include "common/macros.h"
+#include "page/page.h"
+
+class BufferPoolManager;
+
+/**
+ * ReadPageGuard owns one pin and the read latch of a page. Both are released when the guard is dropped, destroyed or
+ * overwritten by another guard. Guards are move-only, so the pin can never be released twice.
+ *
+ * Most page classes are not const-correct, so As() hands out a mutable pointer. Callers must not modify the page
+ * through a read guard.
+ */
+class ReadPageGuard {
+ public:
+  ReadPageGuard() = default;
+
+  /**
+   * @param page a page which is already pinned and read latched by the caller
+   */
+  ReadPageGuard(BufferPoolManager *buffer_pool_manager, Page *page);
+
+  ReadPageGuard(ReadPageGuard &&that) noexcept;
+
+  ReadPageGuard &operator=(ReadPageGuard &&that) noexcept;
+
+  DISALLOW_COPY(ReadPageGuard)
+
+  ~ReadPageGuard();
+
+  /**
+   * Release the latch and the pin now. Does nothing if the guard is empty.
+   */
+  void Drop();
+
+  /** @return false if the guard holds no page, e.g. because the fetch failed */
+  inline bool IsValid() const { return page_ != nullptr; }
+
+  inline page_id_t GetPageId() const { return page_->GetPageId(); }
+
+  inline const char *GetData() const { return page_->GetData(); }
+
+  /**
+   * View the page as T. Page classes derived from Page (e.g. TablePage) are cast from the Page itself, raw layouts
+   * (e.g. BPlusTreePage) from its data.
+   */
+  template <typename T>
+  inline T *As() const {
+    if constexpr (std::is_base_of_v<Page, T>) {
+      return reinterpret_cast<T *>(page_);
+    } else {
+      return reinterpret_cast<T *>(page_->GetData());
+    }
+  }
+
+ private:
+  BufferPoolManager *buffer_pool_manager_{nullptr};
+  Page *page_{nullptr};
+};
+
+/**
+ * WritePageGuard owns one pin and the write latch of a page. The page is unpinned as dirty if it was handed out
+ * through AsMut()/GetDataMut() or MarkDirty() was called.
+ */
+class WritePageGuard {
+ public:
+  WritePageGuard() = default;
+
+  /**
+   * @param page a page which is already pinned and write latched by the caller
+   */
+  WritePageGuard(BufferPoolManager *buffer_pool_manager, Page *page);
+
+  WritePageGuard(WritePageGuard &&that) noexcept;
+
+  WritePageGuard &operator=(WritePageGuard &&that) noexcept;
+
+  DISALLOW_COPY(WritePageGuard)
+
+  ~WritePageGuard();
+
+  /**
+   * Release the latch and the pin now. Does nothing if the guard is empty.
+   */
+  void Drop();
+
+  /** @return false if the guard holds no page, e.g. because the fetch failed */
+  inline bool IsValid() const { return page_ != nullptr; }
+
+  inline page_id_t GetPageId() const { return page_->GetPageId(); }
+
+  inline const char *GetData() const { return page_->GetData(); }
+
+  inline char *GetDataMut() {
+    is_dirty_ = true;
+    return page_->GetData();
+  }
+
+  inline void MarkDirty() { is_dirty_ = true; }
+
+  /**
+   * View the page as T without marking it dirty, see ReadPageGuard::As().
+   */
+  template <typename T>
+  inline T *As() const {
+    if constexpr (std::is_base_of_v<Page, T>) {
+      return reinterpret_cast<T *>(page_);
+    } else {
+      return reinterpret_cast<T *>(page_->GetData());
+    }
+  }
+
+  /**
+   * View the page as T and mark it dirty.
+   */
+  template <typename T>
+  inline T *AsMut() {
+    is_dirty_ = true;
+    return As<T>();
+  }
+
+ private:
+  BufferPoolManager *buffer_pool_manager_{nullptr};
+  Page *page_{nullptr};
+  bool is_dirty_{false};
+};
+
+#endif  // MINISQL_PAGE_GUARD_H
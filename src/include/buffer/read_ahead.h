@@ -0,0 +1,51 @@
+#ifndef MINISQL_READ_AHEAD_H
+#define MINISQL_READ_AHEAD_H
+
+#include <deque>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+
+/**
+ * ReadAhead issues prefetch requests for a scan which follows a chain of pages, such as the table heap or the leaf
+ * level of a B+ tree.
+ *
+ * Only the next page of the chain is known for sure from the page itself, so it is always requested. The page after it
+ * is only known once the next page has been read, so following next_page_id further ahead would make every prefetch
+ * wait for the one before it. Instead, the window requests the pages ahead in one go:
+ * - If the owner of the chain knows its pages in order, e.g. a table heap from its free space map, the window holds
+ *   the pages which follow in the chain.
+ * - Otherwise the window guesses the pages ahead by adjacency: pages split off a B+ tree leaf are mostly allocated one
+ *   after the other, so the chain is usually laid out in page id order. The window only opens once page p links to
+ *   page p + 1, and it ends at the first page id which is not allocated, so a guess never reads a free page.
+ * The window starts at READ_AHEAD_MIN_WINDOW and doubles with every step the scan takes onto a requested page, up to
+ * READ_AHEAD_MAX_WINDOW; a step anywhere else closes it again, so a chain which is not sequential only costs the
+ * requests for its next pages.
+ */
+class ReadAhead {
+ public:
+  /** Append up to count pages which follow page_id in the chain to page_ids. */
+  using ChainPages = std::function<void(page_id_t page_id, size_t count, std::vector<page_id_t> *page_ids)>;
+
+  /**
+   * @param chain_pages lists the pages ahead in the chain, if null they are guessed by adjacency
+   */
+  explicit ReadAhead(ChainPages chain_pages = nullptr) : chain_pages_(std::move(chain_pages)) {}
+
+  /**
+   * Called when the scan arrives at a new page.
+   * @param page_id the page the scan is on now
+   * @param next_page_id the next page in the chain, INVALID_PAGE_ID at the end
+   */
+  void OnNewPage(BufferPoolManager *buffer_pool_manager, page_id_t page_id, page_id_t next_page_id);
+
+ private:
+  ChainPages chain_pages_;
+  std::deque<page_id_t> ahead_;  // pages handed to PrefetchPages which the scan has not reached yet, in chain order
+  int window_{0};
+};
+
+#endif  // MINISQL_READ_AHEAD_H
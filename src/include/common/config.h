@@ -13,8 +13,39 @@ static constexpr int META_PAGE_ID = 0;          // physical page id of the disk
 static constexpr int CATALOG_META_PAGE_ID = 0;  // logical page id of the catalog meta data
 static constexpr int INDEX_ROOTS_PAGE_ID = 1;   // logical page id of the index roots
 
-static constexpr int PAGE_SIZE = 4096;                  // size of a data page in byte
-static constexpr int DEFAULT_BUFFER_POOL_SIZE = 20480;  // default size of buffer pool
+// the page size is fixed per build, configure with -DMINISQL_PAGE_SIZE=8192 etc. A db file records the page size it
+// was created with and cannot be opened by a build with another one.
+#ifndef MINISQL_PAGE_SIZE
+#define MINISQL_PAGE_SIZE 4096
+#endif
+
+static constexpr int PAGE_SIZE = MINISQL_PAGE_SIZE;      // size of a data page in byte
+static_assert(PAGE_SIZE == 4096 || PAGE_SIZE == 8192 || PAGE_SIZE == 16384 || PAGE_SIZE == 32768,
+              "page size must be 4, 8, 16 or 32 KB");
+static constexpr int PAGE_TRAILER_SIZE = 4;              // CRC32C of the page, see DiskManager
+static constexpr int PAGE_USABLE_SIZE = PAGE_SIZE - PAGE_TRAILER_SIZE;  // bytes of a page its layout may use
+static constexpr int DEFAULT_BUFFER_POOL_SIZE = 20480 * 4096 / PAGE_SIZE;  // default size of buffer pool, 80 MB
+static constexpr int DEFAULT_BUFFER_POOL_INSTANCES = 8;  // default number of buffer pool instances
+
+static constexpr double DEFAULT_FLUSHER_CLEAN_RATIO = 0.5;  // fraction of frames the background flusher keeps clean
+static constexpr int DEFAULT_FLUSHER_INTERVAL_MS = 10;      // how often the background flusher wakes up
+static constexpr int DEFAULT_FLUSHER_BATCH_SIZE = 32;       // pages written while holding an instance latch
+
+static constexpr int DEFAULT_IO_QUEUE_DEPTH = 32;  // batched disk requests kept in flight at once
+
+static constexpr int PREFETCH_QUEUE_SIZE = 1024;  // pending prefetch requests, further requests are dropped
+static constexpr int PREFETCH_BATCH_SIZE = 32;    // pages the I/O thread reads with one batch
+static constexpr int READ_AHEAD_MIN_WINDOW = 4;   // pages read ahead once a scan looks sequential
+static constexpr int READ_AHEAD_MAX_WINDOW = 64;  // the read ahead window doubles up to this many pages
+
+static constexpr int INSERT_BATCH_SIZE = 1024;  // rows an insert hands to the table heap and indexes at once
+
+static constexpr size_t ARENA_BLOCK_SIZE = 64 * 1024;  // bytes a query arena allocates from the heap at once
+
+static constexpr int OPTIMISTIC_READ_RETRIES = 8;  // restarts of an unlatched index lookup before it takes latches
+
+static constexpr size_t INDEX_SORT_MEMORY = 64 * 1024 * 1024;  // bytes of keys CREATE INDEX sorts before it spills runs
+static constexpr double INDEX_FILL_FACTOR = 0.9;  // how full CREATE INDEX packs the nodes, leaving room for inserts
 
 static constexpr uint32_t FIELD_NULL_LEN = UINT32_MAX;
 static constexpr uint32_t VARCHAR_MAX_LEN = PAGE_SIZE / 2;  // max length of varchar
@@ -14,7 +14,10 @@
 
 class DBStorageEngine {
  public:
-  explicit DBStorageEngine(std::string db_name, bool init = true, uint32_t buffer_pool_size = DEFAULT_BUFFER_POOL_SIZE);
+  explicit DBStorageEngine(std::string db_name, bool init = true, uint32_t buffer_pool_size = DEFAULT_BUFFER_POOL_SIZE,
+                           uint32_t buffer_pool_instances = DEFAULT_BUFFER_POOL_INSTANCES,
+                           ReplacerType replacer_type = ReplacerType::kLRU, bool direct_io = false,
+                           bool mmap_read_only = false, bool page_checksums = false);
 
   ~DBStorageEngine();
 
@@ -0,0 +1,85 @@
+#ifndef MINISQL_MEMORY_ARENA_H
+#define MINISQL_MEMORY_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+/**
+ * MemoryArena hands out memory by bumping a pointer through large blocks and frees it all at once, in Reset() or when
+ * the arena is destroyed. Objects allocated from it are never destructed, so only types which need no destructor, or
+ * whose destructor has nothing to do, e.g. Fields which do not manage their data, may live in it.
+ *
+ * Not thread safe, an arena belongs to one query.
+ */
+class MemoryArena {
+ public:
+  explicit MemoryArena(size_t block_size = ARENA_BLOCK_SIZE) : block_size_(block_size) {}
+
+  ~MemoryArena() = default;
+
+  DISALLOW_COPY_AND_MOVE(MemoryArena);
+
+  /**
+   * @return size bytes aligned to alignment, valid until the arena is reset
+   */
+  void *Allocate(size_t size, size_t alignment = alignof(std::max_align_t)) {
+    size_t padding = (alignment - reinterpret_cast<uintptr_t>(cur_) % alignment) % alignment;
+    if (cur_ == nullptr || padding + size > remaining_) {
+      return AllocateSlow(size, alignment);
+    }
+    char *ptr = cur_ + padding;
+    cur_ = ptr + size;
+    remaining_ -= padding + size;
+    allocated_bytes_ += size;
+    return ptr;
+  }
+
+  /** Construct a T in the arena, its destructor is never called */
+  template <typename T, typename... Args>
+  T *New(Args &&...args) {
+    return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+  }
+
+  /** @return a copy of len bytes of data in the arena */
+  char *CopyBytes(const char *data, size_t len) {
+    auto copy = static_cast<char *>(Allocate(len, 1));
+    memcpy(copy, data, len);
+    return copy;
+  }
+
+  /**
+   * Free everything allocated so far. The first block is kept for the next allocations.
+   */
+  void Reset();
+
+  /** @return bytes handed out since the last reset */
+  size_t GetAllocatedBytes() const { return allocated_bytes_; }
+
+  /** @return number of blocks the arena holds, large allocations included */
+  size_t GetBlockCount() const { return blocks_.size() + large_blocks_.size(); }
+
+  /** @return number of blocks allocated from the heap since the arena was created, resets included */
+  size_t GetBlockAllocations() const { return block_allocations_; }
+
+ private:
+  /** Allocate from a new block, allocations larger than a quarter block get a block of their own */
+  void *AllocateSlow(size_t size, size_t alignment);
+
+ private:
+  size_t block_size_;
+  std::vector<std::unique_ptr<char[]>> blocks_;        // the last one is the current block
+  std::vector<std::unique_ptr<char[]>> large_blocks_;  // one per large allocation
+  char *cur_{nullptr};   // next free byte of the current block
+  size_t remaining_{0};  // bytes left in the current block
+  size_t allocated_bytes_{0};
+  size_t block_allocations_{0};
+};
+
+#endif  // MINISQL_MEMORY_ARENA_H
@@ -8,6 +8,7 @@
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/catalog.h"
 #include "common/macros.h"
+#include "common/memory_arena.h"
 #include "concurrency/txn.h"
 
 class ExecuteContext {
@@ -34,6 +35,9 @@ class ExecuteContext {
   /** @return the buffer pool manager */
   BufferPoolManager *GetBufferPoolManager() { return bpm_; }
 
+  /** @return the arena rows of the query are allocated from, it is freed with the context when the query ends */
+  MemoryArena *GetArena() { return &arena_; }
+
  private:
   /** The recovery context associated with this executor context */
   Txn *transaction_;
@@ -41,6 +45,8 @@ class ExecuteContext {
   CatalogManager *catalog_;
   /** The buffer pool manager associated with this executor context */
   BufferPoolManager *bpm_;
+  /** Memory of the rows the executors produce */
+  MemoryArena arena_;
 };
 
 #endif  // MINISQL_EXECUTE_CONTEXT_H
@@ -71,6 +71,8 @@ class ExecuteEngine {
 
   dberr_t ExecuteExecfile(pSyntaxNode ast, ExecuteContext *context);
 
+  dberr_t ExecuteVacuum(pSyntaxNode ast, ExecuteContext *context);
+
   dberr_t ExecuteQuit(pSyntaxNode ast, ExecuteContext *context);
 
  private:
@@ -47,4 +47,6 @@ class IndexScanExecutor : public AbstractExecutor {
   vector<RowId> result_;
   size_t cursor_ = 0;
   bool is_schema_same_;
+  std::unique_ptr<RowView> view_;         // reused for every fetched tuple
+  std::vector<uint32_t> output_columns_;  // table column of every output column
 };
\ No newline at end of file
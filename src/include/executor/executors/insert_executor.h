@@ -12,7 +12,9 @@
 /**
  * InsertExecutor executes an insert on a table.
  *
- * Inserted values are always pulled from a child executor.
+ * Inserted values are always pulled from a child executor. They are inserted in batches of up to INSERT_BATCH_SIZE
+ * rows, which go to the table heap and to every index at once. An insert stops at the first row whose key already
+ * exists, the rows before it are inserted.
  */
 class InsertExecutor : public AbstractExecutor {
  public:
@@ -41,6 +43,10 @@ class InsertExecutor : public AbstractExecutor {
   /** @return The output schema for the insert */
   const Schema *GetOutputSchema() const override { return plan_->OutputSchema(); }
 
+ private:
+  /** Pull the next batch of rows from the child executor and insert it, sets pending_count_ */
+  void InsertBatch();
+
  private:
   /** The insert plan node to be executed*/
   const InsertPlanNode *plan_;
@@ -48,6 +54,8 @@ class InsertExecutor : public AbstractExecutor {
   TableInfo *table_info_{};
   const Schema *schema_{};
   std::vector<IndexInfo *> index_info_;
+  size_t pending_count_{0};  // inserted rows not yet yielded by Next()
+  bool is_done_{false};      // the child is exhausted or a duplicate key was found
 };
 
 #endif  // MINISQL_INSERT_EXECUTOR_H
@@ -5,14 +5,18 @@
 #ifndef MINISQL_SEQ_SCAN_EXECUTOR_H
 #define MINISQL_SEQ_SCAN_EXECUTOR_H
 
+#include <memory>
 #include <vector>
 
 #include "executor/execute_context.h"
 #include "executor/executors/abstract_executor.h"
 #include "executor/plans/seq_scan_plan.h"
+#include "storage/table_scanner.h"
 
 /**
  * The SeqScanExecutor executor executes a sequential table scan.
+ *
+ * The predicate is evaluated on the tuples in place, only the rows it accepts are copied out of the page.
  */
 class SeqScanExecutor : public AbstractExecutor {
  public:
@@ -45,9 +49,10 @@ class SeqScanExecutor : public AbstractExecutor {
   /** The sequential scan plan node to be executed */
   const SeqScanPlanNode *plan_;
   TableInfo *table_info_{};
-  TableIterator iterator_;
+  std::unique_ptr<TableScanner> scanner_;
   const Schema *schema_{};
   bool is_schema_same_;
+  std::vector<uint32_t> output_columns_;  // table column of every output column
 };
 
 #endif  // MINISQL_SEQ_SCAN_EXECUTOR_H
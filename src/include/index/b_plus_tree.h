@@ -1,10 +1,16 @@
 #ifndef MINISQL_B_PLUS_TREE_H
 #define MINISQL_B_PLUS_TREE_H
 
+#include <atomic>
+#include <fstream>
+#include <functional>
+#include <mutex>
 #include <queue>
+#include <shared_mutex>
 #include <string>
 #include <vector>
 
+#include "buffer/page_guard.h"
 #include "concurrency/txn.h"
 #include "index/index_iterator.h"
 #include "page/b_plus_tree_internal_page.h"
@@ -20,6 +26,14 @@
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ *
+ * Insert, Remove and GetValue may be called from several threads. Readers do not latch pages, they validate what they
+ * read against the page versions and restart if a writer got in between. Writers couple read latches down the tree and
+ * only write latch the leaf; if the leaf would split or merge, they restart and write latch the path from the topmost
+ * page the change can reach. Writers change root_page_id_ under the root latch, readers load it without the latch and
+ * check it against the version of the root page. Iterators do not latch the leaves they walk.
+ * Pages merged away are reused by later splits and only deleted with the tree, so a reader never visits a deleted page.
+ * The list of them is kept in memory only: after a crash they stay allocated in the file without belonging to the tree.
  */
 class BPlusTree {
   using InternalPage = BPlusTreeInternalPage;
@@ -29,27 +43,36 @@ class BPlusTree {
   explicit BPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager, const KeyManager &comparator,
                      int leaf_max_size = UNDEFINED_SIZE, int internal_max_size = UNDEFINED_SIZE);
 
+  ~BPlusTree();
+
   // Returns true if this B+ tree has no keys and values.
   bool IsEmpty() const;
 
-  // Insert a key-value pair into this B+ tree.
+  // Insert a key-value pair into this B+ tree, false if the key exists or the file is mapped read-only.
   bool Insert(GenericKey *key, const RowId &value, Txn *transaction = nullptr);
 
-  // Remove a key and its value from this B+ tree.
-  void Remove(const GenericKey *key, Txn *transaction = nullptr);
+  // Remove a key and its value from this B+ tree, false if the file is mapped read-only.
+  bool Remove(const GenericKey *key, Txn *transaction = nullptr);
 
   // return the value associated with a given key
   bool GetValue(const GenericKey *key, std::vector<RowId> &result, Txn *transaction = nullptr);
 
+  // Build an empty tree bottom-up from the entries next() returns in ascending key order, false if it is not empty or
+  // the file is mapped read-only.
+  bool BulkLoad(const std::function<bool(GenericKey *key, RowId *value)> &next, double fill_factor = INDEX_FILL_FACTOR);
+
   IndexIterator Begin();
 
   IndexIterator Begin(const GenericKey *key);
 
   IndexIterator End();
 
-  // expose for test purpose
+  // expose for test purpose, page_id INVALID_PAGE_ID starts at the root
   Page *FindLeafPage(const GenericKey *key, page_id_t page_id = INVALID_PAGE_ID, bool leftMost = false);
 
+  // expose for test purpose, lookups take read latches instead of validating page versions if false
+  void SetOptimisticReads(bool optimistic_reads) { optimistic_reads_ = optimistic_reads; }
+
   // used to check whether all pages are unpinned
   bool Check();
 
@@ -68,31 +91,83 @@ class BPlusTree {
   }
 
  private:
+  // the structure modification a pessimistic descent latches the path for
+  enum class Operation { kInsert, kRemove };
+
+  // the write latched path of a pessimistic descent, from the topmost page a split or merge can reach down to the leaf
+  struct Context {
+    std::unique_lock<std::shared_mutex> root_lock_;  // held while the root may change
+    std::vector<WritePageGuard> write_set_;
+    std::vector<WritePageGuard> sibling_set_;  // neighbors latched to redistribute or merge with
+    std::vector<page_id_t> deleted_pages_;     // merged away, handed to free_pages_ once the latches are released
+
+    // the pages latched so far, which are adopted without latching them again when they move to another parent
+    InternalPage::LatchedPages GetLatchedPages() {
+      InternalPage::LatchedPages latched;
+      for (auto &guard : write_set_) {
+        latched.push_back(&guard);
+      }
+      for (auto &guard : sibling_set_) {
+        latched.push_back(&guard);
+      }
+      return latched;
+    }
+  };
+
+  ReadPageGuard FindLeafPageRead(const GenericKey *key, page_id_t page_id = INVALID_PAGE_ID, bool leftMost = false);
+
+  Page *FindLeafPageUnlatched(const GenericKey *key, bool leftMost, uint64_t *version);
+
+  template <typename F>
+  bool ReadLeafPageUnlatched(const GenericKey *key, F &&read);
+
+  WritePageGuard FindLeafPageOptimistic(const GenericKey *key);
+
+  bool FindLeafPageWrite(const GenericKey *key, Operation op, Context &context);
+
+  bool IsSafe(const BPlusTreePage *page, Operation op) const;
+
+  WritePageGuard NewTreePage(page_id_t &page_id);
+
   void StartNewTree(GenericKey *key, const RowId &value);
 
-  bool InsertIntoLeaf(GenericKey *key, const RowId &value, Txn *transaction = nullptr);
+  bool InsertIntoLeaf(GenericKey *key, const RowId &value, Context &context, Txn *transaction = nullptr);
 
-  void InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlusTreePage *new_node, Txn *transaction = nullptr);
+  void InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlusTreePage *new_node, Context &context,
+                        size_t level, Txn *transaction = nullptr);
 
-  LeafPage *Split(LeafPage *node, Txn *transaction);
+  LeafPage *Split(LeafPage *node, WritePageGuard &new_guard, Txn *transaction);
 
-  InternalPage *Split(InternalPage *node, Txn *transaction);
+  InternalPage *Split(InternalPage *node, WritePageGuard &new_guard, Context &context, Txn *transaction);
 
   template <typename N>
-  bool CoalesceOrRedistribute(N *&node, Txn *transaction = nullptr);
+  void CoalesceOrRedistribute(N *node, Context &context, size_t level, Txn *transaction = nullptr);
 
-  bool Coalesce(InternalPage *&neighbor_node, InternalPage *&node, InternalPage *&parent, int index,
-                Txn *transaction = nullptr);
+  void Coalesce(InternalPage *neighbor_node, InternalPage *node, InternalPage *parent, int index, Context &context,
+                size_t level, Txn *transaction = nullptr);
 
-  bool Coalesce(LeafPage *&neighbor_node, LeafPage *&node, InternalPage *&parent, int index,
-                Txn *transaction = nullptr);
+  void Coalesce(LeafPage *neighbor_node, LeafPage *node, InternalPage *parent, int index, Context &context,
+                size_t level, Txn *transaction = nullptr);
 
-  void Redistribute(LeafPage *neighbor_node, LeafPage *node, int index);
+  void Redistribute(LeafPage *neighbor_node, LeafPage *node, InternalPage *parent, int index, Context &context);
 
-  void Redistribute(InternalPage *neighbor_node, InternalPage *node, int index);
+  void Redistribute(InternalPage *neighbor_node, InternalPage *node, InternalPage *parent, int index,
+                    Context &context);
 
   bool AdjustRoot(BPlusTreePage *node);
 
+  // the entries of an internal level which are not written to a node yet, see BulkLoad()
+  struct BulkLevel {
+    std::vector<char> keys_;  // the first key below every child
+    std::vector<page_id_t> children_;
+    int written_{0};  // nodes written to the level so far
+  };
+
+  void AddBulkChild(std::vector<BulkLevel> &levels, size_t level, const GenericKey *key, page_id_t child,
+                    int fill_size);
+
+  page_id_t WriteBulkInternal(std::vector<BulkLevel> &levels, size_t level, int count, int fill_size);
+
   void UpdateRootPageId(int insert_record = 0);
 
   /* Debug Routines for FREE!! */
@@ -102,11 +177,16 @@ class BPlusTree {
 
   // member variable
   index_id_t index_id_;
-  page_id_t root_page_id_{INVALID_PAGE_ID};
+  std::atomic<page_id_t> root_page_id_{INVALID_PAGE_ID};
+  std::shared_mutex root_latch_;
   BufferPoolManager *buffer_pool_manager_;
   KeyManager processor_;
   int leaf_max_size_;
   int internal_max_size_;
+  bool optimistic_reads_{true};
+  // pages merged away, reused by splits instead of deleted since unlatched readers may still visit them
+  std::mutex free_pages_latch_;
+  std::vector<page_id_t> free_pages_;
 };
 
 #endif  // MINISQL_B_PLUS_TREE_H
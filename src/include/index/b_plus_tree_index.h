@@ -11,6 +11,17 @@ class BPlusTreeIndex : public Index {
 
   dberr_t InsertEntry(const Row &key, RowId row_id, Txn *txn) override;
 
+  /**
+   * Insert the entries in key order, so that consecutive inserts descend to the same or the next leaf, which is still
+   * in the buffer pool.
+   */
+  dberr_t InsertEntries(const std::vector<Row> &keys, const std::vector<RowId> &row_ids, Txn *txn) override;
+
+  /**
+   * Sort the entries, on disk if they take more than INDEX_SORT_MEMORY, and build the tree bottom-up from them.
+   */
+  dberr_t BulkLoad(const std::function<bool(Row *key, RowId *row_id)> &next, Txn *txn) override;
+
   dberr_t RemoveEntry(const Row &key, RowId row_id, Txn *txn) override;
 
   dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Txn *txn, string compare_operator = "=") override;
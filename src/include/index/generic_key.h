@@ -11,6 +11,27 @@ class GenericKey {
   char data[0];
 };
 
+/**
+ * How the keys of an index are searched within a node, see KeyManager::LowerBound
+ */
+enum class KeyKind {
+  kGeneric,  // binary search with CompareKeys
+  kInt32,    // a single int column, branchless search on the normalized bytes as an integer
+};
+
+/**
+ * KeyManager turns the key rows of an index into GenericKeys of key_size_ bytes, and compares them.
+ *
+ * Keys are normalized: their bytes sort like the keys, so two keys are compared with one memcmp. Every column starts with a byte which is 0 for null and 1 otherwise, so nulls sort first,
+ * followed by
+ *  - int: the value big-endian, with the sign bit flipped
+ *  - float: the IEEE bits big-endian, all flipped for a negative number and only the sign bit flipped otherwise
+ *  - char: the chars zero-padded to the column length, then their length as 2 bytes big-endian, so a prefix of a
+ *    string sorts before it
+ *
+ * A node is searched by LowerBound and UpperBound, which are specialized for the kind of key. A single int key is
+ * loaded as one integer, its null byte above the value bits, which orders like the bytes.
+ */
 class KeyManager {
  public: /**/
   [[nodiscard]] inline GenericKey *InitKey() const {
@@ -18,57 +39,201 @@ class KeyManager {
   }
 
   inline void SerializeFromKey(GenericKey *key_buf, const Row &key, Schema *schema) const {
-    // initialize to 0
-    [[maybe_unused]] uint32_t size = key.GetSerializedSize(schema);
     ASSERT(key.GetFieldCount() == schema->GetColumnCount(), "field nums not match.");
-    ASSERT(size <= (uint32_t)key_size_, "Index key size exceed max key size.");
+    // initialize to 0
     memset(key_buf->data, 0, key_size_);
-    key.SerializeTo(key_buf->data, schema);
+    ASSERT(GetNormalizedKeySize(schema) <= (uint32_t)key_size_, "Index key size exceed max key size.");
+    EncodeKey(key_buf->data, key, schema);
   }
 
   inline void DeserializeToKey(const GenericKey *key_buf, Row &key, Schema *schema) const {
-    [[maybe_unused]] uint32_t ofs = key.DeserializeFrom(const_cast<char *>(key_buf->data), schema);
-    ASSERT(ofs <= (uint32_t)key_size_, "Index key size exceed max key size.");
+    DecodeKey(key_buf->data, key, schema);
   }
 
   // compare
   [[nodiscard]] inline int CompareKeys(const GenericKey *lhs, const GenericKey *rhs) const {
-    //    ASSERT(malloc_usable_size((void *)&lhs) == malloc_usable_size((void *)&rhs), "key size not match.");
-    uint32_t column_count = key_schema_->GetColumnCount();
-    Row lhs_key(INVALID_ROWID);
-    Row rhs_key(INVALID_ROWID);
-    DeserializeToKey(lhs, lhs_key, key_schema_);
-    DeserializeToKey(rhs, rhs_key, key_schema_);
-
-    for (uint32_t i = 0; i < column_count; i++) {
-      Field *lhs_value = lhs_key.GetField(i);
-      Field *rhs_value = rhs_key.GetField(i);
-
-      if (lhs_value->CompareLessThan(*rhs_value) == CmpBool::kTrue) {
-        return -1;
-      }
+    return memcmp(lhs->data, rhs->data, key_size_);
+  }
 
-      if (lhs_value->CompareGreaterThan(*rhs_value) == CmpBool::kTrue) {
-        return 1;
-      }
+  /**
+   * @return index of the first of count keys, stride bytes apart, which is not less than key
+   */
+  inline int LowerBound(const char *keys, int count, size_t stride, const GenericKey *key) const {
+    if (kind_ == KeyKind::kInt32) {
+      return BranchlessBound<false>(keys, count, stride, LoadInt32Key(key->data));
+    }
+    return GenericBound<false>(keys, count, stride, key);
+  }
+
+  /**
+   * @return index of the first of count keys, stride bytes apart, which is greater than key
+   */
+  inline int UpperBound(const char *keys, int count, size_t stride, const GenericKey *key) const {
+    if (kind_ == KeyKind::kInt32) {
+      return BranchlessBound<true>(keys, count, stride, LoadInt32Key(key->data));
     }
-    // equals
-    return 0;
+    return GenericBound<true>(keys, count, stride, key);
   }
 
   inline int GetKeySize() const { return key_size_; }
 
+  inline KeyKind GetKeyKind() const { return kind_; }
+
+  /**
+   * @return the fastest kind of search the keys of the schema allow
+   */
+  static KeyKind DeduceKeyKind(const Schema *schema) {
+    if (schema->GetColumnCount() == 1 && schema->GetColumn(0)->GetType() == TypeId::kTypeInt) {
+      return KeyKind::kInt32;
+    }
+    return KeyKind::kGeneric;
+  }
+
+  /**
+   * @return bytes of a normalized key of the schema
+   */
+  static uint32_t GetNormalizedKeySize(const Schema *schema) {
+    uint32_t size = 0;
+    for (auto column : schema->GetColumns()) {
+      size += 1 + (column->GetType() == TypeId::kTypeChar ? column->GetLength() + sizeof(uint16_t) : sizeof(uint32_t));
+    }
+    return size;
+  }
+
   KeyManager(const KeyManager &other) {
     this->key_schema_ = other.key_schema_;
     this->key_size_ = other.key_size_;
+    this->kind_ = other.kind_;
   }
 
   // constructor
-  KeyManager(Schema *key_schema, size_t key_size) : key_size_(key_size), key_schema_(key_schema) {}
+  KeyManager(Schema *key_schema, size_t key_size) : KeyManager(key_schema, key_size, DeduceKeyKind(key_schema)) {}
+
+  KeyManager(Schema *key_schema, size_t key_size, KeyKind kind)
+      : key_size_(key_size), key_schema_(key_schema), kind_(kind) {
+    ASSERT(kind == KeyKind::kGeneric || kind == DeduceKeyKind(key_schema), "Key kind does not fit the schema.");
+  }
+
+ private:
+  /** @return a normalized int key as an integer: the null byte, then the value bits */
+  static inline uint64_t LoadInt32Key(const char *key) {
+    uint32_t value;
+    memcpy(&value, key + 1, sizeof(uint32_t));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    value = __builtin_bswap32(value);
+#endif
+    return (static_cast<uint64_t>(static_cast<uint8_t>(key[0])) << 32) | value;
+  }
+
+  /**
+   * Binary search without a branch on the keys, the comparison becomes a conditional move, so the search does not
+   * stall on mispredictions. Every step halves the range, whose first key is known to be before the target.
+   */
+  template <bool upper>
+  static inline int BranchlessBound(const char *keys, int count, size_t stride, uint64_t target) {
+    if (count == 0) {
+      return 0;
+    }
+    int base = 0;
+    while (count > 1) {
+      int half = count / 2;
+      uint64_t probe = LoadInt32Key(keys + (base + half) * stride);
+      base = (upper ? probe <= target : probe < target) ? base + half : base;
+      count -= half;
+    }
+    uint64_t probe = LoadInt32Key(keys + base * stride);
+    return base + (upper ? probe <= target : probe < target);
+  }
+
+  template <bool upper>
+  inline int GenericBound(const char *keys, int count, size_t stride, const GenericKey *key) const {
+    int left = 0;
+    int right = count;
+    while (left < right) {
+      int mid = (left + right) / 2;
+      int compare = CompareKeys(reinterpret_cast<const GenericKey *>(keys + mid * stride), key);
+      if (upper ? compare <= 0 : compare < 0) {
+        left = mid + 1;
+      } else {
+        right = mid;
+      }
+    }
+    return left;
+  }
+
+  static inline void WriteBigEndian(char *buf, uint32_t value, uint32_t size) {
+    for (uint32_t i = 0; i < size; i++) {
+      buf[i] = static_cast<char>(value >> (8 * (size - 1 - i)));
+    }
+  }
+
+  static inline uint32_t ReadBigEndian(const char *buf, uint32_t size) {
+    uint32_t value = 0;
+    for (uint32_t i = 0; i < size; i++) {
+      value = (value << 8) | static_cast<uint8_t>(buf[i]);
+    }
+    return value;
+  }
+
+  static void EncodeKey(char *buf, const Row &key, const Schema *schema) {
+    for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+      const Column *column = schema->GetColumn(i);
+      const Field *field = key.GetField(i);
+      *buf++ = field->IsNull() ? 0 : 1;
+      if (column->GetType() == TypeId::kTypeChar) {
+        if (!field->IsNull()) {
+          ASSERT(field->GetLength() <= column->GetLength(), "Char key longer than its column.");
+          memcpy(buf, field->GetData(), field->GetLength());
+          WriteBigEndian(buf + column->GetLength(), field->GetLength(), sizeof(uint16_t));
+        }
+        buf += column->GetLength() + sizeof(uint16_t);
+        continue;
+      }
+      if (!field->IsNull()) {
+        uint32_t bits;
+        field->SerializeTo(reinterpret_cast<char *>(&bits));
+        if (column->GetType() == TypeId::kTypeFloat) {
+          // -0.0 equals 0.0
+          bits = bits == 0x80000000u ? 0 : bits;
+          bits = (bits & 0x80000000u) ? ~bits : bits ^ 0x80000000u;
+        } else {
+          bits ^= 0x80000000u;
+        }
+        WriteBigEndian(buf, bits, sizeof(uint32_t));
+      }
+      buf += sizeof(uint32_t);
+    }
+  }
+
+  static void DecodeKey(const char *buf, Row &key, const Schema *schema) {
+    ASSERT(key.GetFieldCount() == 0, "Non empty field in row.");
+    for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+      const Column *column = schema->GetColumn(i);
+      bool is_null = *buf++ == 0;
+      if (column->GetType() == TypeId::kTypeChar) {
+        uint32_t len = ReadBigEndian(buf + column->GetLength(), sizeof(uint16_t));
+        key.GetFields().push_back(is_null ? new Field(TypeId::kTypeChar)
+                                          : new Field(TypeId::kTypeChar, const_cast<char *>(buf), len, true));
+        buf += column->GetLength() + sizeof(uint16_t);
+        continue;
+      }
+      uint32_t bits = ReadBigEndian(buf, sizeof(uint32_t));
+      if (column->GetType() == TypeId::kTypeFloat) {
+        bits = (bits & 0x80000000u) ? bits ^ 0x80000000u : ~bits;
+      } else {
+        bits ^= 0x80000000u;
+      }
+      Field *field = nullptr;
+      Field::DeserializeFrom(reinterpret_cast<char *>(&bits), column->GetType(), &field, is_null);
+      key.GetFields().push_back(field);
+      buf += sizeof(uint32_t);
+    }
+  }
 
  private:
   int key_size_;
   Schema *key_schema_;
+  KeyKind kind_;
 };
 
 #endif  // MINISQL_GENERIC_KEY_H
@@ -1,7 +1,9 @@
 #ifndef MINISQL_INDEX_H
 #define MINISQL_INDEX_H
 
+#include <functional>
 #include <memory>
+#include <vector>
 
 #include "common/dberr.h"
 #include "concurrency/txn.h"
@@ -15,6 +17,38 @@ class Index {
 
   virtual dberr_t InsertEntry(const Row &key, RowId row_id, Txn *txn) = 0;
 
+  /**
+   * Insert keys[i] -> row_ids[i] for all i. Indexes which profit from seeing the keys at once, e.g. to insert them in
+   * key order, override this.
+   * @return DB_FAILED if any of the entries could not be inserted, the others are inserted anyway
+   */
+  virtual dberr_t InsertEntries(const std::vector<Row> &keys, const std::vector<RowId> &row_ids, Txn *txn) {
+    dberr_t result = DB_SUCCESS;
+    for (size_t i = 0; i < keys.size(); i++) {
+      if (InsertEntry(keys[i], row_ids[i], txn) != DB_SUCCESS) {
+        result = DB_FAILED;
+      }
+    }
+    return result;
+  }
+
+  /**
+   * Fill an empty index with the entries next() returns until it returns false, e.g. when it is created on a
+   * populated table. Indexes which can be built faster than entry by entry override this.
+   * @return DB_FAILED if any of the entries could not be inserted, the others are inserted anyway
+   */
+  virtual dberr_t BulkLoad(const std::function<bool(Row *key, RowId *row_id)> &next, Txn *txn) {
+    dberr_t result = DB_SUCCESS;
+    Row key;
+    RowId row_id;
+    while (next(&key, &row_id)) {
+      if (InsertEntry(key, row_id, txn) != DB_SUCCESS) {
+        result = DB_FAILED;
+      }
+    }
+    return result;
+  }
+
   virtual dberr_t RemoveEntry(const Row &key, RowId row_id, Txn *txn) = 0;
 
   virtual dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Txn *txn, string compare_operator = "=") = 0;
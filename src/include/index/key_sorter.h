@@ -0,0 +1,99 @@
+#ifndef MINISQL_KEY_SORTER_H
+#define MINISQL_KEY_SORTER_H
+
+#include <cstdio>
+#include <sys/types.h>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "common/rowid.h"
+#include "index/generic_key.h"
+
+/**
+ * KeySorter sorts the (key, RowId) entries of an index in key order, e.g. to build a B+ tree bottom-up, see
+ * BPlusTree::BulkLoad. Entries are sorted in memory; once they take more than memory_limit bytes, the sorted entries
+ * are spilled to a temporary file as a run, and the runs are merged when the entries are read back.
+ *
+ * The sort is stable: of entries with equal keys, the one added first is returned and the others are dropped, like a
+ * unique index keeps the first of them when they are inserted one by one.
+ */
+class KeySorter {
+ public:
+  explicit KeySorter(const KeyManager &processor, size_t memory_limit = INDEX_SORT_MEMORY);
+
+  ~KeySorter();
+
+  DISALLOW_COPY_AND_MOVE(KeySorter);
+
+  void Add(const GenericKey *key, RowId value);
+
+  /**
+   * Sort the entries added, no more can be added afterwards.
+   */
+  void Sort();
+
+  /**
+   * Copy the next entry in key order to key and value.
+   * @return false once all entries were read
+   */
+  bool Next(GenericKey *key, RowId *value);
+
+  /** @return number of runs spilled to disk */
+  size_t GetRunCount() const { return runs_.size(); }
+
+  /** @return number of entries Next() dropped so far, since their key was returned before */
+  size_t GetDuplicateCount() const { return duplicate_count_; }
+
+ private:
+  // an entry in memory, ordered by the first bytes of a normalized key before the key itself is read
+  struct SortItem {
+    uint64_t prefix_;
+    uint32_t index_;  // entry in entries_
+  };
+
+  // a sorted run in the file, read back a buffer at a time
+  struct Run {
+    off_t offset_;      // file position of the first entry not read into buffer_ yet
+    size_t remaining_;  // entries in the file not read into buffer_ yet
+    std::vector<char> buffer_;
+    size_t pos_{0};   // entry of buffer_ to read next
+    size_t size_{0};  // entries in buffer_
+  };
+
+  /** Sort the entries in memory, into order_. */
+  void SortEntries();
+
+  /** Sort the entries in memory and write them to the file as a new run. */
+  void SpillRun();
+
+  /** Read the next entries of a run into its buffer. @return false if the run is exhausted */
+  bool FillRun(Run &run);
+
+  /** @return the next entry in key order, duplicates included, nullptr once all entries were read */
+  const char *NextEntry();
+
+  /** @return true if the current entry of run lhs is returned after the one of run rhs */
+  bool IsAfter(size_t lhs, size_t rhs) const;
+
+  inline const GenericKey *KeyOf(const char *entry) const { return reinterpret_cast<const GenericKey *>(entry); }
+
+ private:
+  const KeyManager &processor_;
+  size_t key_size_;
+  size_t entry_size_;   // key followed by the RowId
+  size_t max_entries_;  // entries sorted in memory at once
+  std::vector<char> entries_;
+  std::vector<SortItem> order_;  // the entries in key order, once sorted
+  size_t next_{0};               // position in order_ which Next() reads, if nothing was spilled
+  FILE *file_{nullptr};
+  off_t file_size_{0};
+  std::vector<Run> runs_;
+  std::vector<size_t> heap_;  // runs which are not exhausted, a min heap by their current entry
+  std::vector<char> entry_;   // the entry NextEntry() returned last when merging
+  std::vector<char> last_key_;
+  bool has_last_key_{false};
+  size_t duplicate_count_{0};
+};
+
+#endif  // MINISQL_KEY_SORTER_H
@@ -4,12 +4,13 @@
 #include <string.h>
 
 #include <queue>
+#include <vector>
 
 #include "index/generic_key.h"
 #include "page/b_plus_tree_page.h"
 
 #define INTERNAL_PAGE_HEADER_SIZE 28
-#define INTERNAL_PAGE_SIZE ((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (processor_.GetKeySize() + sizeof(page_id_t)) - 1)
+#define INTERNAL_PAGE_SIZE ((PAGE_USABLE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (processor_.GetKeySize() + sizeof(page_id_t)) - 1)
 /**
  * Store n indexed keys and n+1 child pointers (page_id) within internal page.
  * Pointer PAGE_ID(i) points to a subtree in which all keys K satisfy:
@@ -53,28 +54,37 @@ class BPlusTreeInternalPage : public BPlusTreePage {
 
   page_id_t RemoveAndReturnOnlyChild();
 
-  // Split and Merge utility methods
-  void MoveAllTo(BPlusTreeInternalPage *recipient, GenericKey *middle_key, BufferPoolManager *buffer_pool_manager);
+  // pages the caller holds the write latch of, a moved child among them is adopted without latching it again
+  using LatchedPages = std::vector<WritePageGuard *>;
 
-  void MoveHalfTo(BPlusTreeInternalPage *recipient, BufferPoolManager *buffer_pool_manager);
+  // Split and Merge utility methods, the moved children are write latched while they are adopted
+  void MoveAllTo(BPlusTreeInternalPage *recipient, GenericKey *middle_key, BufferPoolManager *buffer_pool_manager,
+                 const LatchedPages &latched = {});
+
+  void MoveHalfTo(BPlusTreeInternalPage *recipient, BufferPoolManager *buffer_pool_manager,
+                  const LatchedPages &latched = {});
 
   void MoveFirstToEndOf(BPlusTreeInternalPage *recipient, GenericKey *middle_key,
-                        BufferPoolManager *buffer_pool_manager);
+                        BufferPoolManager *buffer_pool_manager, const LatchedPages &latched = {});
 
   void MoveLastToFrontOf(BPlusTreeInternalPage *recipient, GenericKey *middle_key,
-                         BufferPoolManager *buffer_pool_manager);
+                         BufferPoolManager *buffer_pool_manager, const LatchedPages &latched = {});
 
  private:
-  void CopyNFrom(void *src, int size, BufferPoolManager *buffer_pool_manager);
+  void CopyNFrom(void *src, int size, BufferPoolManager *buffer_pool_manager, const LatchedPages &latched);
 
   /*void CopyLastFrom(GenericKey *key, page_id_t value, BufferPoolManager *buffer_pool_manager);
 
   void CopyFirstFrom(page_id_t value, BufferPoolManager *buffer_pool_manager);*/
-  void CopyLastFrom(GenericKey *key, page_id_t value, BufferPoolManager *buffer_pool_manager);
+  void CopyLastFrom(GenericKey *key, page_id_t value, BufferPoolManager *buffer_pool_manager,
+                    const LatchedPages &latched);
+
+  void CopyFirstFrom(GenericKey *key,page_id_t value, BufferPoolManager *buffer_pool_manager,
+                     const LatchedPages &latched);
 
-  void CopyFirstFrom(GenericKey *key,page_id_t value, BufferPoolManager *buffer_pool_manager);
+  void Adopt(page_id_t child, BufferPoolManager *buffer_pool_manager, const LatchedPages &latched);
 
-  char data_[PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE];
+  char data_[PAGE_USABLE_SIZE - INTERNAL_PAGE_HEADER_SIZE];
 };
 
 using InternalPage = BPlusTreeInternalPage;
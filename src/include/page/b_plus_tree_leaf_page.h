@@ -28,7 +28,7 @@
 #include "page/b_plus_tree_page.h"
 
 #define LEAF_PAGE_HEADER_SIZE 32
-#define LEAF_PAGE_SIZE ((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / (processor_.GetKeySize()+ sizeof(RowId)) - 1)
+#define LEAF_PAGE_SIZE ((PAGE_USABLE_SIZE - LEAF_PAGE_HEADER_SIZE) / (processor_.GetKeySize()+ sizeof(RowId)) - 1)
 
 class BPlusTreeLeafPage : public BPlusTreePage {
  public:
@@ -83,7 +83,7 @@ class BPlusTreeLeafPage : public BPlusTreePage {
 
   page_id_t next_page_id_{INVALID_PAGE_ID};
 
-  char data_[PAGE_SIZE - LEAF_PAGE_HEADER_SIZE];
+  char data_[PAGE_USABLE_SIZE - LEAF_PAGE_HEADER_SIZE];
 };
 
 using LeafPage = BPlusTreeLeafPage;
@@ -2,10 +2,14 @@
 #define MINISQL_BITMAP_PAGE_H
 
 #include <bitset>
+#include <cstdint>
 
 #include "common/config.h"
 #include "common/macros.h"
 
+/**
+ * The bitmap is scanned a 64-bit word at a time. next_free_page_ is a hint: no page before it is free.
+ */
 template <size_t PageSize>
 class BitmapPage {
  public:
@@ -20,6 +24,13 @@ class BitmapPage {
    */
   bool AllocatePage(uint32_t &page_offset);
 
+  /**
+   * Allocate the first run of num_pages contiguous free pages.
+   * @param page_offset Index in extent of the first page allocated.
+   * @return true if there was such a run.
+   */
+  bool AllocatePages(uint32_t num_pages, uint32_t &page_offset);
+
   /**
    * @return true if successfully de-allocate a page.
    */
@@ -40,11 +51,23 @@ class BitmapPage {
    */
   bool IsPageFreeLow(uint32_t byte_index, uint8_t bit_index) const;
 
-  /** Note: need to update if modify page structure. */
-  static constexpr size_t MAX_CHARS = PageSize - 2 * sizeof(uint32_t);
+  /**
+   * @return the first page at or after start whose bit equals is_free, GetMaxSupportedSize() if there is none
+   */
+  uint32_t FindPage(uint32_t start, bool is_free) const;
+
+  /** Bit i of word w records page w * 64 + i. */
+  uint64_t LoadWord(uint32_t word_index) const;
+
+  void StoreWord(uint32_t word_index, uint64_t word);
+
+  /** Note: need to update if modify page structure. Whole words only, the rest of the page is unused. */
+  static constexpr size_t MAX_CHARS = (PageSize - 2 * sizeof(uint32_t)) / sizeof(uint64_t) * sizeof(uint64_t);
+
+  static constexpr uint32_t NUM_WORDS = MAX_CHARS / sizeof(uint64_t);
 
  private:
-  /** The space occupied by all members of the class should be equal to the PageSize */
+  /** The space occupied by all members of the class should not exceed the PageSize */
   [[maybe_unused]] uint32_t page_allocated_;
   [[maybe_unused]] uint32_t next_free_page_;
   [[maybe_unused]] unsigned char bytes[MAX_CHARS];
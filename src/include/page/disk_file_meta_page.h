@@ -5,7 +5,12 @@
 
 #include "page/bitmap_page.h"
 
-static constexpr page_id_t MAX_VALID_PAGE_ID = (PAGE_SIZE - 8) / 4 * BitmapPage<PAGE_SIZE>::GetMaxSupportedSize();
+static constexpr page_id_t MAX_VALID_PAGE_ID =
+    (PAGE_USABLE_SIZE - 20) / 4 * BitmapPage<PAGE_USABLE_SIZE>::GetMaxSupportedSize();
+
+// version of the file layout, "MS" followed by the version number so that the unversioned layout, which keeps page
+// counts at the same offset, never matches it
+static constexpr uint32_t DISK_FILE_FORMAT_VERSION = 0x4d530003;
 
 class DiskFileMetaPage {
  public:
@@ -13,6 +18,15 @@ class DiskFileMetaPage {
 
   uint32_t GetAllocatedPages() { return num_allocated_pages_; }
 
+  /** @return true if every page of the file carries a checksum in its trailer */
+  bool HasChecksums() { return has_checksums_ != 0; }
+
+  /** @return the page size the file was created with */
+  uint32_t GetPageSize() { return page_size_; }
+
+  /** @return the layout version the file was created with */
+  uint32_t GetFormatVersion() { return format_version_; }
+
   uint32_t GetExtentUsedPage(uint32_t extent_id) {
     if (extent_id >= num_extents_) {
       return 0;
@@ -23,6 +37,9 @@ class DiskFileMetaPage {
  public:
   uint32_t num_allocated_pages_{0};
   uint32_t num_extents_{0};  // each extent consists with a bit map and BIT_MAP_SIZE pages
+  uint32_t has_checksums_{0};  // decided when the file is created
+  uint32_t page_size_{0};      // PAGE_SIZE of the build which created the file
+  uint32_t format_version_{0};  // DISK_FILE_FORMAT_VERSION of the build which created the file
   uint32_t extent_used_page_[0];
 };
 
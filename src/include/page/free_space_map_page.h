@@ -0,0 +1,70 @@
+#ifndef MINISQL_FREE_SPACE_MAP_PAGE_H
+#define MINISQL_FREE_SPACE_MAP_PAGE_H
+
+#include <cstdint>
+
+#include "common/config.h"
+
+/**
+ * One page of the free space map of a table heap, see FreeSpaceMap. Every table page has a one byte bucket with its
+ * free space in units of BUCKET_SIZE, rounded down, so a bucket never promises more space than the page has.
+ *
+ * Format (size in byte):
+ *  ----------------------------------------------------------------------------------------------------------
+ * | NextPageId (4) | EntryCount (4) | TablePageId_1 (4) | ... | TablePageId_max (4) | Bucket_1 (1) | ... |
+ *  ----------------------------------------------------------------------------------------------------------
+ */
+class FreeSpaceMapPage {
+ public:
+  static constexpr uint32_t BUCKET_SIZE = PAGE_SIZE / 256;
+  static constexpr uint32_t MAX_ENTRY_COUNT = (PAGE_USABLE_SIZE - 8) / (sizeof(page_id_t) + 1);
+
+  void Init() {
+    next_page_id_ = INVALID_PAGE_ID;
+    count_ = 0;
+  }
+
+  page_id_t GetNextPageId() const { return next_page_id_; }
+
+  void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+  uint32_t GetEntryCount() const { return count_; }
+
+  page_id_t GetTablePageId(uint32_t index) const { return page_ids_[index]; }
+
+  uint8_t GetBucket(uint32_t index) const { return GetBuckets()[index]; }
+
+  void SetBucket(uint32_t index, uint8_t bucket) { GetBuckets()[index] = bucket; }
+
+  /**
+   * @return false if the page is full
+   */
+  bool Append(page_id_t table_page_id, uint8_t bucket) {
+    if (count_ == MAX_ENTRY_COUNT) {
+      return false;
+    }
+    page_ids_[count_] = table_page_id;
+    SetBucket(count_++, bucket);
+    return true;
+  }
+
+  /** @return the bucket of a page with free_space bytes left */
+  static uint8_t ToBucket(uint32_t free_space) { return static_cast<uint8_t>(free_space / BUCKET_SIZE); }
+
+  /** @return the smallest bucket whose pages surely have size bytes left, above 255 if none has */
+  static uint32_t MinBucket(uint32_t size) { return (size + BUCKET_SIZE - 1) / BUCKET_SIZE; }
+
+ private:
+  static_assert(PAGE_USABLE_SIZE / BUCKET_SIZE < 256, "free space must fit in a bucket");
+
+  uint8_t *GetBuckets() { return reinterpret_cast<uint8_t *>(page_ids_ + MAX_ENTRY_COUNT); }
+
+  const uint8_t *GetBuckets() const { return reinterpret_cast<const uint8_t *>(page_ids_ + MAX_ENTRY_COUNT); }
+
+ private:
+  page_id_t next_page_id_;
+  uint32_t count_;
+  page_id_t page_ids_[0];
+};
+
+#endif  // MINISQL_FREE_SPACE_MAP_PAGE_H
@@ -1,8 +1,10 @@
 #ifndef MINISQL_PAGE_H
 #define MINISQL_PAGE_H
 
+#include <atomic>
 #include <cstring>
 #include <iostream>
+#include <memory>
 #include <shared_mutex>
 
 #include "common/config.h"
@@ -15,13 +17,13 @@
  */
 class Page {
   // There is book-keeping information inside the page that should only be relevant to the buffer pool manager.
-  friend class BufferPoolManager;
+  friend class BufferPoolManagerInstance;
 
  public:
   DISALLOW_COPY(Page)
 
-  /** Constructor. Zeros out the page data. */
-  Page() { ResetMemory(); }
+  /** Constructor. Zeros out the page data, which a page outside of the buffer pool owns. */
+  Page() : owned_data_(new char[PAGE_SIZE]{}), data_(owned_data_.get()) {}
 
   /** Default destructor. */
   ~Page() = default;
@@ -38,11 +40,17 @@ class Page {
   /** @return true if the page in memory has been modified from the page on disk, false otherwise */
   inline bool IsDirty() { return is_dirty_; }
 
-  /** Acquire the page write latch. */
-  inline void WLatch() { rwlatch_.WLock(); }
+  /** Acquire the page write latch, the version becomes odd. */
+  inline void WLatch() {
+    rwlatch_.WLock();
+    version_.fetch_add(1, std::memory_order_acq_rel);
+  }
 
-  /** Release the page write latch. */
-  inline void WUnlatch() { rwlatch_.WUnlock(); }
+  /** Release the page write latch, the version becomes even again. */
+  inline void WUnlatch() {
+    version_.fetch_add(1, std::memory_order_release);
+    rwlatch_.WUnlock();
+  }
 
   /** Acquire the page read latch. */
   inline void RLatch() { rwlatch_.RLock(); }
@@ -50,6 +58,20 @@ class Page {
   /** Release the page read latch. */
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
+  /**
+   * Optimistic readers do not latch the page: they read it at an even version and only trust what they read if the
+   * version is still the same afterwards, see ValidateVersion().
+   * @return the version of the page, odd while the page is write latched
+   */
+  inline uint64_t GetVersion() const { return version_.load(std::memory_order_acquire); }
+
+  /** @return true if the page was not write latched since it had the even version */
+  inline bool ValidateVersion(uint64_t version) const {
+    // the reads of the page must not move past the check
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version % 2 == 0 && version_.load(std::memory_order_relaxed) == version;
+  }
+
   /** @return the page LSN. */
   inline lsn_t GetLSN() { return *reinterpret_cast<lsn_t *>(GetData() + OFFSET_LSN); }
 
@@ -65,11 +87,16 @@ class Page {
   static constexpr size_t OFFSET_LSN = 4;
 
  private:
+  /** Constructor for the buffer pool, data is the frame's memory or nullptr. */
+  explicit Page(char *data) : data_(data) {}
+
   /** Zeroes out the data that is held within the page. */
   inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, PAGE_SIZE); }
 
-  /** The actual data that is stored within a page. */
-  char data_[PAGE_SIZE]{};
+  /** The memory of a page which is not in the buffer pool. */
+  std::unique_ptr<char[]> owned_data_;
+  /** The actual data that is stored within a page, a frame of the buffer pool or a page of a read-only mapping. */
+  char *data_{nullptr};
   /** The ID of this page. */
   page_id_t page_id_ = INVALID_PAGE_ID;
   /** The pin count of this page. */
@@ -78,6 +105,8 @@ class Page {
   bool is_dirty_ = false;
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
+  /** Count of write latch acquisitions and releases. */
+  std::atomic<uint64_t> version_{0};
 };
 
 #endif  // MINISQL_PAGE_H
@@ -12,9 +12,14 @@
  *  ----------------------------------------------------------------------------
  *  | PageId (4)| LSN (4)| PrevPageId (4)| NextPageId (4)| FreeSpacePointer(4) |
  *  ----------------------------------------------------------------------------
- *  ----------------------------------------------------------------
- *  | TupleCount (4) | Tuple_1 offset (4) | Tuple_1 size (4) | ... |
- *  ----------------------------------------------------------------
+ *  ---------------------------------------------------------------------------------------------------------
+ *  | TupleCount (4) | FreeSlot (4) | FragmentedSize (4) | Tuple_1 offset (4) | Tuple_1 size (4) | ... |
+ *  ---------------------------------------------------------------------------------------------------------
+ *
+ *  Deletes and updates do not move the other tuples, the space they free becomes a hole among the inserted tuples.
+ *  FragmentedSize counts the bytes in holes, Compact() moves the tuples together once an insert needs the room.
+ *  The slots of applied deletes have size 0 and form a list starting at FreeSlot, linked through their offsets, so
+ *  an insert reuses one without scanning the slot array.
  **/
 
 #include <cstring>
@@ -58,11 +63,50 @@ class TablePage : public Page {
 
   bool GetTuple(Row *row, Schema *schema, Txn *txn, LockManager *lock_manager);
 
+  /**
+   * @return the serialized tuple at rid, read in place, or nullptr if there is no such tuple
+   */
+  const char *GetTupleData(const RowId &rid) {
+    uint32_t slot_num = rid.GetSlotNum();
+    if (slot_num >= GetTupleCount() || IsDeleted(GetTupleSize(slot_num))) {
+      return nullptr;
+    }
+    return GetData() + GetTupleOffsetAtSlot(slot_num);
+  }
+
   bool GetFirstTupleRid(RowId *first_rid);
 
   bool GetNextTupleRid(const RowId &cur_rid, RowId *next_rid);
 
+  /**
+   * Move the tuples together at the end of the page, so that the holes become one free space, and drop the empty
+   * slots at the end of the slot array.
+   */
+  void Compact() { CompactTuples(INVALID_SLOT_NUM); }
+
+  /**
+   * Apply the delete of every tuple marked deleted, then compact the page.
+   */
+  void Vacuum(Txn *txn, LogManager *log_manager);
+
+  /** @return bytes left for tuples and their slots, including the holes */
+  uint32_t GetFreeSpaceRemaining() { return GetContiguousFreeSpace() + GetFragmentedSize(); }
+
+  /** @return bytes taken by tuples and slots, a page with at least this much free space can take all its tuples */
+  uint32_t GetUsedSpace() { return PAGE_USABLE_SIZE - SIZE_TABLE_PAGE_HEADER - GetFreeSpaceRemaining(); }
+
+  /** @return bytes InsertTuple needs for a tuple of serialized_size bytes */
+  static uint32_t GetSpaceNeeded(uint32_t serialized_size) { return serialized_size + SIZE_TUPLE; }
+
  private:
+  /** Compact() which also drops the data of slot dropped_slot, the slot itself is kept */
+  void CompactTuples(uint32_t dropped_slot);
+
+  /** @return bytes between the slot array and the tuples */
+  uint32_t GetContiguousFreeSpace() {
+    return GetFreeSpacePointer() - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE * GetTupleCount();
+  }
+
   uint32_t GetFreeSpacePointer() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SPACE); }
 
   void SetFreeSpacePointer(uint32_t free_space_pointer) {
@@ -73,9 +117,13 @@ class TablePage : public Page {
 
   void SetTupleCount(uint32_t tuple_count) { memcpy(GetData() + OFFSET_TUPLE_COUNT, &tuple_count, sizeof(uint32_t)); }
 
-  uint32_t GetFreeSpaceRemaining() {
-    return GetFreeSpacePointer() - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE * GetTupleCount();
-  }
+  uint32_t GetFreeSlot() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SLOT); }
+
+  void SetFreeSlot(uint32_t slot_num) { memcpy(GetData() + OFFSET_FREE_SLOT, &slot_num, sizeof(uint32_t)); }
+
+  uint32_t GetFragmentedSize() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FRAGMENTED_SIZE); }
+
+  void SetFragmentedSize(uint32_t size) { memcpy(GetData() + OFFSET_FRAGMENTED_SIZE, &size, sizeof(uint32_t)); }
 
   uint32_t GetTupleOffsetAtSlot(uint32_t slot_num) {
     return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_TUPLE_OFFSET + SIZE_TUPLE * slot_num);
@@ -102,17 +150,20 @@ class TablePage : public Page {
  private:
   static_assert(sizeof(page_id_t) == 4);
   static constexpr uint64_t DELETE_MASK = (1U << (8 * sizeof(uint32_t) - 1));
-  static constexpr size_t SIZE_TABLE_PAGE_HEADER = 24;
+  static constexpr uint32_t INVALID_SLOT_NUM = UINT32_MAX;
+  static constexpr size_t SIZE_TABLE_PAGE_HEADER = 32;
   static constexpr size_t SIZE_TUPLE = 8;
   static constexpr size_t OFFSET_PREV_PAGE_ID = 8;
   static constexpr size_t OFFSET_NEXT_PAGE_ID = 12;
   static constexpr size_t OFFSET_FREE_SPACE = 16;
   static constexpr size_t OFFSET_TUPLE_COUNT = 20;
-  static constexpr size_t OFFSET_TUPLE_OFFSET = 24;
-  static constexpr size_t OFFSET_TUPLE_SIZE = 28;
+  static constexpr size_t OFFSET_FREE_SLOT = 24;
+  static constexpr size_t OFFSET_FRAGMENTED_SIZE = 28;
+  static constexpr size_t OFFSET_TUPLE_OFFSET = 32;
+  static constexpr size_t OFFSET_TUPLE_SIZE = 36;
 
  public:
-  static constexpr size_t SIZE_MAX_ROW = PAGE_SIZE - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE;
+  static constexpr size_t SIZE_MAX_ROW = PAGE_USABLE_SIZE - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE;
 };
 
 #endif
\ No newline at end of file
@@ -43,7 +43,8 @@ typedef enum {
   kNodeIndexType,            /** type of index */
   kNodeTrxBegin,             /** begin recovery command */
   kNodeTrxCommit,            /** commit recovery command */
-  kNodeTrxRollback           /** rollback recovery command */
+  kNodeTrxRollback,          /** rollback recovery command */
+  kNodeVacuum                /** vacuum table command */
 } SyntaxNodeType;
 
 /**
@@ -9,6 +9,7 @@
 #include <vector>
 
 #include "record/row.h"
+#include "record/row_view.h"
 #include "record/schema.h"
 
 class AbstractExpression;
@@ -36,6 +37,13 @@ class AbstractExpression {
   /** @return The field obtained by evaluating the row */
   virtual Field Evaluate(const Row *row) const = 0;
 
+  /**
+   * Evaluate a row read in place. A char field which is returned may point into the row or into the expression, so
+   * it must not outlive either of them.
+   * @return The field obtained by evaluating the row
+   */
+  virtual Field Evaluate(const RowView &row) const = 0;
+
   /**
    * Returns the field obtained by evaluating a JOIN.
    * @param left_row The left row
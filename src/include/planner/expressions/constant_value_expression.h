@@ -18,6 +18,14 @@ class ConstantValueExpression : public AbstractExpression {
 
   Field Evaluate(const Row *row) const override { return Field(val_); }
 
+  /** A char constant is not copied, the field points into val_ */
+  Field Evaluate(const RowView &row) const override {
+    if (val_.GetTypeId() == TypeId::kTypeChar && !val_.IsNull()) {
+      return Field(TypeId::kTypeChar, const_cast<char *>(val_.GetData()), val_.GetLength(), false);
+    }
+    return Field(val_);
+  }
+
   Field EvaluateJoin(const Row *left_row, const Row *right_row) const override { return Field(val_); }
 
   const Field val_;
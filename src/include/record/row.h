@@ -5,23 +5,26 @@
 #include <vector>
 
 #include "common/macros.h"
+#include "common/memory_arena.h"
 #include "common/rowid.h"
 #include "record/field.h"
 #include "record/schema.h"
 
 /**
- *  Row format:
- * -------------------------------------------
- * | Header | Field-1 | ... | Field-N |
- * -------------------------------------------
- *  Header format:
- * --------------------------------------------
- * | Field Nums | Null bitmap |
- * -------------------------------------------
- *
+ *  Row format, any column is found in O(1):
+ * --------------------------------------------------------------------------------------------------
+ * | Null bitmap | Fixed-1 | ... | Fixed-M | VarEnd-1 (2) | ... | VarEnd-K (2) | Var-1 | ... | Var-K |
+ * --------------------------------------------------------------------------------------------------
+ *  The null bitmap has one bit per column. Int and float columns follow at offsets fixed by the schema, null ones
+ *  are zero. A char column keeps the offset where its data ends, relative to the row; its data begins where the one
+ *  of the char column before ends, or behind the offset array.
  *
+ * The fields of a row are allocated on the heap, or from a MemoryArena if the row was read with one, see
+ * RowView::ToRow. An arena row and its copies are only valid as long as the arena is not reset.
  */
 class Row {
+  friend class RowView;
+
  public:
   /**
    * Row used for insert
@@ -36,8 +39,11 @@ class Row {
 
   void destroy() {
     if (!fields_.empty()) {
-      for (auto field : fields_) {
-        delete field;
+      // the fields of an arena row are freed with the arena
+      if (arena_ == nullptr) {
+        for (auto field : fields_) {
+          delete field;
+        }
       }
       fields_.clear();
     }
@@ -56,13 +62,14 @@ class Row {
   Row(RowId rid) : rid_(rid) {}
 
   /**
-   * Row copy function, deep copy
+   * Row copy function, deep copy. The copy of an arena row is allocated from the same arena.
    */
   Row(const Row &other) {
     destroy();
     rid_ = other.rid_;
+    arena_ = other.arena_;
     for (auto &field : other.fields_) {
-      fields_.push_back(new Field(*field));
+      fields_.push_back(NewField(*field));
     }
   }
 
@@ -72,8 +79,9 @@ class Row {
   Row &operator=(const Row &other) {
     destroy();
     rid_ = other.rid_;
+    arena_ = other.arena_;
     for (auto &field : other.fields_) {
-      fields_.push_back(new Field(*field));
+      fields_.push_back(NewField(*field));
     }
     return *this;
   }
@@ -107,9 +115,19 @@ class Row {
 
   inline size_t GetFieldCount() const { return fields_.size(); }
 
+  /** @return the arena the fields are allocated from, nullptr for the heap */
+  inline MemoryArena *GetArena() const { return arena_; }
+
+ private:
+  /** Copy field to where the fields of this row live; char data of arena fields is shared, it lives in the arena */
+  inline Field *NewField(const Field &field) const {
+    return arena_ == nullptr ? new Field(field) : arena_->New<Field>(field);
+  }
+
  private:
   RowId rid_{};
   std::vector<Field *> fields_; /** Make sure that all field ptr are destructed*/
+  MemoryArena *arena_{nullptr};
 };
 
 #endif  // MINISQL_ROW_H
@@ -0,0 +1,70 @@
+#ifndef MINISQL_ROW_VIEW_H
+#define MINISQL_ROW_VIEW_H
+
+#include <vector>
+
+#include "common/memory_arena.h"
+#include "common/rowid.h"
+#include "record/field.h"
+#include "record/row.h"
+#include "record/schema.h"
+
+/**
+ * RowView reads the fields of a serialized row in place, e.g. from a latched table page, see Row for the formats.
+ * A field is only decoded when it is asked for, at the offset the schema gives for it. The view owns nothing; it is
+ * valid as long as the bytes it points to are.
+ *
+ * A view is meant to be reset to one row after the other, so a scan decodes its rows without allocating.
+ */
+class RowView {
+ public:
+  explicit RowView(const Schema *schema) : schema_(schema) {}
+
+  /** Point the view to the row serialized at data */
+  void Reset(const char *data, RowId rid) {
+    data_ = data;
+    rid_ = rid;
+  }
+
+  inline RowId GetRowId() const { return rid_; }
+
+  inline uint32_t GetFieldCount() const { return schema_->GetColumnCount(); }
+
+  inline bool IsNull(uint32_t idx) const {
+    ASSERT(idx < GetFieldCount(), "Failed to access field");
+    return (data_[idx / 8] >> (idx % 8)) & 1;
+  }
+
+  /**
+   * @return the field at idx. A char field points into the row, so it must not outlive the bytes the view is on.
+   */
+  Field GetField(uint32_t idx) const;
+
+  /**
+   * Copy all fields into row, which owns its fields afterwards.
+   * @param arena if set, the fields and their data are allocated from it instead of the heap, see Row
+   */
+  void ToRow(Row *row, MemoryArena *arena = nullptr) const;
+
+  /**
+   * Copy the fields at column_indexes into row, in that order.
+   */
+  void ToRow(const std::vector<uint32_t> &column_indexes, Row *row, MemoryArena *arena = nullptr) const;
+
+ private:
+  /**
+   * @return the value of the non-null field at idx
+   * @param len set to the length of a char field
+   */
+  const char *GetFieldData(uint32_t idx, uint32_t *len) const;
+
+  /** @return a field at idx with a copy of its data, allocated from arena if set */
+  Field *CopyField(uint32_t idx, MemoryArena *arena) const;
+
+ private:
+  const Schema *schema_;
+  const char *data_{nullptr};
+  RowId rid_{};
+};
+
+#endif  // MINISQL_ROW_VIEW_H
@@ -13,7 +13,9 @@
 class Schema {
  public:
   explicit Schema(const std::vector<Column *> columns, bool is_manage_ = true)
-      : columns_(std::move(columns)), is_manage_(is_manage_) {}
+      : columns_(std::move(columns)), is_manage_(is_manage_) {
+    InitLayout();
+  }
 
   ~Schema() {
     if (is_manage_) {
@@ -39,6 +41,20 @@ class Schema {
 
   inline uint32_t GetColumnCount() const { return static_cast<uint32_t>(columns_.size()); }
 
+  /** @return bytes of the null bitmap of a row */
+  inline uint32_t GetNullBitmapSize() const { return (GetColumnCount() + 7) / 8; }
+
+  /**
+   * @return offset in a row of a fixed-width column, or of the end offset of a char column in the offset array
+   */
+  inline uint32_t GetColumnOffset(const uint32_t column_index) const { return column_offsets_[column_index]; }
+
+  /** @return offset in a row of the offset array, where the first char column keeps its end offset */
+  inline uint32_t GetVarOffsetsBegin() const { return var_offsets_begin_; }
+
+  /** @return size of a row without its char data, which starts right behind */
+  inline uint32_t GetFixedRowSize() const { return fixed_row_size_; }
+
   /**
    * Shallow copy schema, only used in index
    *
@@ -80,10 +96,17 @@ class Schema {
    */
   static uint32_t DeserializeFrom(char *buf, Schema *&schema);
 
+ private:
+  /** Compute the offsets of the columns in a row */
+  void InitLayout();
+
  private:
   static constexpr uint32_t SCHEMA_MAGIC_NUM = 200715;
   std::vector<Column *> columns_;
   bool is_manage_ = false; /** if false, don't need to delete pointer to column */
+  std::vector<uint32_t> column_offsets_;
+  uint32_t var_offsets_begin_{0};
+  uint32_t fixed_row_size_{0};
 };
 
 using IndexSchema = Schema;
@@ -0,0 +1,40 @@
+#ifndef MINISQL_ASYNC_IO_H
+#define MINISQL_ASYNC_IO_H
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * Backends DiskManager can run batched page I/O on.
+ */
+enum class IOBackendType { kIOUring, kThreadPool };
+
+/**
+ * One page sized read or write at a byte offset of the db file.
+ */
+struct IORequest {
+  bool is_write{false};
+  size_t offset{0};
+  char *buffer{nullptr};
+  ssize_t result{0};  // number of bytes transferred, or -errno
+};
+
+/**
+ * AsyncIO is an abstract class for backends which keep several requests in flight at once.
+ */
+class AsyncIO {
+ public:
+  AsyncIO() = default;
+
+  virtual ~AsyncIO() = default;
+
+  /**
+   * Issue all requests, at most the queue depth of them at a time, and wait until every one of them has completed.
+   * May be called by several threads at once. The result of each request is stored in IORequest::result.
+   */
+  virtual void SubmitAndWait(std::vector<IORequest> &requests) = 0;
+};
+
+#endif  // MINISQL_ASYNC_IO_H
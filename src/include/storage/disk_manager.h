@@ -2,15 +2,18 @@
 #define DISK_MGR_H
 
 #include <atomic>
-#include <fstream>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
 #include "common/macros.h"
 #include "page/bitmap_page.h"
 #include "page/disk_file_meta_page.h"
+#include "storage/async_io.h"
 
 /**
  * DiskManager takes care of the allocation and de allocation of pages within a database. It performs the reading and
@@ -19,10 +22,34 @@
  * Disk page storage format: (Free Page BitMap Size = PAGE_SIZE * 8, we note it as N)
  * | Meta Page | Free Page BitMap 1 | Page 1 | Page 2 | ....
  *      | Page N | Free Page BitMap 2 | Page N+1 | ... | Page 2N | ... |
+ *
+ * Pages are read and written with pread/pwrite on a single file descriptor, so page I/O from different threads does
+ * not serialize on a shared file cursor. Only the meta page and the bitmaps are protected by db_io_latch_.
+ * ReadPages and WritePages hand a whole batch to an AsyncIO backend (io_uring, or a thread pool if io_uring is not
+ * available), which keeps up to DEFAULT_IO_QUEUE_DEPTH of them in flight.
+ *
+ * The bitmaps are cached in memory once read and written back together with the meta page by FlushMetadata and on
+ * Close, so allocating or freeing a page does no I/O. Allocation starts at the first extent which may still have a free page.
+ *
+ * With page checksums, WritePhysicalPage stamps the CRC32C of every page into its trailer (the last PAGE_TRAILER_SIZE
+ * bytes, which no page layout uses) and ReadPhysicalPage verifies it, so a torn or corrupted page is detected when it
+ * is read. The setting is stored in the meta page when the file is created, and so are PAGE_SIZE and
+ * DISK_FILE_FORMAT_VERSION: a file can only be opened by a build with the same page size and file format.
+ *
+ * A file opened with mmap_read_only is mapped read-only as a whole. The buffer pool then points its frames into the
+ * mapping instead of reading the pages, and the file can be neither written nor grown.
  */
 class DiskManager {
  public:
-  explicit DiskManager(const std::string &db_file);
+  /**
+   * @param direct_io open the file with O_DIRECT, so that pages are not cached by the OS a second time. Falls back to
+   * buffered I/O if the file system does not support it.
+   * @param mmap_read_only map the existing file read-only instead, direct_io is ignored then
+   * @param page_checksums checksum every page if the file is created, an existing file keeps its setting
+   */
+  explicit DiskManager(const std::string &db_file, bool direct_io = false,
+                       IOBackendType io_backend = IOBackendType::kIOUring, bool mmap_read_only = false,
+                       bool page_checksums = false);
 
   ~DiskManager() {
     if (!closed) {
@@ -33,8 +60,9 @@ class DiskManager {
   /**
    * Read page from specific page_id
    * Note: page_id = 0 is reserved for free page bit map
+   * @return false if the page does not match its checksum
    */
-  void ReadPage(page_id_t logical_page_id, char *page_data);
+  bool ReadPage(page_id_t logical_page_id, char *page_data);
 
   /**
    * Write data to specific page
@@ -42,12 +70,33 @@ class DiskManager {
    */
   void WritePage(page_id_t logical_page_id, const char *page_data);
 
+  /**
+   * Read several pages at once and return when all of them are in memory.
+   * @param pages pairs of logical page id and the buffer to read the page into
+   * @param[out] valid_pages if not null, whether each page matches its checksum, in the order of pages
+   * @return false if any page does not match its checksum
+   */
+  bool ReadPages(const std::vector<std::pair<page_id_t, char *>> &pages, std::vector<bool> *valid_pages = nullptr);
+
+  /**
+   * Write several pages at once and return when all of them are written.
+   * @param pages pairs of logical page id and the data of the page
+   */
+  void WritePages(const std::vector<std::pair<page_id_t, const char *>> &pages);
+
   /**
    * Get next free page from disk
    * @return logical page id of allocated page
    */
   page_id_t AllocatePage();
 
+  /**
+   * Allocate num_pages pages, preferring pages next to each other.
+   * @return runs of contiguous logical page ids as pairs of first page id and length, fewer pages than requested if
+   * the file is full
+   */
+  std::vector<std::pair<page_id_t, uint32_t>> AllocatePages(uint32_t num_pages);
+
   /**
    * Free this page and reset bit map
    */
@@ -63,43 +112,127 @@ class DiskManager {
    */
   void Close();
 
+  /**
+   * Write the dirty bitmaps and the meta page back and sync the file, so that the pages allocated so far survive a
+   * crash. Does nothing if the file is closed or read-only.
+   */
+  void FlushMetadata();
+
   /**
    * Get Meta Page
    * Note: Used only for debug
    */
   char *GetMetaData() { return meta_data_; }
 
-  static constexpr size_t BITMAP_SIZE = BitmapPage<PAGE_SIZE>::GetMaxSupportedSize();
+  /** @return true if the file is opened with O_DIRECT */
+  inline bool IsDirectIO() const { return direct_io_; }
+
+  /** @return true if the file is mapped read-only */
+  inline bool IsMapped() const { return mmap_read_only_; }
+
+  /** @return true if pages carry a checksum */
+  inline bool HasChecksums() const { return page_checksums_; }
 
- private:
   /**
-   * Helper function to get disk file size
+   * Only in mmap_read_only mode.
+   * @return the page inside the mapping, a page of zeros if it is beyond the end of the file, nullptr if the page does
+   * not match its checksum
    */
-  int GetFileSize(const std::string &file_name);
+  const char *GetMappedPage(page_id_t logical_page_id);
 
+  /**
+   * Only in mmap_read_only mode. Ask the OS to read the pages into the page cache in the background.
+   */
+  void WillNeedPages(const std::vector<page_id_t> &logical_page_ids);
+
+  /** @return the backend ReadPages and WritePages run on, io_uring falls back to the thread pool if unavailable */
+  IOBackendType GetIOBackend();
+
+  static constexpr size_t BITMAP_SIZE = BitmapPage<PAGE_USABLE_SIZE>::GetMaxSupportedSize();
+
+  static constexpr size_t DIRECT_IO_ALIGNMENT = 4096;  // buffers and offsets of O_DIRECT I/O must be aligned to this
+
+ private:
   /**
    * Read physical page from disk
+   * @return false if the page does not match its checksum
    */
-  void ReadPhysicalPage(page_id_t physical_page_id, char *page_data);
+  bool ReadPhysicalPage(page_id_t physical_page_id, char *page_data);
 
   /**
    * Write data to physical page in disk
    */
   void WritePhysicalPage(page_id_t physical_page_id, const char *page_data);
 
+  /**
+   * Run the requests on the async backend, redoing any request which failed or was short with the synchronous path.
+   * @param[out] valid_requests if not null, whether the page of each request matches its checksum
+   * @return false if any page read does not match its checksum
+   */
+  bool SubmitBatch(std::vector<IORequest> &requests, std::vector<bool> *valid_requests = nullptr);
+
+  /**
+   * Set up the async backend on first use.
+   */
+  AsyncIO *GetAsyncIO();
+
+  /**
+   * Raise the cached file size to at least end.
+   */
+  void GrowFileSize(size_t end);
+
   /**
    * Map logical page id to physical page id
    */
   page_id_t MapPageId(page_id_t logical_page_id);
 
+  /**
+   * Get the cached bitmap of the extent, reading it from disk on first use.
+   * Note: caller must hold db_io_latch_
+   */
+  BitmapPage<PAGE_USABLE_SIZE> *GetBitmap(uint32_t extent_id);
+
+  /**
+   * Allocate one page from the first extent with a free page, adding an extent if all are full.
+   * Note: caller must hold db_io_latch_
+   */
+  page_id_t AllocatePageLow();
+
+  /**
+   * Write the dirty bitmaps and the meta page back and sync the file.
+   * Note: caller must hold db_io_latch_
+   */
+  void WriteBackMetadata();
+
+  static inline page_id_t GetBitmapPhysicalId(uint32_t extent_id) { return extent_id * (BITMAP_SIZE + 1) + 1; }
+
  private:
-  // stream to write db file
-  std::fstream db_io_;
+  // descriptor of the db file
+  int db_fd_{-1};
   std::string file_name_;
-  // with multiple buffer pool instances, need to protect file access
+  // size of the db file, kept up to date by WritePhysicalPage
+  std::atomic<size_t> file_size_{0};
+  bool direct_io_{false};
+  bool mmap_read_only_{false};
+  bool page_checksums_{false};
+  // the whole file as of opening it, only in mmap_read_only mode
+  char *mapping_{nullptr};
+  size_t mapping_size_{0};
+  IOBackendType io_backend_;
+  std::once_flag async_io_once_;
+  std::unique_ptr<AsyncIO> async_io_;
+  // with multiple buffer pool instances, need to protect the meta page and the bitmaps
   std::recursive_mutex db_io_latch_;
   bool closed{false};
-  char meta_data_[PAGE_SIZE];
+  alignas(DIRECT_IO_ALIGNMENT) char meta_data_[PAGE_SIZE];
+  struct alignas(DIRECT_IO_ALIGNMENT) BitmapFrame {
+    char data_[PAGE_SIZE];
+  };
+  // bitmaps read so far, by extent id, and whether they differ from disk
+  std::vector<std::unique_ptr<BitmapFrame>> bitmaps_;
+  std::vector<bool> bitmap_dirty_;
+  // no extent before this one has a free page
+  uint32_t free_extent_hint_{0};
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,92 @@
+#ifndef MINISQL_FREE_SPACE_MAP_H
+#define MINISQL_FREE_SPACE_MAP_H
+
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/macros.h"
+#include "page/free_space_map_page.h"
+
+/**
+ * FreeSpaceMap records roughly how much space every page of a table heap has left, so that an insert finds a page
+ * with room without walking the page chain. The buckets are stored in a chain of FreeSpaceMapPages and mirrored in
+ * memory as a max tree, which finds a page with enough room in O(log n). The page which took the last insert is tried
+ * first, so appending to a table costs O(1).
+ *
+ * Pages are added in the order they are linked into the heap, so the last entry is the last page of the heap.
+ */
+class FreeSpaceMap {
+ public:
+  /**
+   * @param first_map_page_id the map to load, INVALID_PAGE_ID for an empty one. Its first page is allocated with the
+   * first table page added.
+   */
+  FreeSpaceMap(BufferPoolManager *buffer_pool_manager, page_id_t first_map_page_id);
+
+  DISALLOW_COPY_AND_MOVE(FreeSpaceMap);
+
+  /** @return the first page of the map, INVALID_PAGE_ID as long as it is empty */
+  page_id_t GetFirstPageId();
+
+  /** @return the table page added last, INVALID_PAGE_ID if there is none */
+  page_id_t GetLastPageId();
+
+  /** @return number of table pages in the map */
+  size_t GetPageCount();
+
+  /**
+   * @return a table page which has at least size bytes left according to the map, INVALID_PAGE_ID if there is none
+   */
+  page_id_t FindPage(uint32_t size);
+
+  /**
+   * Append up to count table pages which follow table_page_id in the page chain to page_ids. Nothing is appended for
+   * a page which is not in the map.
+   */
+  void GetPagesAfter(page_id_t table_page_id, size_t count, std::vector<page_id_t> *page_ids);
+
+  /**
+   * Add a table page linked behind the last one.
+   */
+  void AddPage(page_id_t table_page_id, uint32_t free_space);
+
+  /**
+   * Record the free space of a table page after it changed. Pages which are not in the map are ignored.
+   */
+  void UpdatePage(page_id_t table_page_id, uint32_t free_space);
+
+  /**
+   * Replace the table pages of the map, e.g. after pages were removed from the heap. The map keeps its first page,
+   * map pages it no longer needs are deleted.
+   * @param pages table page id and free space of every page, in the order of the page chain
+   */
+  void Reset(const std::vector<std::pair<page_id_t, uint32_t>> &pages);
+
+  /**
+   * Delete the map pages, the map is empty afterwards.
+   */
+  void Destroy();
+
+ private:
+  /** Store the bucket in the tree and the map page, if it changed. */
+  void SetBucket(size_t index, uint8_t bucket);
+
+  /** Grow the tree to hold at least num_leaves buckets. */
+  void Reserve(size_t num_leaves);
+
+ private:
+  BufferPoolManager *buffer_pool_manager_;
+  std::mutex latch_;
+  std::vector<page_id_t> map_page_ids_;
+  std::vector<page_id_t> table_page_ids_;                // in the order of the page chain
+  std::unordered_map<page_id_t, size_t> page_indexes_;  // table page id -> index into table_page_ids_
+  // max tree, the leaves start at num_leaves_ and hold the buckets of the table pages
+  std::vector<uint8_t> tree_;
+  size_t num_leaves_{0};
+  size_t hint_{0};  // index of the page which took the last insert
+};
+
+#endif  // MINISQL_FREE_SPACE_MAP_H
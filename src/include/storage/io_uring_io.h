@@ -0,0 +1,79 @@
+#ifndef MINISQL_IO_URING_IO_H
+#define MINISQL_IO_URING_IO_H
+
+#include <sys/uio.h>
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "common/macros.h"
+#include "storage/async_io.h"
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+/**
+ * IOUringIO submits reads and writes through an io_uring instance. The ring is set up with the raw system calls, so
+ * no liburing is needed.
+ *
+ * One batch owns the ring at a time: SubmitAndWait keeps up to queue_depth requests of its batch in flight, refilling
+ * the submission queue as completions arrive, and returns once the whole batch is done.
+ */
+class IOUringIO : public AsyncIO {
+ public:
+  /**
+   * @param fd the file all requests go to
+   * @param queue_depth maximum number of requests in flight
+   */
+  IOUringIO(int fd, unsigned queue_depth);
+
+  ~IOUringIO() override;
+
+  DISALLOW_COPY_AND_MOVE(IOUringIO);
+
+  /** @return false if the kernel refused to set up the ring, e.g. because io_uring is disabled */
+  inline bool IsAvailable() const { return ring_fd_ >= 0; }
+
+  void SubmitAndWait(std::vector<IORequest> &requests) override;
+
+ private:
+  /**
+   * Put one request into the next free submission queue entry.
+   * Note: caller must hold latch_
+   */
+  void Prepare(IORequest &request, iovec *iov, size_t index);
+
+  /**
+   * Move every available completion of the current batch into its request.
+   * Note: caller must hold latch_
+   * @return number of completions of the current batch consumed
+   */
+  size_t Reap(std::vector<IORequest> &requests);
+
+  void Release();
+
+ private:
+  int fd_;
+  int ring_fd_{-1};
+  unsigned queue_depth_{0};
+  std::mutex latch_;  // one batch uses the ring at a time
+  uint32_t batch_{0};  // sequence number of the current batch, the high half of the user data of its requests
+  // submission queue
+  void *sq_ring_{nullptr};
+  size_t sq_ring_size_{0};
+  std::atomic<unsigned> *sq_tail_{nullptr};
+  unsigned sq_mask_{0};
+  unsigned *sq_array_{nullptr};
+  io_uring_sqe *sqes_{nullptr};
+  size_t sqes_size_{0};
+  // completion queue, shares the mapping of the submission queue on recent kernels
+  void *cq_ring_{nullptr};
+  size_t cq_ring_size_{0};
+  std::atomic<unsigned> *cq_head_{nullptr};
+  std::atomic<unsigned> *cq_tail_{nullptr};
+  unsigned cq_mask_{0};
+  io_uring_cqe *cqes_{nullptr};
+};
+
+#endif  // MINISQL_IO_URING_IO_H
@@ -0,0 +1,22 @@
+#ifndef MINISQL_PAGE_CHECKSUM_H
+#define MINISQL_PAGE_CHECKSUM_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * CRC32C (Castagnoli) of len bytes. Uses the SSE4.2 crc32 instruction if the CPU has it.
+ */
+uint32_t Crc32c(const char *data, size_t len);
+
+/**
+ * Store the CRC32C of the first PAGE_USABLE_SIZE bytes of the page in its trailer.
+ */
+void StampPageChecksum(char *page_data);
+
+/**
+ * @return true if the trailer matches the page, or if the page is all zeros, i.e. it was never written
+ */
+bool VerifyPageChecksum(const char *page_data);
+
+#endif  // MINISQL_PAGE_CHECKSUM_H
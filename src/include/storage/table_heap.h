@@ -1,15 +1,22 @@
 #ifndef MINISQL_TABLE_HEAP_H
 #define MINISQL_TABLE_HEAP_H
 
+#include <mutex>
+#include <utility>
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
 #include "concurrency/lock_manager.h"
 #include "page/header_page.h"
 #include "page/table_page.h"
+#include "record/row_view.h"
 #include "recovery/log_manager.h"
+#include "storage/free_space_map.h"
 #include "storage/table_iterator.h"
 
 class TableHeap {
   friend class TableIterator;
+  friend class TableScanner;
 
  public:
   static TableHeap *Create(BufferPoolManager *buffer_pool_manager, Schema *schema, Txn *txn, LogManager *log_manager,
@@ -17,12 +24,17 @@ class TableHeap {
     return new TableHeap(buffer_pool_manager, schema, txn, log_manager, lock_manager);
   }
 
+  /**
+   * @param free_space_map_page_id the free space map of the heap, if INVALID_PAGE_ID it is built from the page chain
+   */
   static TableHeap *Create(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, Schema *schema,
-                           LogManager *log_manager, LockManager *lock_manager) {
-    return new TableHeap(buffer_pool_manager, first_page_id, schema, log_manager, lock_manager);
+                           LogManager *log_manager, LockManager *lock_manager,
+                           page_id_t free_space_map_page_id = INVALID_PAGE_ID) {
+    return new TableHeap(buffer_pool_manager, first_page_id, schema, log_manager, lock_manager,
+                         free_space_map_page_id);
   }
 
-  ~TableHeap() {}
+  ~TableHeap() { DeleteUnlinkedPages(); }
 
   /**
    * Insert a tuple into the table. If the tuple is too large (>= page_size), return false.
@@ -32,6 +44,16 @@ class TableHeap {
    */
   bool InsertTuple(Row &row, Txn *txn);
 
+  /**
+   * Insert tuples into the table in order. A page is latched once and filled with as many of the tuples as fit,
+   * instead of being looked up again for every tuple.
+   * @param[in/out] rows Tuples to insert, the rids of the inserted tuples are wrapped in the rows
+   * @param[in] txn The recovery performing the insert
+   * @return the number of inserted tuples, they are a prefix of rows. Less than rows.size() if a tuple is too large or
+   * the buffer pool is full.
+   */
+  size_t InsertTuples(std::vector<Row> &rows, Txn *txn);
+
   /**
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
    * @param[in] rid Resource id of the tuple of delete
@@ -71,16 +93,56 @@ class TableHeap {
    */
   bool GetTuple(Row *row, Txn *txn);
 
+  /**
+   * Read a tuple in place, without deserializing it into a Row.
+   * @param[in] rid Rid of the tuple
+   * @param[in/out] view View which is reset to the tuple. It points into the latched page, so it is only valid
+   * during visit.
+   * @param[in] visit called with the view while the page is latched
+   * @return true if the tuple exists
+   */
+  template <typename Visitor>
+  bool VisitTuple(const RowId &rid, RowView *view, [[maybe_unused]] Txn *txn, Visitor &&visit) {
+    ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(rid.GetPageId());
+    if (!guard.IsValid()) {
+      LOG(ERROR) << "The buffer pool is full and no space to replace" << std::endl;
+      return false;
+    }
+    const char *data = guard.As<TablePage>()->GetTupleData(rid);
+    if (data == nullptr) {
+      return false;
+    }
+    view->Reset(data, rid);
+    visit(*view);
+    return true;
+  }
+
+  /**
+   * Reclaim the space of the table: apply the delete of every tuple marked deleted, compact every page and move the
+   * tuples of sparse pages, or of pages which fit as a whole, into the page before them. Emptied pages are deleted, so
+   * a scan afterwards reads about as many pages as the live tuples need. An emptied page which is still pinned is
+   * unlinked at once and deleted by the next vacuum, or when the heap is freed or destroyed. Must not run
+   * concurrently with other operations on the table.
+   * @param[in] txn Txn performing the vacuum
+   * @param[out] moved_rows if not null, the old rid and the row with its new rid of every moved tuple
+   * @return false if a page could not be fetched for write, e.g. the file is mapped read-only. The pages before it are
+   * vacuumed and their moved tuples are reported, the pages from it on are left as they are and are not offered for
+   * inserts by the free space map until the next vacuum.
+   */
+  bool Vacuum(Txn *txn, std::vector<std::pair<RowId, Row>> *moved_rows = nullptr);
+
   void FreeTableHeap() {
     auto next_page_id = first_page_id_;
     while (next_page_id != INVALID_PAGE_ID) {
       auto old_page_id = next_page_id;
-      auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(old_page_id));
-      assert(page != nullptr);
-      next_page_id = page->GetNextPageId();
-      buffer_pool_manager_->UnpinPage(old_page_id, false);
+      ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(old_page_id);
+      assert(guard.IsValid());
+      next_page_id = guard.As<TablePage>()->GetNextPageId();
+      guard.Drop();
       buffer_pool_manager_->DeletePage(old_page_id);
     }
+    DeleteUnlinkedPages();
+    free_space_map_.Destroy();
   }
 
   /**
@@ -103,14 +165,20 @@ class TableHeap {
    */
   inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
+  /**
+   * @return the first page of the free space map, INVALID_PAGE_ID as long as the heap has no page
+   */
+  inline page_id_t GetFreeSpaceMapPageId() { return free_space_map_.GetFirstPageId(); }
+
  private:
   /**
    * create table heap and initialize first page
    */
-  explicit TableHeap(BufferPoolManager *buffer_pool_manager, Schema *schema, Txn *txn, LogManager *log_manager,
-                     LockManager *lock_manager)
+  explicit TableHeap(BufferPoolManager *buffer_pool_manager, Schema *schema, [[maybe_unused]] Txn *txn,
+                     LogManager *log_manager, LockManager *lock_manager)
       : buffer_pool_manager_(buffer_pool_manager),
         first_page_id_(INVALID_PAGE_ID),
+        free_space_map_(buffer_pool_manager, INVALID_PAGE_ID),
         schema_(schema),
         log_manager_(log_manager),
         lock_manager_(lock_manager) {
@@ -118,16 +186,33 @@ class TableHeap {
   };
 
   explicit TableHeap(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, Schema *schema,
-                     LogManager *log_manager, LockManager *lock_manager)
-      : buffer_pool_manager_(buffer_pool_manager),
-        first_page_id_(first_page_id),
-        schema_(schema),
-        log_manager_(log_manager),
-        lock_manager_(lock_manager) {}
+                     LogManager *log_manager, LockManager *lock_manager, page_id_t free_space_map_page_id);
+
+  /**
+   * Link a new page behind the last one and insert the tuple there.
+   */
+  bool AppendTuple(Row &row, Txn *txn);
+
+  /**
+   * Retry the delete of the pages a vacuum unlinked while they were pinned, those still pinned are kept for later.
+   */
+  void DeleteUnlinkedPages();
+
+  /**
+   * @return a read ahead for a scan of this heap, it requests the pages of the chain as the free space map lists them
+   */
+  ReadAhead MakeReadAhead() {
+    return ReadAhead([this](page_id_t page_id, size_t count, std::vector<page_id_t> *page_ids) {
+      free_space_map_.GetPagesAfter(page_id, count, page_ids);
+    });
+  }
 
  private:
   BufferPoolManager *buffer_pool_manager_;
   page_id_t first_page_id_;
+  FreeSpaceMap free_space_map_;
+  std::mutex append_latch_;  // only one insert links a new page at a time
+  std::vector<page_id_t> unlinked_pages_;  // unlinked by a vacuum but still pinned, not deleted yet
   Schema *schema_;
   [[maybe_unused]] LogManager *log_manager_;
   [[maybe_unused]] LockManager *lock_manager_;
@@ -1,6 +1,7 @@
 #ifndef MINISQL_TABLE_ITERATOR_H
 #define MINISQL_TABLE_ITERATOR_H
 
+#include "buffer/read_ahead.h"
 #include "common/rowid.h"
 #include "concurrency/txn.h"
 #include "record/row.h"
@@ -35,6 +36,7 @@ private:
   Row *ite_row;
   TableHeap *ite_tableheap;
   Txn *ite_txn;
+  ReadAhead ite_read_ahead;
 };
 
 #endif  // MINISQL_TABLE_ITERATOR_H
@@ -0,0 +1,65 @@
+#ifndef MINISQL_TABLE_SCANNER_H
+#define MINISQL_TABLE_SCANNER_H
+
+#include "buffer/read_ahead.h"
+#include "record/row_view.h"
+#include "storage/table_heap.h"
+
+/**
+ * TableScanner walks the tuples of a table heap like TableIterator, but hands out RowViews on the page bytes instead
+ * of deserialized Rows. Tuples the caller skips, e.g. because a predicate rejects them, are never copied.
+ *
+ * The page is only latched within Next(), so the caller may modify the table between two calls, e.g. delete the
+ * tuple it was handed last.
+ */
+class TableScanner {
+ public:
+  TableScanner(TableHeap *table_heap, Txn *txn)
+      : table_heap_(table_heap),
+        txn_(txn),
+        view_(table_heap->schema_),
+        page_id_(table_heap->first_page_id_),
+        read_ahead_(table_heap->MakeReadAhead()) {}
+
+  /**
+   * Move on to the next tuple which visit accepts.
+   * @param visit called with a view of every following tuple until it returns true. The view points into the latched
+   * page, so it is only valid during the call.
+   * @return false at the end of the table
+   */
+  template <typename Visitor>
+  bool Next(Visitor &&visit) {
+    BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
+    while (page_id_ != INVALID_PAGE_ID) {
+      ReadPageGuard guard = buffer_pool_manager->FetchPageRead(page_id_);
+      ASSERT(guard.IsValid(), "Fetch page failed.");
+      auto page = guard.As<TablePage>();
+      if (rid_.GetPageId() != page_id_) {
+        read_ahead_.OnNewPage(buffer_pool_manager, page_id_, page->GetNextPageId());
+      }
+      RowId next_rid;
+      bool has_tuple = rid_.GetPageId() == page_id_ ? page->GetNextTupleRid(rid_, &next_rid)
+                                                    : page->GetFirstTupleRid(&next_rid);
+      while (has_tuple) {
+        rid_ = next_rid;
+        view_.Reset(page->GetTupleData(rid_), rid_);
+        if (visit(static_cast<const RowView &>(view_))) {
+          return true;
+        }
+        has_tuple = page->GetNextTupleRid(rid_, &next_rid);
+      }
+      page_id_ = page->GetNextPageId();
+    }
+    return false;
+  }
+
+ private:
+  TableHeap *table_heap_;
+  [[maybe_unused]] Txn *txn_;
+  RowView view_;
+  page_id_t page_id_;  // page the scan is on
+  RowId rid_{};        // tuple handed out last, its page id differs from page_id_ before the first tuple of a page
+  ReadAhead read_ahead_;
+};
+
+#endif  // MINISQL_TABLE_SCANNER_H
@@ -0,0 +1,54 @@
+#ifndef MINISQL_THREAD_POOL_IO_H
+#define MINISQL_THREAD_POOL_IO_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "common/macros.h"
+#include "storage/async_io.h"
+
+/**
+ * ThreadPoolIO is the fallback when io_uring is not available. A fixed set of I/O threads serve the requests with
+ * blocking pread/pwrite, so up to num_threads requests are in flight at once.
+ */
+class ThreadPoolIO : public AsyncIO {
+ public:
+  /**
+   * @param fd the file all requests go to
+   * @param num_threads number of I/O threads, i.e. the queue depth
+   */
+  ThreadPoolIO(int fd, size_t num_threads);
+
+  ~ThreadPoolIO() override;
+
+  DISALLOW_COPY_AND_MOVE(ThreadPoolIO);
+
+  void SubmitAndWait(std::vector<IORequest> &requests) override;
+
+ private:
+  /** Requests of one SubmitAndWait call which have not completed yet. */
+  struct Batch {
+    size_t num_pending;
+    std::condition_variable done_cv;
+  };
+
+  struct Task {
+    IORequest *request;
+    Batch *batch;
+  };
+
+  void WorkerLoop();
+
+ private:
+  int fd_;
+  std::vector<std::thread> workers_;
+  std::mutex latch_;                // protects tasks_, stop_ and Batch::num_pending
+  std::condition_variable task_cv_;  // signals new tasks or stop
+  std::deque<Task> tasks_;
+  bool stop_{false};
+};
+
+#endif  // MINISQL_THREAD_POOL_IO_H
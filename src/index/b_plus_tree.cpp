@@ -1,5 +1,7 @@
 #include "index/b_plus_tree.h"
 
+#include <algorithm>
+#include <mutex>
 #include <string>
 
 #include "glog/logging.h"
@@ -7,8 +9,8 @@
 #include "index/generic_key.h"
 #include "page/index_roots_page.h"
 
-#define DEFAULT_LEAF_MAX_SIZE ((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / (KM.GetKeySize()+ sizeof(RowId)))
-#define DEFAULT_INTERNAL_MAX_SIZE ((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (KM.GetKeySize() + sizeof(page_id_t)))
+#define DEFAULT_LEAF_MAX_SIZE ((PAGE_USABLE_SIZE - LEAF_PAGE_HEADER_SIZE) / (KM.GetKeySize()+ sizeof(RowId)))
+#define DEFAULT_INTERNAL_MAX_SIZE ((PAGE_USABLE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (KM.GetKeySize() + sizeof(page_id_t)))
 
 /**
  * TODO: Student Implement
@@ -21,15 +23,17 @@ BPlusTree::BPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager
       leaf_max_size_(leaf_max_size),
       internal_max_size_(internal_max_size) {
   // Find root_page_id from header page
-  auto header_page = reinterpret_cast<IndexRootsPage *>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID)->GetData());
-  if (header_page == nullptr) {
+  ReadPageGuard header_guard = buffer_pool_manager_->FetchPageRead(INDEX_ROOTS_PAGE_ID);
+  if (!header_guard.IsValid()) {
     throw "out of memory";
   }
-  if (!header_page->GetRootId(index_id_, &root_page_id_)) {
+  page_id_t root_page_id;
+  if (!header_guard.As<IndexRootsPage>()->GetRootId(index_id_, &root_page_id)) {
     // LOG(INFO) << "Cannot find root page id for index " << index_id_;
-    root_page_id_ = INVALID_PAGE_ID;
+    root_page_id = INVALID_PAGE_ID;
   }
-  buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, false);
+  root_page_id_ = root_page_id;
+  header_guard.Drop();
 
   if (leaf_max_size_ == UNDEFINED_SIZE) {
     leaf_max_size_ = DEFAULT_LEAF_MAX_SIZE;
@@ -39,25 +43,39 @@ BPlusTree::BPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager
   }
 }
 
+BPlusTree::~BPlusTree() {
+  // no reader is left that could still hold the id of a page merged away
+  for (page_id_t page_id : free_pages_) {
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+}
+
 void BPlusTree::Destroy(page_id_t current_page_id) {
   if (current_page_id == INVALID_PAGE_ID) {
     current_page_id = root_page_id_;
   }
-  if (current_page_id == INVALID_PAGE_ID) {
+  if (current_page_id == INVALID_PAGE_ID || buffer_pool_manager_->IsReadOnly()) {
     return;
   }
   if (current_page_id == root_page_id_) {
-    auto header_page = reinterpret_cast<IndexRootsPage *>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID)->GetData());
-    header_page->Delete(index_id_);
+    WritePageGuard header_guard = buffer_pool_manager_->FetchPageWrite(INDEX_ROOTS_PAGE_ID);
+    header_guard.AsMut<IndexRootsPage>()->Delete(index_id_);
+    std::scoped_lock<std::mutex> lock(free_pages_latch_);
+    for (page_id_t page_id : free_pages_) {
+      buffer_pool_manager_->DeletePage(page_id);
+    }
+    free_pages_.clear();
   }
-  auto *page = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(current_page_id)->GetData());
-  if (!page->IsLeafPage()) {
-    auto *internal_page = reinterpret_cast<InternalPage *>(page);
-    for (int i = 0; i < internal_page->GetSize(); i++) {
-      Destroy(internal_page->ValueAt(i));
+  {
+    ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(current_page_id);
+    auto *page = guard.As<BPlusTreePage>();
+    if (!page->IsLeafPage()) {
+      auto *internal_page = reinterpret_cast<InternalPage *>(page);
+      for (int i = 0; i < internal_page->GetSize(); i++) {
+        Destroy(internal_page->ValueAt(i));
+      }
     }
   }
-  buffer_pool_manager_->UnpinPage(current_page_id, false);
   buffer_pool_manager_->DeletePage(current_page_id);
 }
 
@@ -73,19 +91,23 @@ bool BPlusTree::IsEmpty() const {
  *****************************************************************************/
 /*
  * Return the only value that associated with input key
- * This method is used for point query
+ * This method is used for point query. The lookup runs without page latches,
+ * see FindLeafPageUnlatched(), and only takes read latches if it keeps being
+ * invalidated by writers.
  * @return : true means key exists
  */
 bool BPlusTree::GetValue(const GenericKey *key, std::vector<RowId> &result, Txn *transaction) {
-  // LOG(INFO) << "GetValue";
-  auto leaf_page = reinterpret_cast<LeafPage *>(FindLeafPage(key, root_page_id_));
-  if (leaf_page == nullptr) {
-    return false;
-  }
   RowId value;
-  bool is_exist = leaf_page->Lookup(key, value, processor_);
+  bool is_exist = false;
+  auto lookup = [&](LeafPage *leaf_page) { is_exist = leaf_page->Lookup(key, value, processor_); };
+  if (!optimistic_reads_ || !ReadLeafPageUnlatched(key, lookup)) {
+    ReadPageGuard leaf_guard = FindLeafPageRead(key);
+    if (!leaf_guard.IsValid()) {
+      return false;
+    }
+    lookup(leaf_guard.As<LeafPage>());
+  }
   if (is_exist) result.push_back(value);
-  buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);
   return is_exist;
 }
 
@@ -94,67 +116,115 @@ bool BPlusTree::GetValue(const GenericKey *key, std::vector<RowId> &result, Txn
  *****************************************************************************/
 /*
  * Insert constant key & value pair into b+ tree
- * if current tree is empty, start new tree, update root page id and insert
+ * The leaf is first found with read latches only, which is enough as long as
+ * it does not split. Otherwise the descent is repeated with write latches: if
+ * current tree is empty, start new tree, update root page id and insert
  * entry, otherwise insert into leaf page.
  * @return: since we only support unique key, if user try to insert duplicate
  * keys return false, otherwise return true.
  */
 bool BPlusTree::Insert(GenericKey *key, const RowId &value, Txn *transaction) {
-  if (IsEmpty()) {
+  if (buffer_pool_manager_->IsReadOnly()) {
+    return false;
+  }
+  {
+    WritePageGuard leaf_guard = FindLeafPageOptimistic(key);
+    if (leaf_guard.IsValid()) {
+      auto *leaf_page = leaf_guard.As<LeafPage>();
+      RowId tmp;
+      if (leaf_page->Lookup(key, tmp, processor_)) {
+        return false;
+      }
+      if (IsSafe(leaf_page, Operation::kInsert)) {
+        leaf_guard.AsMut<LeafPage>()->Insert(key, value, processor_);
+        return true;
+      }
+    }
+  }
+  // the leaf splits or the tree is empty, restart with write latches
+  Context context;
+  if (!FindLeafPageWrite(key, Operation::kInsert, context)) {
     StartNewTree(key, value);
     return true;
   }
-  return InsertIntoLeaf(key, value, transaction);
+  return InsertIntoLeaf(key, value, context, transaction);
 }
 /*
  * Insert constant key & value pair into an empty tree
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
  * an "out of memory" exception if returned value is nullptr), then update b+
  * tree's root page id and insert entry directly into leaf page.
+ * The caller holds the root latch.
  */
 void BPlusTree::StartNewTree(GenericKey *key, const RowId &value) {
-  auto page = reinterpret_cast<LeafPage *>(buffer_pool_manager_->NewPage(root_page_id_)->GetData());
-  if (page == nullptr) {
-    throw "out of memory";
-  }
-  page->Init(root_page_id_, INVALID_PAGE_ID, processor_.GetKeySize(), leaf_max_size_);
+  page_id_t root_page_id;
+  WritePageGuard root_guard = NewTreePage(root_page_id);
+  auto page = root_guard.AsMut<LeafPage>();
+  page->Init(root_page_id, INVALID_PAGE_ID, processor_.GetKeySize(), leaf_max_size_);
   page->Insert(key, value, processor_);
+  // published while the new root is write latched, see FindLeafPageUnlatched()
+  root_page_id_ = root_page_id;
   UpdateRootPageId(true);
-  buffer_pool_manager_->UnpinPage(root_page_id_, true);
 }
 
 /*
- * Insert constant key & value pair into leaf page
- * User needs to first find the right leaf page as insertion target, then look
- * through leaf page to see whether insert key exist or not. If exist, return
- * immediately, otherwise insert entry. Remember to deal with split if necessary.
+ * Insert constant key & value pair into the write latched leaf page of
+ * context. If the key exists, return immediately, otherwise insert entry.
+ * Remember to deal with split if necessary.
  * @return: since we only support unique key, if user try to insert duplicate
  * keys return false, otherwise return true.
  */
-bool BPlusTree::InsertIntoLeaf(GenericKey *key, const RowId &value, Txn *transaction) {
-  auto leaf_page = reinterpret_cast<LeafPage *>(FindLeafPage(key, root_page_id_, false));
+bool BPlusTree::InsertIntoLeaf(GenericKey *key, const RowId &value, Context &context, Txn *transaction) {
+  size_t level = context.write_set_.size() - 1;
+  auto *leaf_page = context.write_set_[level].AsMut<LeafPage>();
   RowId tmp;
   if (leaf_page->Lookup(key, tmp, processor_)) {
-    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);
     return false;
   }
   if (leaf_page->GetSize() < leaf_page->GetMaxSize()) {
     leaf_page->Insert(key, value, processor_);
-    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), true);
     return true;
+  }
+  WritePageGuard new_guard;
+  auto new_page = Split(leaf_page, new_guard, transaction);
+  GenericKey *middle_key = new_page->KeyAt(0);
+  if (processor_.CompareKeys(key, middle_key) < 0) {
+    leaf_page->Insert(key, value, processor_);
   } else {
-    auto new_page = Split(leaf_page, transaction);
-    GenericKey *middle_key = new_page->KeyAt(0);
-    if (processor_.CompareKeys(key, middle_key) < 0) {
-      leaf_page->Insert(key, value, processor_);
-    } else {
-      new_page->Insert(key, value, processor_);
-    }
-    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), true);
-    buffer_pool_manager_->UnpinPage(new_page->GetPageId(), true);
-    InsertIntoParent(leaf_page, middle_key, new_page, transaction);
-    return true;
+    new_page->Insert(key, value, processor_);
   }
+  InsertIntoParent(leaf_page, middle_key, new_page, context, level, transaction);
+  return true;
+}
+
+/*
+ * Allocate the page of a new node, write latched. A page merged away before
+ * is reused if there is one, it is zeroed under its write latch so that
+ * unlatched readers which still hold its id fail validation.
+ * NOTICE: throw an "out of memory" exception if no page can be allocated
+ */
+WritePageGuard BPlusTree::NewTreePage(page_id_t &page_id) {
+  page_id = INVALID_PAGE_ID;
+  {
+    std::scoped_lock<std::mutex> lock(free_pages_latch_);
+    if (!free_pages_.empty()) {
+      page_id = free_pages_.back();
+      free_pages_.pop_back();
+    }
+  }
+  WritePageGuard guard;
+  if (page_id != INVALID_PAGE_ID) {
+    guard = buffer_pool_manager_->FetchPageWrite(page_id);
+    if (guard.IsValid()) {
+      memset(guard.GetDataMut(), 0, PAGE_SIZE);
+    }
+  } else {
+    guard = buffer_pool_manager_->NewPageWrite(page_id);
+  }
+  if (!guard.IsValid()) {
+    throw "out of memory";
+  }
+  return guard;
 }
 
 /*
@@ -163,24 +233,23 @@ bool BPlusTree::InsertIntoLeaf(GenericKey *key, const RowId &value, Txn *transac
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
  * an "out of memory" exception if returned value is nullptr), then move half
  * of key & value pairs from input page to newly created page
+ * @param   new_guard     keeps the new page write latched until its parent
+ * knows it
  */
-BPlusTreeInternalPage *BPlusTree::Split(InternalPage *node, Txn *transaction) {
+BPlusTreeInternalPage *BPlusTree::Split(InternalPage *node, WritePageGuard &new_guard, Context &context,
+                                        Txn *transaction) {
   page_id_t new_page_id;
-  auto *new_page = reinterpret_cast<InternalPage *>(buffer_pool_manager_->NewPage(new_page_id)->GetData());
-  if (new_page == nullptr) {
-    throw "out of memory";
-  }
+  new_guard = NewTreePage(new_page_id);
+  auto *new_page = new_guard.AsMut<InternalPage>();
   new_page->Init(new_page_id, node->GetParentPageId(), processor_.GetKeySize(), internal_max_size_);
-  node->MoveHalfTo(new_page, buffer_pool_manager_);
+  node->MoveHalfTo(new_page, buffer_pool_manager_, context.GetLatchedPages());
   return new_page;
 }
 
-BPlusTreeLeafPage *BPlusTree::Split(LeafPage *node, Txn *transaction) {
+BPlusTreeLeafPage *BPlusTree::Split(LeafPage *node, WritePageGuard &new_guard, Txn *transaction) {
   page_id_t new_page_id;
-  auto *new_page = reinterpret_cast<LeafPage *>(buffer_pool_manager_->NewPage(new_page_id)->GetData());
-  if (new_page == nullptr) {
-    throw "out of memory";
-  }
+  new_guard = NewTreePage(new_page_id);
+  auto *new_page = new_guard.AsMut<LeafPage>();
   new_page->Init(new_page_id, node->GetParentPageId(), processor_.GetKeySize(), leaf_max_size_);
   node->MoveHalfTo(new_page);
   new_page->SetNextPageId(node->GetNextPageId());
@@ -193,45 +262,45 @@ BPlusTreeLeafPage *BPlusTree::Split(LeafPage *node, Txn *transaction) {
  * @param   old_node      input page from split() method
  * @param   key
  * @param   new_node      returned page from split() method
- * User needs to first find the parent page of old_node, parent node must be
- * adjusted to take info of new_node into account. Remember to deal with split
- * recursively if necessary.
+ * @param   level         position of old_node in the latched path of context
+ * The parent page of old_node must be adjusted to take info of new_node into
+ * account. Remember to deal with split recursively if necessary.
  */
-void BPlusTree::InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlusTreePage *new_node, Txn *transaction) {
+void BPlusTree::InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlusTreePage *new_node, Context &context,
+                                 size_t level, Txn *transaction) {
   if (old_node->IsRootPage()) {
-    auto *new_root = reinterpret_cast<InternalPage *>(buffer_pool_manager_->NewPage(root_page_id_)->GetData());
-    if (new_root == nullptr) {
-      throw "out of memory";
-    }
-    new_root->Init(root_page_id_, INVALID_PAGE_ID, processor_.GetKeySize(), internal_max_size_);
+    // the root was not safe, so the root latch is still held
+    page_id_t new_root_id;
+    WritePageGuard root_guard = NewTreePage(new_root_id);
+    auto *new_root = root_guard.AsMut<InternalPage>();
+    new_root->Init(new_root_id, INVALID_PAGE_ID, processor_.GetKeySize(), internal_max_size_);
     new_root->PopulateNewRoot(old_node->GetPageId(), key, new_node->GetPageId());
-    old_node->SetParentPageId(root_page_id_);
-    new_node->SetParentPageId(root_page_id_);
+    old_node->SetParentPageId(new_root_id);
+    new_node->SetParentPageId(new_root_id);
+    root_page_id_ = new_root_id;
     UpdateRootPageId();
-    buffer_pool_manager_->UnpinPage(root_page_id_, true);
+    return;
+  }
+  // old_node was full, so its parent is the page above it in the latched path
+  ASSERT(level > 0, "parent page is not latched");
+  auto *parent_page = context.write_set_[level - 1].AsMut<InternalPage>();
+  page_id_t parent_page_id = parent_page->GetPageId();
+  if (parent_page->GetSize() < internal_max_size_) {
+    parent_page->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
+    new_node->SetParentPageId(parent_page_id);
+    return;
+  }
+  WritePageGuard new_guard;
+  auto *new_page = Split(parent_page, new_guard, context, transaction);
+  GenericKey *middle_key = new_page->KeyAt(0);
+  if (processor_.CompareKeys(key, middle_key) < 0) {
+    parent_page->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
+    new_node->SetParentPageId(parent_page_id);
   } else {
-    page_id_t parent_page_id = old_node->GetParentPageId();
-    auto *parent_page = reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(parent_page_id)->GetData());
-    ASSERT(parent_page != nullptr, "parent page is nullptr");
-    if (parent_page->GetSize() < internal_max_size_) {
-      parent_page->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
-      new_node->SetParentPageId(parent_page_id);
-      buffer_pool_manager_->UnpinPage(parent_page_id, true);
-    } else {
-      auto *new_page = Split(parent_page, transaction);
-      GenericKey *middle_key = new_page->KeyAt(0);
-      if (processor_.CompareKeys(key, middle_key) < 0) {
-        parent_page->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
-        new_node->SetParentPageId(parent_page_id);
-      } else {
-        new_page->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
-        new_node->SetParentPageId(new_page->GetPageId());
-      }
-      buffer_pool_manager_->UnpinPage(parent_page_id, true);
-      buffer_pool_manager_->UnpinPage(new_page->GetPageId(), true);
-      InsertIntoParent(parent_page, middle_key, new_page, transaction);
-    }
+    new_page->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
+    new_node->SetParentPageId(new_page->GetPageId());
   }
+  InsertIntoParent(parent_page, middle_key, new_page, context, level - 1, transaction);
 }
 
 /*****************************************************************************
@@ -240,110 +309,126 @@ void BPlusTree::InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlus
 /*
  * Delete key & value pair associated with input key
  * If current tree is empty, return immediately.
- * If not, User needs to first find the right leaf page as deletion target, then
- * delete entry from leaf page. Remember to deal with redistribute or merge if
- * necessary.
+ * The leaf is first found with read latches only, which is enough as long as
+ * it does not underflow. Otherwise the descent is repeated with write latches
+ * and the leaf is redistributed or merged. Pages which are merged away are
+ * kept for later splits, see NewTreePage().
  */
-void BPlusTree::Remove(const GenericKey *key, Txn *transaction) {
-  if (IsEmpty()) {
-    return;
+bool BPlusTree::Remove(const GenericKey *key, Txn *transaction) {
+  if (buffer_pool_manager_->IsReadOnly()) {
+    return false;
   }
-  auto leaf_page = reinterpret_cast<LeafPage *>(FindLeafPage(key, root_page_id_));
-  ASSERT(leaf_page != nullptr, "leaf page is nullptr");
-  leaf_page->RemoveAndDeleteRecord(key, processor_);
-  if (leaf_page->GetSize() < leaf_page->GetMinSize()) {
-    // Coalesce or redistribute
-    bool need_delete = CoalesceOrRedistribute(leaf_page, transaction);
-    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), true);
-    if (need_delete) {
-      buffer_pool_manager_->DeletePage(leaf_page->GetPageId());
+  {
+    WritePageGuard leaf_guard = FindLeafPageOptimistic(key);
+    if (!leaf_guard.IsValid()) {
+      return true;
     }
-  } else {
-    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), true);
+    auto *leaf_page = leaf_guard.As<LeafPage>();
+    RowId tmp;
+    if (!leaf_page->Lookup(key, tmp, processor_)) {
+      return true;
+    }
+    if (IsSafe(leaf_page, Operation::kRemove)) {
+      leaf_guard.AsMut<LeafPage>()->RemoveAndDeleteRecord(key, processor_);
+      return true;
+    }
+  }
+  // the leaf underflows, restart with write latches
+  Context context;
+  if (!FindLeafPageWrite(key, Operation::kRemove, context)) {
+    return true;
   }
+  size_t level = context.write_set_.size() - 1;
+  auto *leaf_page = context.write_set_[level].AsMut<LeafPage>();
+  RowId tmp;
+  if (leaf_page->Lookup(key, tmp, processor_)) {
+    leaf_page->RemoveAndDeleteRecord(key, processor_);
+    if (leaf_page->GetSize() < leaf_page->GetMinSize()) {
+      CoalesceOrRedistribute(leaf_page, context, level, transaction);
+    }
+  }
+  context.write_set_.clear();
+  context.sibling_set_.clear();
+  if (!context.deleted_pages_.empty()) {
+    std::scoped_lock<std::mutex> lock(free_pages_latch_);
+    free_pages_.insert(free_pages_.end(), context.deleted_pages_.begin(), context.deleted_pages_.end());
+  }
+  return true;
 }
 
-/* todo
+/*
  * User needs to first find the sibling of input page. If sibling's size + input
  * page's size > page's max size, then redistribute. Otherwise, merge.
  * Using template N to represent either internal page or leaf page.
- * @return: true means target leaf page should be deleted, false means no
- * deletion happens
+ * @param   level         position of node in the latched path of context
+ * Pages which should be deleted are added to the context.
  */
 template <typename N>
-bool BPlusTree::CoalesceOrRedistribute(N *&node, Txn *transaction) {
+void BPlusTree::CoalesceOrRedistribute(N *node, Context &context, size_t level, Txn *transaction) {
   if (node->IsRootPage()) {
-    return AdjustRoot(node);
+    if (AdjustRoot(node)) {
+      context.deleted_pages_.push_back(node->GetPageId());
+    }
+    return;
   }
-  auto parent_page = reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(node->GetParentPageId())->GetData());
-  ASSERT(parent_page != nullptr, "parent page is nullptr");
+  // node underflows, so its parent is the page above it in the latched path
+  ASSERT(level > 0, "parent page is not latched");
+  auto *parent_page = context.write_set_[level - 1].AsMut<InternalPage>();
   int index = parent_page->ValueIndex(node->GetPageId());
-  N *neighbor_node = nullptr;
-  if (index == 0) {
-    neighbor_node = reinterpret_cast<N *>(buffer_pool_manager_->FetchPage(parent_page->ValueAt(1))->GetData());
-  } else {
-    neighbor_node = reinterpret_cast<N *>(buffer_pool_manager_->FetchPage(parent_page->ValueAt(index - 1))->GetData());
-  }
-  ASSERT(neighbor_node != nullptr, "neighbor page is nullptr");
+  // no one else can reach the neighbor through the parent, but threads which got there before may still be inside
+  context.sibling_set_.push_back(
+      buffer_pool_manager_->FetchPageWrite(parent_page->ValueAt(index == 0 ? 1 : index - 1)));
+  ASSERT(context.sibling_set_.back().IsValid(), "neighbor page is nullptr");
+  auto *neighbor_node = context.sibling_set_.back().AsMut<N>();
   if (neighbor_node->GetSize() + node->GetSize() > node->GetMaxSize()) {
-    Redistribute(neighbor_node, node, index);
-    return false;
+    Redistribute(neighbor_node, node, parent_page, index, context);
   } else {
-    bool need_delete_parent = Coalesce(neighbor_node, node, parent_page, index);
-    if (need_delete_parent) {
-      buffer_pool_manager_->DeletePage(parent_page->GetPageId());
-    }
-    if (index == 0) {
-      node = neighbor_node;
-    }
-    return true;
+    Coalesce(neighbor_node, node, parent_page, index, context, level, transaction);
   }
 }
 
 /*
- * Move all the key & value pairs from one page to its sibling page, and notify
- * buffer pool manager to delete this page. Parent page must be adjusted to
+ * Move all the key & value pairs from one page to its sibling page, and add
+ * the emptied page to the pages to delete. Parent page must be adjusted to
  * take info of deletion into account. Remember to deal with coalesce or
  * redistribute recursively if necessary.
  * Using template N to represent either internal page or leaf page.
  * @param   neighbor_node      sibling page of input "node"
  * @param   node               input from method coalesceOrRedistribute()
  * @param   parent             parent page of input "node"
- * @return  true means parent node should be deleted, false means no deletion happened
+ * @param   level              position of node in the latched path of context
  */
-bool BPlusTree::Coalesce(LeafPage *&neighbor_node, LeafPage *&node, InternalPage *&parent, int index,
-                         Txn *transaction) {
+void BPlusTree::Coalesce(LeafPage *neighbor_node, LeafPage *node, InternalPage *parent, int index, Context &context,
+                         size_t level, Txn *transaction) {
   if (index == 0) {
     neighbor_node->MoveAllTo(node);
     node->SetNextPageId(neighbor_node->GetNextPageId());
+    context.deleted_pages_.push_back(neighbor_node->GetPageId());
   } else {
     node->MoveAllTo(neighbor_node);
     neighbor_node->SetNextPageId(node->GetNextPageId());
+    context.deleted_pages_.push_back(node->GetPageId());
   }
-  buffer_pool_manager_->UnpinPage(node->GetPageId(), false);
-  buffer_pool_manager_->UnpinPage(neighbor_node->GetPageId(), true);
   parent->Remove(index == 0 ? 1 : index);
   if (parent->GetSize() < parent->GetMinSize()) {
-    return CoalesceOrRedistribute(parent, transaction);
+    CoalesceOrRedistribute(parent, context, level - 1, transaction);
   }
-  return false;
 }
 
-bool BPlusTree::Coalesce(InternalPage *&neighbor_node, InternalPage *&node, InternalPage *&parent, int index,
-                         Txn *transaction) {
+void BPlusTree::Coalesce(InternalPage *neighbor_node, InternalPage *node, InternalPage *parent, int index,
+                         Context &context, size_t level, Txn *transaction) {
   GenericKey *middle_key = parent->KeyAt(index == 0 ? 1 : index);
   if (index == 0) {
-    neighbor_node->MoveAllTo(node, middle_key, buffer_pool_manager_);
+    neighbor_node->MoveAllTo(node, middle_key, buffer_pool_manager_, context.GetLatchedPages());
+    context.deleted_pages_.push_back(neighbor_node->GetPageId());
   } else {
-    node->MoveAllTo(neighbor_node, middle_key, buffer_pool_manager_);
+    node->MoveAllTo(neighbor_node, middle_key, buffer_pool_manager_, context.GetLatchedPages());
+    context.deleted_pages_.push_back(node->GetPageId());
   }
-  buffer_pool_manager_->UnpinPage(node->GetPageId(), false);
-  buffer_pool_manager_->UnpinPage(neighbor_node->GetPageId(), true);
   parent->Remove(index == 0 ? 1 : index);
   if (parent->GetSize() < parent->GetMinSize()) {
-    return CoalesceOrRedistribute(parent, transaction);
+    CoalesceOrRedistribute(parent, context, level - 1, transaction);
   }
-  return false;
 }
 
 /*
@@ -354,36 +439,30 @@ bool BPlusTree::Coalesce(InternalPage *&neighbor_node, InternalPage *&node, Inte
  * Using template N to represent either internal page or leaf page.
  * @param   neighbor_node      sibling page of input "node"
  * @param   node               input from method coalesceOrRedistribute()
+ * @param   parent             parent page of input "node"
+ * @param   context            a moved child latched by it is not latched again
  */
-void BPlusTree::Redistribute(LeafPage *neighbor_node, LeafPage *node, int index) {
-  auto parent_page = reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(node->GetParentPageId())->GetData());
-  ASSERT(parent_page != nullptr, "parent page is nullptr");
+void BPlusTree::Redistribute(LeafPage *neighbor_node, LeafPage *node, InternalPage *parent, int index,
+                             [[maybe_unused]] Context &context) {
   if (index == 0) {
     neighbor_node->MoveFirstToEndOf(node);
-    parent_page->SetKeyAt(1, neighbor_node->KeyAt(0));
+    parent->SetKeyAt(1, neighbor_node->KeyAt(0));
   } else {
     neighbor_node->MoveLastToFrontOf(node);
-    parent_page->SetKeyAt(index, node->KeyAt(0));
+    parent->SetKeyAt(index, node->KeyAt(0));
   }
-  buffer_pool_manager_->UnpinPage(node->GetPageId(), true);
-  buffer_pool_manager_->UnpinPage(neighbor_node->GetPageId(), true);
-  buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
 }
 
-void BPlusTree::Redistribute(InternalPage *neighbor_node, InternalPage *node, int index) {
-  auto parent_page = reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(node->GetParentPageId())->GetData());
-  ASSERT(parent_page != nullptr, "parent page is nullptr");
-  GenericKey *middle_key = parent_page->KeyAt(index == 0 ? 1 : index);
+void BPlusTree::Redistribute(InternalPage *neighbor_node, InternalPage *node, InternalPage *parent, int index,
+                             Context &context) {
+  GenericKey *middle_key = parent->KeyAt(index == 0 ? 1 : index);
   if (index == 0) {
-    neighbor_node->MoveFirstToEndOf(node, middle_key, buffer_pool_manager_);
-    parent_page->SetKeyAt(1, neighbor_node->KeyAt(0));
+    neighbor_node->MoveFirstToEndOf(node, middle_key, buffer_pool_manager_, context.GetLatchedPages());
+    parent->SetKeyAt(1, neighbor_node->KeyAt(0));
   } else {
-    neighbor_node->MoveLastToFrontOf(node, middle_key, buffer_pool_manager_);
-    parent_page->SetKeyAt(index, node->KeyAt(0));
+    neighbor_node->MoveLastToFrontOf(node, middle_key, buffer_pool_manager_, context.GetLatchedPages());
+    parent->SetKeyAt(index, node->KeyAt(0));
   }
-  buffer_pool_manager_->UnpinPage(node->GetPageId(), true);
-  buffer_pool_manager_->UnpinPage(neighbor_node->GetPageId(), true);
-  buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
 }
 /*
  * Update root page if necessary
@@ -392,6 +471,8 @@ void BPlusTree::Redistribute(InternalPage *neighbor_node, InternalPage *node, in
  * case 1: when you delete the last element in root page, but root page still
  * has one last child
  * case 2: when you delete the last element in whole b+ tree
+ * The caller holds the root latch, the only child in case 1 is write latched
+ * by the caller as well.
  * @return : true means root page should be deleted, false means no deletion
  * happened
  */
@@ -406,18 +487,146 @@ bool BPlusTree::AdjustRoot(BPlusTreePage *old_root_node) {
     // case 1
     auto old_root_page = reinterpret_cast<InternalPage *>(old_root_node);
     page_id_t only_child_page_id = old_root_page->RemoveAndReturnOnlyChild();
-    auto new_root = reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(only_child_page_id)->GetData());
+    auto new_root = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(only_child_page_id)->GetData());
     new_root->SetParentPageId(INVALID_PAGE_ID);
     root_page_id_ = new_root->GetPageId();
     buffer_pool_manager_->UnpinPage(new_root->GetPageId(), true);
-    buffer_pool_manager_->UnpinPage(old_root_page->GetPageId(), false);
-    buffer_pool_manager_->DeletePage(old_root_page->GetPageId());
     UpdateRootPageId();
     return true;
   }
   return false;
 }
 
+/*****************************************************************************
+ * BULK LOADING
+ *****************************************************************************/
+/*
+ * Build the empty tree bottom-up, e.g. for CREATE INDEX on a populated table.
+ * next() copies the entries in ascending key order without duplicates, e.g.
+ * from a KeySorter, and returns false once all are read. Leaves are written
+ * one after the other, and every node written is added to the level above,
+ * so each page is written once instead of being split over and over.
+ * Nodes are filled to fill_factor of their max size, which leaves room for
+ * later inserts. A node is only written once the entries of two are
+ * pending, so the last two nodes of a level can share what is left and no
+ * node but the root is less than half full.
+ * @return : false if the tree is not empty
+ */
+bool BPlusTree::BulkLoad(const std::function<bool(GenericKey *key, RowId *value)> &next, double fill_factor) {
+  std::unique_lock<std::shared_mutex> root_lock(root_latch_);
+  if (!IsEmpty() || buffer_pool_manager_->IsReadOnly()) {
+    return false;
+  }
+  auto fill_size = [fill_factor](int max_size) {
+    return std::clamp(static_cast<int>(max_size * fill_factor), std::max(max_size / 2, 2), max_size);
+  };
+  int leaf_fill = fill_size(leaf_max_size_);
+  int internal_fill = fill_size(internal_max_size_);
+  size_t key_size = processor_.GetKeySize();
+  std::vector<char> keys(2 * leaf_fill * key_size);
+  std::vector<RowId> values(2 * leaf_fill);
+  auto key_at = [&](int index) { return reinterpret_cast<GenericKey *>(&keys[index * key_size]); };
+  std::vector<BulkLevel> levels;
+  WritePageGuard prev_leaf;  // keeps the last leaf latched until the next one is linked to it
+  int leaf_count = 0;
+  page_id_t root_id = INVALID_PAGE_ID;
+  auto write_leaf = [&](int begin, int size) {
+    page_id_t page_id;
+    WritePageGuard leaf_guard = NewTreePage(page_id);
+    auto *leaf_page = leaf_guard.AsMut<LeafPage>();
+    leaf_page->Init(page_id, INVALID_PAGE_ID, key_size, leaf_max_size_);
+    leaf_page->SetSize(size);
+    for (int i = 0; i < size; i++) {
+      leaf_page->SetKeyAt(i, key_at(begin + i));
+      leaf_page->SetValueAt(i, values[begin + i]);
+    }
+    if (prev_leaf.IsValid()) {
+      prev_leaf.AsMut<LeafPage>()->SetNextPageId(page_id);
+    }
+    prev_leaf = std::move(leaf_guard);
+    root_id = page_id;
+    leaf_count++;
+    AddBulkChild(levels, 0, leaf_page->KeyAt(0), page_id, internal_fill);
+  };
+  int count = 0;
+  while (next(key_at(count), &values[count])) {
+    if (++count == 2 * leaf_fill) {
+      write_leaf(0, leaf_fill);
+      std::copy(keys.begin() + leaf_fill * key_size, keys.end(), keys.begin());
+      std::copy(values.begin() + leaf_fill, values.end(), values.begin());
+      count = leaf_fill;
+    }
+  }
+  if (count == 0) {
+    return true;
+  }
+  if (count > leaf_max_size_) {
+    write_leaf(0, count / 2);
+    write_leaf(count / 2, count - count / 2);
+  } else {
+    write_leaf(0, count);
+  }
+  prev_leaf.Drop();
+  // the level with a single node is the root
+  for (size_t level = 0, node_count = leaf_count; node_count > 1; node_count = levels[level++].written_) {
+    int rest = levels[level].children_.size();
+    if (rest > internal_max_size_) {
+      WriteBulkInternal(levels, level, rest / 2, internal_fill);
+      rest -= rest / 2;
+    }
+    root_id = WriteBulkInternal(levels, level, rest, internal_fill);
+  }
+  root_page_id_ = root_id;
+  UpdateRootPageId(true);
+  return true;
+}
+
+/*
+ * Add a node written by BulkLoad() to its level, and write a node of the
+ * level once the entries of two are pending.
+ */
+void BPlusTree::AddBulkChild(std::vector<BulkLevel> &levels, size_t level, const GenericKey *key, page_id_t child,
+                             int fill_size) {
+  if (levels.size() == level) {
+    levels.emplace_back();
+  }
+  auto &pending = levels[level];
+  auto key_data = reinterpret_cast<const char *>(key);
+  pending.keys_.insert(pending.keys_.end(), key_data, key_data + processor_.GetKeySize());
+  pending.children_.push_back(child);
+  if (pending.children_.size() == static_cast<size_t>(2 * fill_size)) {
+    WriteBulkInternal(levels, level, fill_size, fill_size);
+  }
+}
+
+/*
+ * Write the first count pending entries of an internal level to a new node,
+ * which adopts the children and is added to the level above.
+ * @return : page id of the new node
+ */
+page_id_t BPlusTree::WriteBulkInternal(std::vector<BulkLevel> &levels, size_t level, int count, int fill_size) {
+  size_t key_size = processor_.GetKeySize();
+  page_id_t page_id;
+  WritePageGuard guard = NewTreePage(page_id);
+  auto *node = guard.AsMut<InternalPage>();
+  node->Init(page_id, INVALID_PAGE_ID, key_size, internal_max_size_);
+  node->SetSize(count);
+  auto &pending = levels[level];
+  for (int i = 0; i < count; i++) {
+    // the first key is never searched, it is the one the level above needs
+    node->SetKeyAt(i, reinterpret_cast<GenericKey *>(&pending.keys_[i * key_size]));
+    node->SetValueAt(i, pending.children_[i]);
+    WritePageGuard child_guard = buffer_pool_manager_->FetchPageWrite(pending.children_[i]);
+    ASSERT(child_guard.IsValid(), "page is nullptr");
+    child_guard.AsMut<BPlusTreePage>()->SetParentPageId(page_id);
+  }
+  pending.keys_.erase(pending.keys_.begin(), pending.keys_.begin() + count * key_size);
+  pending.children_.erase(pending.children_.begin(), pending.children_.begin() + count);
+  pending.written_++;
+  AddBulkChild(levels, level + 1, node->KeyAt(0), page_id, fill_size);
+  return page_id;
+}
+
 /*****************************************************************************
  * INDEX ITERATOR
  *****************************************************************************/
@@ -427,7 +636,10 @@ bool BPlusTree::AdjustRoot(BPlusTreePage *old_root_node) {
  * @return : index iterator
  */
 IndexIterator BPlusTree::Begin() {
-  auto leaf_page = reinterpret_cast<LeafPage *>(FindLeafPage(nullptr, root_page_id_, true));
+  auto leaf_page = reinterpret_cast<LeafPage *>(FindLeafPage(nullptr, INVALID_PAGE_ID, true));
+  if (leaf_page == nullptr) {
+    return End();
+  }
   int page_id = leaf_page->GetPageId();
   buffer_pool_manager_->UnpinPage(page_id, false);
   return IndexIterator(page_id, buffer_pool_manager_, 0);
@@ -435,21 +647,27 @@ IndexIterator BPlusTree::Begin() {
 
 /*
  * Input parameter is low key, find the leaf page that contains the input key
- * first, then construct index iterator
+ * first, then construct index iterator. The seek runs without page latches
+ * like GetValue().
  * @return : index iterator
  */
 IndexIterator BPlusTree::Begin(const GenericKey *key) {
-  auto leaf_page = reinterpret_cast<LeafPage *>(FindLeafPage(key, root_page_id_));
-  int page_id = leaf_page->GetPageId();
-  RowId value;
-  if (leaf_page->Lookup(key, value, processor_)) {
-    int index = leaf_page->KeyIndex(key, processor_);
-    buffer_pool_manager_->UnpinPage(page_id, false);
-    return IndexIterator(page_id, buffer_pool_manager_, index);
-  } else {
-    buffer_pool_manager_->UnpinPage(page_id, false);
+  page_id_t page_id = INVALID_PAGE_ID;
+  int index = 0;
+  auto seek = [&](LeafPage *leaf_page) {
+    RowId value;
+    page_id = leaf_page->Lookup(key, value, processor_) ? leaf_page->GetPageId() : INVALID_PAGE_ID;
+    index = leaf_page->KeyIndex(key, processor_);
+  };
+  if (optimistic_reads_ && ReadLeafPageUnlatched(key, seek)) {
+    return page_id == INVALID_PAGE_ID ? End() : IndexIterator(page_id, buffer_pool_manager_, index);
+  }
+  ReadPageGuard leaf_guard = FindLeafPageRead(key);
+  if (!leaf_guard.IsValid()) {
     return End();
   }
+  seek(leaf_guard.As<LeafPage>());
+  return page_id == INVALID_PAGE_ID ? End() : IndexIterator(page_id, buffer_pool_manager_, index);
 }
 
 /*
@@ -466,25 +684,217 @@ IndexIterator BPlusTree::End() {
  *****************************************************************************/
 /*
  * Find leaf page containing particular key, if leftMost flag == true, find
- * the left most leaf page
+ * the left most leaf page. The descent starts at page_id, at the root if it
+ * is INVALID_PAGE_ID, and takes read latches like FindLeafPageRead(): the
+ * caller reads the leaf after it is returned, which could not be validated
+ * against the version of an unlatched descent.
  * Note: the leaf page is pinned, you need to unpin it after use.
  */
 Page *BPlusTree::FindLeafPage(const GenericKey *key, page_id_t page_id, bool leftMost) {
-  page_id_t current_page_id = page_id;
-  while (current_page_id != INVALID_PAGE_ID) {
-    auto *page = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(current_page_id)->GetData());
-    ASSERT(page != nullptr, "page is nullptr");
-    if (page->IsLeafPage()) {
-      return reinterpret_cast<Page *>(page);
-    } else {
-      auto *internal_page = reinterpret_cast<InternalPage *>(page);
-      current_page_id = leftMost ? internal_page->ValueAt(0) : internal_page->Lookup(key, processor_);
-      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  ReadPageGuard leaf_guard = FindLeafPageRead(key, page_id, leftMost);
+  if (!leaf_guard.IsValid()) {
+    return nullptr;
+  }
+  // the caller keeps a pin of its own once the latch is released
+  auto *page = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(leaf_guard.GetPageId())->GetData());
+  return reinterpret_cast<Page *>(page);
+}
+
+/*
+ * Find the read latched leaf page containing particular key with latch
+ * coupling: the latch of a child is taken before the one of its parent is
+ * released. The root latch is held until the root page is latched, unless the
+ * descent starts at page_id.
+ * @return : an invalid guard if the tree is empty
+ */
+ReadPageGuard BPlusTree::FindLeafPageRead(const GenericKey *key, page_id_t page_id, bool leftMost) {
+  ReadPageGuard guard;
+  if (page_id == INVALID_PAGE_ID) {
+    std::shared_lock<std::shared_mutex> root_lock(root_latch_);
+    if (IsEmpty()) {
+      return guard;
     }
+    guard = buffer_pool_manager_->FetchPageRead(root_page_id_);
+  } else {
+    guard = buffer_pool_manager_->FetchPageRead(page_id);
+  }
+  ASSERT(guard.IsValid(), "page is nullptr");
+  while (!guard.As<BPlusTreePage>()->IsLeafPage()) {
+    auto *internal_page = guard.As<InternalPage>();
+    guard = buffer_pool_manager_->FetchPageRead(leftMost ? internal_page->ValueAt(0)
+                                                         : internal_page->Lookup(key, processor_));
+    ASSERT(guard.IsValid(), "page is nullptr");
+  }
+  return guard;
+}
+
+/*
+ * Optimistic lock coupling: find the leaf page containing particular key
+ * without latching pages, so readers do not write to the page latches and
+ * versions shared with other readers. They still pin and unpin every page,
+ * which takes the latch of the buffer pool instance holding it and writes its
+ * pin count and replacer state, so readers of the same pages keep contending
+ * there. Every page is pinned and read at an even version, and what was read
+ * from it is only used once the version is validated. A child is only trusted
+ * if its parent did not change until the child's version was read, since it
+ * may have split or merged before. The root latch is not taken: the root
+ * page id is loaded, and checked again once the version of the root page is
+ * read. A new root is always installed while the old one is write latched,
+ * so the version of the old root no longer validates. Pages merged away are never deleted while the
+ * tree is open, so a stale page id still names a page of this tree.
+ * @return : the pinned leaf page and the version it has to be validated
+ * against, nullptr if the tree is empty or a page changed under the descent
+ */
+Page *BPlusTree::FindLeafPageUnlatched(const GenericKey *key, bool leftMost, uint64_t *version) {
+  page_id_t root_page_id = root_page_id_.load(std::memory_order_acquire);
+  if (root_page_id == INVALID_PAGE_ID) {
+    return nullptr;
+  }
+  Page *page = buffer_pool_manager_->FetchPage(root_page_id);
+  if (page == nullptr) {
+    return nullptr;
   }
+  uint64_t page_version = page->GetVersion();
+  if (root_page_id_.load(std::memory_order_acquire) != root_page_id) {
+    buffer_pool_manager_->UnpinPage(root_page_id, false);
+    return nullptr;
+  }
+  while (page_version % 2 == 0) {
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    if (node->IsLeafPage()) {
+      *version = page_version;
+      return page;
+    }
+    auto *internal_page = reinterpret_cast<InternalPage *>(node);
+    page_id_t child_page_id = leftMost ? internal_page->ValueAt(0) : internal_page->Lookup(key, processor_);
+    if (!page->ValidateVersion(page_version)) {
+      break;
+    }
+    Page *child = buffer_pool_manager_->FetchPage(child_page_id);
+    if (child == nullptr) {
+      break;
+    }
+    uint64_t child_version = child->GetVersion();
+    bool is_valid = page->ValidateVersion(page_version);
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = child;
+    page_version = child_version;
+    if (!is_valid) {
+      break;
+    }
+  }
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
   return nullptr;
 }
 
+/*
+ * Run read on the leaf page containing particular key without latches, see
+ * FindLeafPageUnlatched(). read may see the page while a writer changes it,
+ * what it finds must only be used if this returns true.
+ * @return : false if the tree is empty or writers kept invalidating the read
+ */
+template <typename F>
+bool BPlusTree::ReadLeafPageUnlatched(const GenericKey *key, F &&read) {
+  for (int i = 0; i < OPTIMISTIC_READ_RETRIES; i++) {
+    uint64_t version;
+    Page *leaf = FindLeafPageUnlatched(key, false, &version);
+    if (leaf == nullptr) {
+      if (IsEmpty()) {
+        return false;
+      }
+      continue;
+    }
+    read(reinterpret_cast<LeafPage *>(leaf->GetData()));
+    bool is_valid = leaf->ValidateVersion(version);
+    buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
+    if (is_valid) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/*
+ * Find the write latched leaf page containing particular key for an insert or
+ * a remove which expects the leaf to stay safe. Internal pages are read
+ * latched as in FindLeafPageRead(). The read latch of the parent keeps the leaf
+ * from being split or merged while its own read latch is traded for the write
+ * latch.
+ * @return : an invalid guard if the tree is empty
+ */
+WritePageGuard BPlusTree::FindLeafPageOptimistic(const GenericKey *key) {
+  std::shared_lock<std::shared_mutex> root_lock(root_latch_);
+  if (IsEmpty()) {
+    return {};
+  }
+  page_id_t page_id = root_page_id_;
+  ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(page_id);
+  ASSERT(guard.IsValid(), "page is nullptr");
+  if (guard.As<BPlusTreePage>()->IsLeafPage()) {
+    // a leaf root only changes under the root latch
+    guard.Drop();
+    return buffer_pool_manager_->FetchPageWrite(page_id);
+  }
+  root_lock.unlock();
+  while (true) {
+    page_id_t child_page_id = guard.As<InternalPage>()->Lookup(key, processor_);
+    ReadPageGuard child_guard = buffer_pool_manager_->FetchPageRead(child_page_id);
+    ASSERT(child_guard.IsValid(), "page is nullptr");
+    if (child_guard.As<BPlusTreePage>()->IsLeafPage()) {
+      child_guard.Drop();
+      return buffer_pool_manager_->FetchPageWrite(child_page_id);
+    }
+    guard = std::move(child_guard);
+  }
+}
+
+/*
+ * Write latch the path to the leaf page containing particular key, after the
+ * optimistic descent found the leaf unsafe. The root latch and the pages
+ * above a safe page are released as soon as it is latched, since a split or
+ * merge does not propagate past it.
+ * @return : false if the tree is empty, the root latch is held then
+ */
+bool BPlusTree::FindLeafPageWrite(const GenericKey *key, Operation op, Context &context) {
+  context.root_lock_ = std::unique_lock<std::shared_mutex>(root_latch_);
+  if (IsEmpty()) {
+    return false;
+  }
+  page_id_t page_id = root_page_id_;
+  while (true) {
+    WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(page_id);
+    ASSERT(guard.IsValid(), "page is nullptr");
+    auto *page = guard.As<BPlusTreePage>();
+    if (IsSafe(page, op)) {
+      context.write_set_.clear();
+      if (context.root_lock_.owns_lock()) {
+        context.root_lock_.unlock();
+      }
+    }
+    if (page->IsLeafPage()) {
+      context.write_set_.push_back(std::move(guard));
+      return true;
+    }
+    page_id = reinterpret_cast<InternalPage *>(page)->Lookup(key, processor_);
+    context.write_set_.push_back(std::move(guard));
+  }
+}
+
+/*
+ * A page is safe if the operation cannot split or merge it, so that its parent
+ * stays untouched.
+ */
+bool BPlusTree::IsSafe(const BPlusTreePage *page, Operation op) const {
+  if (op == Operation::kInsert) {
+    return page->GetSize() < page->GetMaxSize();
+  }
+  if (page->IsRootPage()) {
+    // see AdjustRoot()
+    return page->IsLeafPage() ? page->GetSize() > 1 : page->GetSize() > 2;
+  }
+  return page->GetSize() > page->GetMinSize();
+}
+
 /*
  * Update/Insert root page id in header page(where page_id = 0, header_page is
  * defined under include/page/header_page.h)
@@ -494,16 +904,16 @@ Page *BPlusTree::FindLeafPage(const GenericKey *key, page_id_t page_id, bool lef
  * updating it.
  */
 void BPlusTree::UpdateRootPageId(int insert_record) {
-  auto header_page = reinterpret_cast<IndexRootsPage *>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID)->GetData());
-  if (header_page == nullptr) {
+  WritePageGuard header_guard = buffer_pool_manager_->FetchPageWrite(INDEX_ROOTS_PAGE_ID);
+  if (!header_guard.IsValid()) {
     throw "out of memory";
   }
+  auto header_page = header_guard.AsMut<IndexRootsPage>();
   if (insert_record) {
     header_page->Insert(index_id_, root_page_id_);
   } else {
     header_page->Update(index_id_, root_page_id_);
   }
-  buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
 }
 
 /**
@@ -1,6 +1,9 @@
 #include "index/b_plus_tree_index.h"
 
+#include <algorithm>
+
 #include "index/generic_key.h"
+#include "index/key_sorter.h"
 #include "utils/tree_file_mgr.h"
 BPlusTreeIndex::BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size,
                                BufferPoolManager *buffer_pool_manager)
@@ -26,13 +29,60 @@ dberr_t BPlusTreeIndex::InsertEntry(const Row &key, RowId row_id, Txn *txn) {
   return DB_SUCCESS;
 }
 
+dberr_t BPlusTreeIndex::InsertEntries(const std::vector<Row> &keys, const std::vector<RowId> &row_ids, Txn *txn) {
+  std::vector<GenericKey *> index_keys(keys.size());
+  std::vector<size_t> order(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    index_keys[i] = processor_.InitKey();
+    processor_.SerializeFromKey(index_keys[i], keys[i], key_schema_);
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+    return processor_.CompareKeys(index_keys[lhs], index_keys[rhs]) < 0;
+  });
+  dberr_t result = DB_SUCCESS;
+  for (auto i : order) {
+    if (!container_.Insert(index_keys[i], row_ids[i], txn)) {
+      result = DB_FAILED;
+    }
+  }
+  for (auto index_key : index_keys) {
+    free(index_key);
+  }
+  return result;
+}
+
+dberr_t BPlusTreeIndex::BulkLoad(const std::function<bool(Row *key, RowId *row_id)> &next, Txn *txn) {
+  KeySorter sorter(processor_);
+  GenericKey *index_key = processor_.InitKey();
+  Row key;
+  RowId row_id;
+  while (next(&key, &row_id)) {
+    processor_.SerializeFromKey(index_key, key, key_schema_);
+    sorter.Add(index_key, row_id);
+  }
+  sorter.Sort();
+  auto next_entry = [&](GenericKey *entry_key, RowId *value) { return sorter.Next(entry_key, value); };
+  dberr_t result = DB_SUCCESS;
+  if (!container_.BulkLoad(next_entry)) {
+    // the tree is not empty, the sorted entries still descend to neighbouring leaves
+    while (sorter.Next(index_key, &row_id)) {
+      if (!container_.Insert(index_key, row_id, txn)) {
+        result = DB_FAILED;
+      }
+    }
+  }
+  free(index_key);
+  return sorter.GetDuplicateCount() > 0 ? DB_FAILED : result;
+}
+
 dberr_t BPlusTreeIndex::RemoveEntry(const Row &key, RowId row_id, Txn *txn) {
   GenericKey *index_key = processor_.InitKey();
   processor_.SerializeFromKey(index_key, key, key_schema_);
 
-  container_.Remove(index_key, txn);
+  bool status = container_.Remove(index_key, txn);
   free(index_key);
-  return DB_SUCCESS;
+  return status ? DB_SUCCESS : DB_FAILED;
 }
 
 dberr_t BPlusTreeIndex::ScanKey(const Row &key, vector<RowId> &result, Txn *txn, string compare_operator) {
@@ -31,6 +31,7 @@ IndexIterator &IndexIterator::operator++() {
     if (current_page_id != INVALID_PAGE_ID) {
       page = reinterpret_cast<LeafPage *>(buffer_pool_manager->FetchPage(current_page_id)->GetData());
       item_index = 0;
+      read_ahead.OnNewPage(buffer_pool_manager, current_page_id, page->GetNextPageId());
     } else {
       *this = IndexIterator(INVALID_PAGE_ID, nullptr, 0);
     }
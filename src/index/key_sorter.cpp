@@ -0,0 +1,156 @@
+#include "index/key_sorter.h"
+
+#include <algorithm>
+
+#include "glog/logging.h"
+
+KeySorter::KeySorter(const KeyManager &processor, size_t memory_limit)
+    : processor_(processor), key_size_(processor.GetKeySize()), entry_size_(key_size_ + sizeof(RowId)) {
+  // an entry takes its bytes and its item in order_
+  max_entries_ = std::clamp<size_t>(memory_limit / (entry_size_ + sizeof(SortItem)), 1, UINT32_MAX);
+  entry_.resize(entry_size_);
+  last_key_.resize(key_size_);
+}
+
+KeySorter::~KeySorter() {
+  if (file_ != nullptr) {
+    fclose(file_);
+  }
+}
+
+void KeySorter::Add(const GenericKey *key, RowId value) {
+  if (order_.size() == max_entries_) {
+    SpillRun();
+  }
+  size_t offset = entries_.size();
+  entries_.resize(offset + entry_size_);
+  memcpy(&entries_[offset], key, key_size_);
+  memcpy(&entries_[offset + key_size_], &value, sizeof(RowId));
+  // the bytes of a normalized key sort like the key, so its first ones compared as a big-endian integer decide most
+  // comparisons without a cache miss on the entry
+  uint64_t prefix = 0;
+  auto data = reinterpret_cast<const uint8_t *>(key);
+  for (size_t i = 0; i < sizeof(prefix); i++) {
+    prefix = (prefix << 8) | (i < key_size_ ? data[i] : 0);
+  }
+  order_.push_back({prefix, static_cast<uint32_t>(order_.size())});
+}
+
+void KeySorter::Sort() {
+  if (runs_.empty()) {
+    SortEntries();
+    return;
+  }
+  if (!order_.empty()) {
+    SpillRun();
+  }
+  fflush(file_);
+  // the memory of the in-memory sort is shared by the read buffers of the runs
+  entries_ = {};
+  order_ = {};
+  size_t memory = max_entries_ * (entry_size_ + sizeof(SortItem));
+  size_t buffer_entries = std::max<size_t>(memory / entry_size_ / runs_.size(), 1);
+  for (size_t i = 0; i < runs_.size(); i++) {
+    runs_[i].buffer_.resize(buffer_entries * entry_size_);
+    if (FillRun(runs_[i])) {
+      heap_.push_back(i);
+    }
+  }
+  std::make_heap(heap_.begin(), heap_.end(), [this](size_t lhs, size_t rhs) { return IsAfter(lhs, rhs); });
+}
+
+bool KeySorter::Next(GenericKey *key, RowId *value) {
+  for (const char *entry = NextEntry(); entry != nullptr; entry = NextEntry()) {
+    if (has_last_key_ && processor_.CompareKeys(KeyOf(entry), KeyOf(last_key_.data())) == 0) {
+      duplicate_count_++;
+      continue;
+    }
+    memcpy(last_key_.data(), entry, key_size_);
+    has_last_key_ = true;
+    memcpy(key, entry, key_size_);
+    memcpy(value, entry + key_size_, sizeof(RowId));
+    return true;
+  }
+  return false;
+}
+
+void KeySorter::SortEntries() {
+  // equal keys stay in the order they were added, so that the one added first is returned
+  bool is_prefix_key = key_size_ <= sizeof(uint64_t);
+  std::sort(order_.begin(), order_.end(), [this, is_prefix_key](const SortItem &lhs, const SortItem &rhs) {
+    if (lhs.prefix_ != rhs.prefix_) {
+      return lhs.prefix_ < rhs.prefix_;
+    }
+    int result = is_prefix_key ? 0
+                               : processor_.CompareKeys(KeyOf(&entries_[lhs.index_ * entry_size_]),
+                                                        KeyOf(&entries_[rhs.index_ * entry_size_]));
+    return result < 0 || (result == 0 && lhs.index_ < rhs.index_);
+  });
+}
+
+void KeySorter::SpillRun() {
+  if (file_ == nullptr) {
+    file_ = std::tmpfile();
+    if (file_ == nullptr) {
+      LOG(WARNING) << "Cannot create a file for sorted runs, sorting all keys in memory";
+      max_entries_ = UINT32_MAX;
+      return;
+    }
+  }
+  SortEntries();
+  for (auto &item : order_) {
+    [[maybe_unused]] size_t written = fwrite(&entries_[item.index_ * entry_size_], entry_size_, 1, file_);
+    ASSERT(written == 1, "Write sorted run failed.");
+  }
+  Run run;
+  run.offset_ = file_size_;
+  run.remaining_ = order_.size();
+  runs_.push_back(std::move(run));
+  file_size_ += static_cast<off_t>(order_.size() * entry_size_);
+  entries_.clear();
+  order_.clear();
+}
+
+bool KeySorter::FillRun(Run &run) {
+  if (run.remaining_ == 0) {
+    return false;
+  }
+  size_t count = std::min(run.remaining_, run.buffer_.size() / entry_size_);
+  [[maybe_unused]] int seek_result = fseeko(file_, run.offset_, SEEK_SET);
+  ASSERT(seek_result == 0, "Seek sorted run failed.");
+  [[maybe_unused]] size_t read = fread(run.buffer_.data(), entry_size_, count, file_);
+  ASSERT(read == count, "Read sorted run failed.");
+  run.offset_ += static_cast<off_t>(count * entry_size_);
+  run.remaining_ -= count;
+  run.pos_ = 0;
+  run.size_ = count;
+  return true;
+}
+
+const char *KeySorter::NextEntry() {
+  if (runs_.empty()) {
+    return next_ < order_.size() ? &entries_[order_[next_++].index_ * entry_size_] : nullptr;
+  }
+  if (heap_.empty()) {
+    return nullptr;
+  }
+  auto is_after = [this](size_t lhs, size_t rhs) { return IsAfter(lhs, rhs); };
+  std::pop_heap(heap_.begin(), heap_.end(), is_after);
+  Run &run = runs_[heap_.back()];
+  memcpy(entry_.data(), &run.buffer_[run.pos_ * entry_size_], entry_size_);
+  if (++run.pos_ < run.size_ || FillRun(run)) {
+    std::push_heap(heap_.begin(), heap_.end(), is_after);
+  } else {
+    heap_.pop_back();
+  }
+  return entry_.data();
+}
+
+bool KeySorter::IsAfter(size_t lhs, size_t rhs) const {
+  const Run &lhs_run = runs_[lhs];
+  const Run &rhs_run = runs_[rhs];
+  int result = processor_.CompareKeys(KeyOf(&lhs_run.buffer_[lhs_run.pos_ * entry_size_]),
+                                      KeyOf(&rhs_run.buffer_[rhs_run.pos_ * entry_size_]));
+  // the runs were spilled in the order the entries were added
+  return result > 0 || (result == 0 && lhs > rhs);
+}
@@ -68,20 +68,9 @@ void InternalPage::PairCopy(void *dest, void *src, int pair_num) {
  * 用了二分查找
  */
 page_id_t InternalPage::Lookup(const GenericKey *key, const KeyManager &KM) {
-  int size = GetSize();
-  int left = 1;
-  int right = size - 1;
-  while (left <= right) {
-    int mid = (left + right) / 2;
-    int compare = KM.CompareKeys(key, KeyAt(mid));
-    if (compare == 0)
-      left = mid + 1;
-    else if (compare < 0)
-      right = mid - 1;
-    else
-      left = mid + 1;
-  }
-  return ValueAt(left - 1);
+  // the child left of the first key greater than key
+  int index = 1 + KM.UpperBound(pairs_off + pair_size + key_off, GetSize() - 1, pair_size, key);
+  return ValueAt(index - 1);
 }
 
 /*****************************************************************************
@@ -130,10 +119,11 @@ int InternalPage::InsertNodeAfter(const page_id_t &old_value, GenericKey *new_ke
  * Remove half of key & value pairs from this page to "recipient" page
  * buffer_pool_manager 是干嘛的？传给CopyNFrom()用于Fetch数据页
  */
-void InternalPage::MoveHalfTo(InternalPage *recipient, BufferPoolManager *buffer_pool_manager) {
+void InternalPage::MoveHalfTo(InternalPage *recipient, BufferPoolManager *buffer_pool_manager,
+                              const LatchedPages &latched) {
   int size = GetSize();
   int offset = size - size / 2;
-  recipient->CopyNFrom(KeyAt((size + 1) / 2), size / 2, buffer_pool_manager);
+  recipient->CopyNFrom(KeyAt((size + 1) / 2), size / 2, buffer_pool_manager, latched);
   SetSize(offset);
 }
 
@@ -142,15 +132,12 @@ void InternalPage::MoveHalfTo(InternalPage *recipient, BufferPoolManager *buffer
  * So I need to 'adopt' them by changing their parent page id, which needs to be persisted with BufferPoolManger
  *
  */
-void InternalPage::CopyNFrom(void *src, int size, BufferPoolManager *buffer_pool_manager) {
+void InternalPage::CopyNFrom(void *src, int size, BufferPoolManager *buffer_pool_manager,
+                             const LatchedPages &latched) {
   SetSize(size);
   memcpy(data_, src, size * (GetKeySize() + sizeof(page_id_t)));
-  int i;
-  InternalPage *temp;
-  for (i = 0; i < size; i++) {
-    temp = reinterpret_cast<InternalPage *>(buffer_pool_manager->FetchPage(ValueAt(i)));
-    temp->SetParentPageId(GetPageId());
-    buffer_pool_manager->UnpinPage(ValueAt(i), true);
+  for (int i = 0; i < size; i++) {
+    Adopt(ValueAt(i), buffer_pool_manager, latched);
   }
 }
 
@@ -197,18 +184,15 @@ page_id_t InternalPage::RemoveAndReturnOnlyChild() {
  * You also need to use BufferPoolManager to persist changes to the parent page id for those
  * pages that are moved to the recipient
  */
-void InternalPage::MoveAllTo(InternalPage *recipient, GenericKey *middle_key, BufferPoolManager *buffer_pool_manager) {
+void InternalPage::MoveAllTo(InternalPage *recipient, GenericKey *middle_key, BufferPoolManager *buffer_pool_manager,
+                             const LatchedPages &latched) {
   SetKeyAt(0, middle_key);
   int size = GetSize();
   int size_ = recipient->GetSize();
   memcpy(recipient->KeyAt(size_), data_, size * (GetKeySize() + sizeof(page_id_t)));
   recipient->SetSize(size_ + size);
-  int i;
-  InternalPage *temp;
-  for (i = 0; i < size; i++) {
-    temp = reinterpret_cast<InternalPage *>(buffer_pool_manager->FetchPage(ValueAt(i)));
-    temp->SetParentPageId(recipient->GetPageId());
-    buffer_pool_manager->UnpinPage(ValueAt(i), true);
+  for (int i = 0; i < size; i++) {
+    recipient->Adopt(ValueAt(i), buffer_pool_manager, latched);
   }
   SetSize(0);
 }
@@ -225,9 +209,9 @@ void InternalPage::MoveAllTo(InternalPage *recipient, GenericKey *middle_key, Bu
  * pages that are moved to the recipient
  */
 void InternalPage::MoveFirstToEndOf(InternalPage *recipient, GenericKey *middle_key,
-                                    BufferPoolManager *buffer_pool_manager) {
+                                    BufferPoolManager *buffer_pool_manager, const LatchedPages &latched) {
   SetKeyAt(0, middle_key);
-  recipient->CopyLastFrom(KeyAt(0), ValueAt(0), buffer_pool_manager);
+  recipient->CopyLastFrom(KeyAt(0), ValueAt(0), buffer_pool_manager, latched);
   Remove(0);
 }
 
@@ -235,14 +219,12 @@ void InternalPage::MoveFirstToEndOf(InternalPage *recipient, GenericKey *middle_
  * Since it is an internal page, the moved entry(page)'s parent needs to be updated.
  * So I need to 'adopt' it by changing its parent page id, which needs to be persisted with BufferPoolManger
  */
-void InternalPage::CopyLastFrom(GenericKey *key, const page_id_t value, BufferPoolManager *buffer_pool_manager) {
+void InternalPage::CopyLastFrom(GenericKey *key, const page_id_t value, BufferPoolManager *buffer_pool_manager,
+                                const LatchedPages &latched) {
   int size = GetSize();
   SetKeyAt(size, key);
   SetValueAt(size, value);
-  InternalPage *temp;
-  temp = reinterpret_cast<InternalPage *>(buffer_pool_manager->FetchPage(value));
-  temp->SetParentPageId(GetPageId());
-  buffer_pool_manager->UnpinPage(value, true);
+  Adopt(value, buffer_pool_manager, latched);
   SetSize(size + 1);
 }
 
@@ -254,10 +236,10 @@ void InternalPage::CopyLastFrom(GenericKey *key, const page_id_t value, BufferPo
  * moved to the recipient
  */
 void InternalPage::MoveLastToFrontOf(InternalPage *recipient, GenericKey *middle_key,
-                                     BufferPoolManager *buffer_pool_manager) {
+                                     BufferPoolManager *buffer_pool_manager, const LatchedPages &latched) {
   int size = GetSize();
   recipient->SetKeyAt(0, middle_key);
-  recipient->CopyFirstFrom(KeyAt(size - 1), ValueAt(size - 1), buffer_pool_manager);
+  recipient->CopyFirstFrom(KeyAt(size - 1), ValueAt(size - 1), buffer_pool_manager, latched);
   SetSize(size - 1);
 }
 
@@ -267,7 +249,8 @@ void InternalPage::MoveLastToFrontOf(InternalPage *recipient, GenericKey *middle
  */
 // void InternalPage::CopyFirstFrom(const page_id_t value, BufferPoolManager *buffer_pool_manager) {
 // }
-void InternalPage::CopyFirstFrom(GenericKey *key, const page_id_t value, BufferPoolManager *buffer_pool_manager) {
+void InternalPage::CopyFirstFrom(GenericKey *key, const page_id_t value, BufferPoolManager *buffer_pool_manager,
+                                 const LatchedPages &latched) {
   int i;
   int size = GetSize();
   GenericKey *temp_key;
@@ -281,8 +264,22 @@ void InternalPage::CopyFirstFrom(GenericKey *key, const page_id_t value, BufferP
   SetValueAt(0, value);
   SetKeyAt(0, key);
   SetSize(size + 1);
-  InternalPage *temp;
-  temp = reinterpret_cast<InternalPage *>(buffer_pool_manager->FetchPage(value));
-  temp->SetParentPageId(GetPageId());
-  buffer_pool_manager->UnpinPage(value, true);
+  Adopt(value, buffer_pool_manager, latched);
+}
+
+/*
+ * Make me the parent of child. The child is write latched meanwhile, since
+ * threads which reached it before its parent was latched may still read its
+ * header, unless the caller holds its latch already.
+ */
+void InternalPage::Adopt(page_id_t child, BufferPoolManager *buffer_pool_manager, const LatchedPages &latched) {
+  for (auto *guard : latched) {
+    if (guard->IsValid() && guard->GetPageId() == child) {
+      guard->AsMut<BPlusTreePage>()->SetParentPageId(GetPageId());
+      return;
+    }
+  }
+  WritePageGuard guard = buffer_pool_manager->FetchPageWrite(child);
+  ASSERT(guard.IsValid(), "page is nullptr");
+  guard.AsMut<BPlusTreePage>()->SetParentPageId(GetPageId());
 }
\ No newline at end of file
@@ -53,21 +53,7 @@ void LeafPage::SetNextPageId(page_id_t next_page_id) {
  * 二分查找
  */
 int LeafPage::KeyIndex(const GenericKey *key, const KeyManager &KM) {
-  int size = GetSize();
-  int left = 0;
-  int right = size - 1;
-  int mid, compare;
-  while (left <= right) {
-    mid = (left + right) / 2;
-    compare = KM.CompareKeys(key, KeyAt(mid));
-    if (compare == 0)
-      right = mid - 1;
-    else if (compare < 0)
-      right = mid - 1;
-    else
-      left = mid + 1;
-  }
-  return (right + 1);
+  return KM.LowerBound(pairs_off + key_off, GetSize(), pair_size, key);
 }
 
 /*
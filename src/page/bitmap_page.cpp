@@ -1,27 +1,58 @@
 #include "page/bitmap_page.h"
 
+#include <algorithm>
+#include <cstring>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
 #include "glog/logging.h"
 
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "LoadWord assumes the bytes are in little endian order.");
+
 /**
  * Student Implement
  */
 template <size_t PageSize>
 bool BitmapPage<PageSize>::AllocatePage(uint32_t &page_offset) {
-  if (IsPageFree(next_free_page_)) {
-    // Allocate the page
-    bytes[next_free_page_ / 8] |= (1 << (next_free_page_ % 8));
-    page_allocated_++;
-    page_offset = next_free_page_;
-    // Find the next free page
-    for (uint32_t i = next_free_page_ + 1; i < GetMaxSupportedSize(); i++) {
-      if (IsPageFree(i)) {
-        next_free_page_ = i;
-        break;
-      }
+  return AllocatePages(1, page_offset);
+}
+
+template <size_t PageSize>
+bool BitmapPage<PageSize>::AllocatePages(uint32_t num_pages, uint32_t &page_offset) {
+  if (num_pages == 0 || page_allocated_ + num_pages > GetMaxSupportedSize()) {
+    return false;
+  }
+  // the first fit starts at a free page and ends before the next used page
+  next_free_page_ = FindPage(next_free_page_, true);
+  uint32_t start = next_free_page_;
+  while (start + num_pages <= GetMaxSupportedSize()) {
+    uint32_t end = FindPage(start, false);
+    if (end - start >= num_pages) {
+      break;
     }
-    return true;
+    start = FindPage(end, true);
+  }
+  if (start + num_pages > GetMaxSupportedSize()) {
+    return false;
+  }
+  // set the bits of the run word by word
+  uint32_t end = start + num_pages;
+  for (uint32_t i = start; i < end;) {
+    uint32_t bit_index = i % 64;
+    uint32_t num_bits = std::min(64 - bit_index, end - i);
+    uint64_t mask = (num_bits == 64 ? ~0ULL : ((1ULL << num_bits) - 1)) << bit_index;
+    StoreWord(i / 64, LoadWord(i / 64) | mask);
+    i += num_bits;
+  }
+  page_allocated_ += num_pages;
+  page_offset = start;
+  // a run allocated further on leaves the hint in place, it points at a hole too small for the run
+  if (start == next_free_page_) {
+    next_free_page_ = FindPage(end, true);
   }
-  return false;
+  return true;
 }
 
 /**
@@ -67,6 +98,51 @@ bool BitmapPage<PageSize>::IsPageFreeLow(uint32_t byte_index, uint8_t bit_index)
   return (bytes[byte_index] & (1 << bit_index)) == 0;
 }
 
+template <size_t PageSize>
+uint32_t BitmapPage<PageSize>::FindPage(uint32_t start, bool is_free) const {
+  if (start >= GetMaxSupportedSize()) {
+    return GetMaxSupportedSize();
+  }
+  // flip the words so that the bits looked for are ones
+  uint64_t flip = is_free ? ~0ULL : 0;
+  uint32_t word_index = start / 64;
+  // ignore the bits before start
+  uint64_t word = (LoadWord(word_index) ^ flip) & (~0ULL << (start % 64));
+  while (word == 0) {
+    if (++word_index == NUM_WORDS) {
+      return GetMaxSupportedSize();
+    }
+#ifdef __AVX2__
+    // skip four words at a time while none of them has a bit looked for
+    __m256i skip = _mm256_set1_epi64x(static_cast<int64_t>(flip));
+    while (word_index + 4 <= NUM_WORDS) {
+      __m256i words = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bytes + word_index * sizeof(uint64_t)));
+      if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(words, skip)) != -1) {
+        break;
+      }
+      word_index += 4;
+    }
+    if (word_index == NUM_WORDS) {
+      return GetMaxSupportedSize();
+    }
+#endif
+    word = LoadWord(word_index) ^ flip;
+  }
+  return word_index * 64 + static_cast<uint32_t>(__builtin_ctzll(word));
+}
+
+template <size_t PageSize>
+uint64_t BitmapPage<PageSize>::LoadWord(uint32_t word_index) const {
+  uint64_t word;
+  memcpy(&word, bytes + word_index * sizeof(uint64_t), sizeof(uint64_t));
+  return word;
+}
+
+template <size_t PageSize>
+void BitmapPage<PageSize>::StoreWord(uint32_t word_index, uint64_t word) {
+  memcpy(bytes + word_index * sizeof(uint64_t), &word, sizeof(uint64_t));
+}
+
 template class BitmapPage<64>;
 
 template class BitmapPage<128>;
@@ -79,4 +155,12 @@ template class BitmapPage<1024>;
 
 template class BitmapPage<2048>;
 
-template class BitmapPage<4096>;
\ No newline at end of file
+template class BitmapPage<4096>;
+
+template class BitmapPage<8192>;
+
+template class BitmapPage<16384>;
+
+template class BitmapPage<32768>;
+
+template class BitmapPage<PAGE_USABLE_SIZE>;
\ No newline at end of file
@@ -6,26 +6,31 @@ void TablePage::Init(page_id_t page_id, page_id_t prev_id, LogManager *log_mgr,
   memcpy(GetData(), &page_id, sizeof(page_id));
   SetPrevPageId(prev_id);
   SetNextPageId(INVALID_PAGE_ID);
-  SetFreeSpacePointer(PAGE_SIZE);
+  SetFreeSpacePointer(PAGE_USABLE_SIZE);
   SetTupleCount(0);
+  SetFreeSlot(INVALID_SLOT_NUM);
+  SetFragmentedSize(0);
 }
 
 bool TablePage::InsertTuple(Row &row, Schema *schema, Txn *txn, LockManager *lock_manager, LogManager *log_manager) {
   uint32_t serialized_size = row.GetSerializedSize(schema);
   ASSERT(serialized_size > 0, "Can not have empty row.");
-  if (GetFreeSpaceRemaining() < serialized_size + SIZE_TUPLE) {
+  uint32_t slot_size = GetFreeSlot() == INVALID_SLOT_NUM ? SIZE_TUPLE : 0;
+  if (GetFreeSpaceRemaining() < serialized_size + slot_size) {
     return false;
   }
-  // Try to find a free slot to reuse.
-  uint32_t i;
-  for (i = 0; i < GetTupleCount(); i++) {
-    // If the slot is empty, i.e. its tuple has size 0,
-    if (GetTupleSize(i) == 0) {
-      // Then we break out of the loop at index i.
-      break;
-    }
+  // The room is there, but partly in holes.
+  if (GetContiguousFreeSpace() < serialized_size + slot_size) {
+    Compact();
+  }
+  // Reuse a free slot, otherwise append one.
+  uint32_t i = GetFreeSlot();
+  if (i != INVALID_SLOT_NUM) {
+    SetFreeSlot(GetTupleOffsetAtSlot(i));
+  } else {
+    i = GetTupleCount();
   }
-  // Otherwise we claim available free space..
+  // Claim available free space.
   SetFreeSpacePointer(GetFreeSpacePointer() - serialized_size);
   uint32_t __attribute__((unused)) write_bytes = row.SerializeTo(GetData() + GetFreeSpacePointer(), schema);
   ASSERT(write_bytes == serialized_size, "Unexpected behavior in row serialize.");
@@ -82,21 +87,22 @@ bool TablePage::UpdateTuple(Row &new_row, Row *old_row, Schema *schema, Txn *txn
   uint32_t tuple_offset = GetTupleOffsetAtSlot(slot_num);
   uint32_t __attribute__((unused)) read_bytes = old_row->DeserializeFrom(GetData() + tuple_offset, schema);
   ASSERT(tuple_size == read_bytes, "Unexpected behavior in tuple deserialize.");
-  uint32_t free_space_pointer = GetFreeSpacePointer();
-  ASSERT(tuple_offset >= free_space_pointer, "Offset should appear after current free space position.");
-  memmove(GetData() + free_space_pointer + tuple_size - serialized_size, GetData() + free_space_pointer,
-          tuple_offset - free_space_pointer);
-  SetFreeSpacePointer(free_space_pointer + tuple_size - serialized_size);
-  new_row.SerializeTo(GetData() + tuple_offset + tuple_size - serialized_size, schema);
-  SetTupleSize(slot_num, serialized_size);
-
-  // Update all tuple offsets.
-  for (uint32_t i = 0; i < GetTupleCount(); ++i) {
-    uint32_t tuple_offset_i = GetTupleOffsetAtSlot(i);
-    if (GetTupleSize(i) > 0 && tuple_offset_i < tuple_offset + tuple_size) {
-      SetTupleOffsetAtSlot(i, tuple_offset_i + tuple_size - new_row.GetSerializedSize(schema));
-    }
+  // A tuple which does not grow is overwritten in place, the bytes it shrinks by become a hole.
+  if (serialized_size <= tuple_size) {
+    new_row.SerializeTo(GetData() + tuple_offset, schema);
+    SetTupleSize(slot_num, serialized_size);
+    SetFragmentedSize(GetFragmentedSize() + tuple_size - serialized_size);
+    return true;
+  }
+  // Otherwise the old tuple becomes a hole and the new one is written to the free space.
+  SetFragmentedSize(GetFragmentedSize() + tuple_size);
+  if (GetContiguousFreeSpace() < serialized_size) {
+    CompactTuples(slot_num);
   }
+  SetFreeSpacePointer(GetFreeSpacePointer() - serialized_size);
+  new_row.SerializeTo(GetData() + GetFreeSpacePointer(), schema);
+  SetTupleOffsetAtSlot(slot_num, GetFreeSpacePointer());
+  SetTupleSize(slot_num, serialized_size);
   return true;
 }
 
@@ -104,29 +110,62 @@ void TablePage::ApplyDelete(const RowId &rid, Txn *txn, LogManager *log_manager)
   uint32_t slot_num = rid.GetSlotNum();
   ASSERT(slot_num < GetTupleCount(), "Cannot have more slots than tuples.");
 
-  uint32_t tuple_offset = GetTupleOffsetAtSlot(slot_num);
   uint32_t tuple_size = GetTupleSize(slot_num);
+  // The slot is free already.
+  if (tuple_size == 0) {
+    return;
+  }
   // Check if this is a delete operation, i.e. commit a delete.
   if (IsDeleted(tuple_size)) {
     tuple_size = UnsetDeletedFlag(tuple_size);
   }
-
-  uint32_t free_space_pointer = GetFreeSpacePointer();
-  ASSERT(tuple_offset >= free_space_pointer, "Free space appears before tuples.");
-
-  memmove(GetData() + free_space_pointer + tuple_size, GetData() + free_space_pointer,
-          tuple_offset - free_space_pointer);
-  SetFreeSpacePointer(free_space_pointer + tuple_size);
+  // The tuple becomes a hole and its slot the head of the free slot list.
+  SetFragmentedSize(GetFragmentedSize() + tuple_size);
   SetTupleSize(slot_num, 0);
-  SetTupleOffsetAtSlot(slot_num, 0);
+  SetTupleOffsetAtSlot(slot_num, GetFreeSlot());
+  SetFreeSlot(slot_num);
+}
 
-  // Update all tuple offsets.
-  for (uint32_t i = 0; i < GetTupleCount(); ++i) {
-    uint32_t tuple_offset_i = GetTupleOffsetAtSlot(i);
-    if (GetTupleSize(i) != 0 && tuple_offset_i < tuple_offset) {
-      SetTupleOffsetAtSlot(i, tuple_offset_i + tuple_size);
+void TablePage::Vacuum(Txn *txn, LogManager *log_manager) {
+  for (uint32_t i = 0; i < GetTupleCount(); i++) {
+    uint32_t tuple_size = GetTupleSize(i);
+    if (tuple_size != 0 && IsDeleted(tuple_size)) {
+      ApplyDelete(RowId(GetTablePageId(), i), txn, log_manager);
     }
   }
+  Compact();
+}
+
+void TablePage::CompactTuples(uint32_t dropped_slot) {
+  // Copy the tuples out, so that they can be written back in any order.
+  char tuples[PAGE_USABLE_SIZE];
+  uint32_t free_space_pointer = GetFreeSpacePointer();
+  memcpy(tuples + free_space_pointer, GetData() + free_space_pointer, PAGE_USABLE_SIZE - free_space_pointer);
+  uint32_t tuple_count = GetTupleCount();
+  while (tuple_count > 0 && GetTupleSize(tuple_count - 1) == 0) {
+    tuple_count--;
+  }
+  SetTupleCount(tuple_count);
+  // Rebuild the free slot list from the back, so that the lowest slot is reused first.
+  SetFreeSlot(INVALID_SLOT_NUM);
+  free_space_pointer = PAGE_USABLE_SIZE;
+  for (uint32_t i = tuple_count; i-- > 0;) {
+    uint32_t tuple_size = GetTupleSize(i);
+    if (tuple_size == 0) {
+      SetTupleOffsetAtSlot(i, GetFreeSlot());
+      SetFreeSlot(i);
+      continue;
+    }
+    if (i == dropped_slot) {
+      continue;
+    }
+    tuple_size = UnsetDeletedFlag(tuple_size);
+    free_space_pointer -= tuple_size;
+    memcpy(GetData() + free_space_pointer, tuples + GetTupleOffsetAtSlot(i), tuple_size);
+    SetTupleOffsetAtSlot(i, free_space_pointer);
+  }
+  SetFreeSpacePointer(free_space_pointer);
+  SetFragmentedSize(0);
 }
 
 void TablePage::RollbackDelete(const RowId &rid, Txn *txn, LogManager *log_manager) {
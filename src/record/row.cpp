@@ -6,56 +6,59 @@ using namespace std;
 uint32_t Row::SerializeTo(char *buf, Schema *schema) const {
   ASSERT(schema != nullptr, "Invalid schema before serialize.");
   ASSERT(schema->GetColumnCount() == fields_.size(), "Fields size do not match schema's column size.");
-  // replace with your code here
-  uint32_t SerializedSize = 0;
-  vector<bool> bits;
-  for (auto field : fields_) {
-    bits.push_back(field->IsNull());
-  }
-  for (auto bit : bits) {
-    MACH_WRITE_TO(bool, buf + SerializedSize, bit);
-    SerializedSize += sizeof(bool);
-  }
-  for (auto field : fields_) {
-    if (!field->IsNull()) {
-      field->SerializeTo(buf + SerializedSize);
-      SerializedSize += field->GetSerializedSize();
+  // the bitmap and the slots of null fixed-width fields are zero
+  memset(buf, 0, schema->GetFixedRowSize());
+  uint32_t var_offset = schema->GetFixedRowSize();
+  for (uint32_t i = 0; i < fields_.size(); i++) {
+    Field *field = fields_[i];
+    if (field->IsNull()) {
+      buf[i / 8] |= static_cast<char>(1 << (i % 8));
+    }
+    char *column_data = buf + schema->GetColumnOffset(i);
+    if (schema->GetColumn(i)->GetType() == TypeId::kTypeChar) {
+      if (!field->IsNull()) {
+        memcpy(buf + var_offset, field->GetData(), field->GetLength());
+        var_offset += field->GetLength();
+      }
+      ASSERT(var_offset <= UINT16_MAX, "Row too large.");
+      MACH_WRITE_TO(uint16_t, column_data, static_cast<uint16_t>(var_offset));
+    } else if (!field->IsNull()) {
+      field->SerializeTo(column_data);
     }
   }
-  return SerializedSize;
-  // return 0;
+  return var_offset;
 }
 
 uint32_t Row::DeserializeFrom(char *buf, Schema *schema) {
   ASSERT(schema != nullptr, "Invalid schema before serialize.");
   ASSERT(fields_.empty(), "Non empty field in row.");
-  // replace with your code here
-  uint32_t SerializedSize = 0;
-  vector<bool> bits;
+  uint32_t var_offset = schema->GetFixedRowSize();
   for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
-    bits.push_back(MACH_READ_FROM(bool, buf + SerializedSize));
-    SerializedSize += sizeof(bool);
-  }
-  for (unsigned long i = 0; i < bits.size(); i++) {
-    auto *field_tmp = new Field(schema->GetColumn(i)->GetType());
-    Field::DeserializeFrom(buf + SerializedSize, schema->GetColumn(i)->GetType(), &field_tmp, bits[i]);
-    fields_.push_back(field_tmp);
-    SerializedSize += fields_.back()->GetSerializedSize();
+    TypeId type = schema->GetColumn(i)->GetType();
+    bool is_null = (buf[i / 8] >> (i % 8)) & 1;
+    char *column_data = buf + schema->GetColumnOffset(i);
+    if (type == TypeId::kTypeChar) {
+      uint32_t var_end = MACH_READ_FROM(uint16_t, column_data);
+      fields_.push_back(is_null ? new Field(type) : new Field(type, buf + var_offset, var_end - var_offset, true));
+      var_offset = var_end;
+    } else {
+      Field *field_tmp = nullptr;
+      Field::DeserializeFrom(column_data, type, &field_tmp, is_null);
+      fields_.push_back(field_tmp);
+    }
   }
-  return SerializedSize;
+  return var_offset;
 }
 
 uint32_t Row::GetSerializedSize(Schema *schema) const {
   ASSERT(schema != nullptr, "Invalid schema before serialize.");
   ASSERT(schema->GetColumnCount() == fields_.size(), "Fields size do not match schema's column size.");
-  // replace with your code here
-  uint32_t SerializedSize = 0;
+  uint32_t SerializedSize = schema->GetFixedRowSize();
   for (auto field : fields_) {
-    if (!field->IsNull()) {
-      SerializedSize += field->GetSerializedSize();
+    if (field->GetTypeId() == TypeId::kTypeChar && !field->IsNull()) {
+      SerializedSize += field->GetLength();
     }
   }
-  SerializedSize += fields_.size() * sizeof(bool);
   return SerializedSize;
 }
 
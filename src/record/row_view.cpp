@@ -0,0 +1,66 @@
+#include "record/row_view.h"
+
+Field RowView::GetField(uint32_t idx) const {
+  TypeId type = schema_->GetColumn(idx)->GetType();
+  if (IsNull(idx)) {
+    return Field(type);
+  }
+  uint32_t len = 0;
+  const char *data = GetFieldData(idx, &len);
+  switch (type) {
+    case TypeId::kTypeInt:
+      return Field(type, MACH_READ_FROM(int32_t, data));
+    case TypeId::kTypeFloat:
+      return Field(type, MACH_READ_FROM(float, data));
+    case TypeId::kTypeChar:
+      return Field(type, const_cast<char *>(data), len, false);
+    default:
+      ASSERT(false, "Unsupported field type.");
+      return Field(type);
+  }
+}
+
+void RowView::ToRow(Row *row, MemoryArena *arena) const {
+  row->destroy();
+  row->SetRowId(rid_);
+  row->arena_ = arena;
+  for (uint32_t i = 0; i < GetFieldCount(); i++) {
+    row->fields_.push_back(CopyField(i, arena));
+  }
+}
+
+void RowView::ToRow(const std::vector<uint32_t> &column_indexes, Row *row, MemoryArena *arena) const {
+  row->destroy();
+  row->SetRowId(rid_);
+  row->arena_ = arena;
+  for (auto idx : column_indexes) {
+    row->fields_.push_back(CopyField(idx, arena));
+  }
+}
+
+const char *RowView::GetFieldData(uint32_t idx, uint32_t *len) const {
+  ASSERT(idx < GetFieldCount(), "Failed to access field");
+  uint32_t offset = schema_->GetColumnOffset(idx);
+  if (schema_->GetColumn(idx)->GetType() != TypeId::kTypeChar) {
+    return data_ + offset;
+  }
+  // the data of a char column starts where the one of the char column before ends
+  uint32_t begin = offset == schema_->GetVarOffsetsBegin()
+                       ? schema_->GetFixedRowSize()
+                       : MACH_READ_FROM(uint16_t, data_ + offset - sizeof(uint16_t));
+  *len = MACH_READ_FROM(uint16_t, data_ + offset) - begin;
+  return data_ + begin;
+}
+
+Field *RowView::CopyField(uint32_t idx, MemoryArena *arena) const {
+  Field field = GetField(idx);
+  if (field.GetTypeId() == TypeId::kTypeChar && !field.IsNull()) {
+    // the field points into the row, its chars are copied; arena fields never own their data
+    auto data = const_cast<char *>(field.GetData());
+    if (arena == nullptr) {
+      return new Field(TypeId::kTypeChar, data, field.GetLength(), true);
+    }
+    return arena->New<Field>(TypeId::kTypeChar, arena->CopyBytes(data, field.GetLength()), field.GetLength(), false);
+  }
+  return arena == nullptr ? new Field(field) : arena->New<Field>(field);
+}
@@ -47,4 +47,23 @@ uint32_t Schema::DeserializeFrom(char *buf, Schema *&schema) {
   schema = new Schema(columns, is_manage);
   return SerializedSize;
   // return 0;
+}
+
+void Schema::InitLayout() {
+  column_offsets_.resize(columns_.size());
+  uint32_t offset = GetNullBitmapSize();
+  for (uint32_t i = 0; i < columns_.size(); i++) {
+    if (columns_[i]->GetType() != TypeId::kTypeChar) {
+      column_offsets_[i] = offset;
+      offset += Type::GetTypeSize(columns_[i]->GetType());
+    }
+  }
+  var_offsets_begin_ = offset;
+  for (uint32_t i = 0; i < columns_.size(); i++) {
+    if (columns_[i]->GetType() == TypeId::kTypeChar) {
+      column_offsets_[i] = offset;
+      offset += sizeof(uint16_t);
+    }
+  }
+  fixed_row_size_ = offset;
 }
\ No newline at end of file
@@ -1,45 +1,160 @@
 #include "storage/disk_manager.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
 #include <filesystem>
+#include <memory>
 #include <stdexcept>
 
 #include "glog/logging.h"
 #include "page/bitmap_page.h"
+#include "storage/io_uring_io.h"
+#include "storage/page_checksum.h"
+#include "storage/thread_pool_io.h"
 
-DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
+namespace {
+
+/**
+ * O_DIRECT needs aligned buffers. Pages which are not aligned go through this per-thread bounce buffer.
+ */
+char *GetBounceBuffer() {
+  thread_local std::unique_ptr<char, decltype(&free)> buffer(
+      static_cast<char *>(aligned_alloc(DiskManager::DIRECT_IO_ALIGNMENT, PAGE_SIZE)), &free);
+  return buffer.get();
+}
+
+inline bool IsAligned(const char *page_data) {
+  return reinterpret_cast<uintptr_t>(page_data) % DiskManager::DIRECT_IO_ALIGNMENT == 0;
+}
+
+}  // namespace
+
+DiskManager::DiskManager(const std::string &db_file, bool direct_io, IOBackendType io_backend, bool mmap_read_only,
+                         bool page_checksums)
+    : file_name_(db_file), direct_io_(direct_io && !mmap_read_only), mmap_read_only_(mmap_read_only),
+      io_backend_(io_backend) {
   std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    std::filesystem::path p = db_file;
-    if (p.has_parent_path()) std::filesystem::create_directories(p.parent_path());
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
-    db_io_.close();
-    // reopen with original mode
-    db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-    if (!db_io_.is_open()) {
-      throw std::exception();
+  if (mmap_read_only_) {
+    db_fd_ = open(db_file.c_str(), O_RDONLY);
+    if (db_fd_ < 0) {
+      throw std::runtime_error("Cannot open db file " + db_file);
+    }
+  }
+  // create the directory if it does not exist
+  std::filesystem::path p = db_file;
+  if (db_fd_ < 0 && p.has_parent_path()) std::filesystem::create_directories(p.parent_path());
+  int flags = O_RDWR | O_CREAT;
+#ifdef O_DIRECT
+  if (direct_io_) {
+    db_fd_ = open(db_file.c_str(), flags | O_DIRECT, 0644);
+    if (db_fd_ < 0) {
+      LOG(WARNING) << "Cannot open " << db_file << " with O_DIRECT, falling back to buffered I/O";
+    }
+  }
+#endif
+  if (db_fd_ < 0) {
+    direct_io_ = false;
+    db_fd_ = open(db_file.c_str(), flags, 0644);
+  }
+  if (db_fd_ < 0) {
+    throw std::runtime_error("Cannot open db file " + db_file);
+  }
+  // the destructor does not run if the constructor throws, so the file is let go here
+  try {
+    struct stat stat_buf;
+    if (fstat(db_fd_, &stat_buf) != 0) {
+      throw std::runtime_error("Cannot stat db file " + db_file);
     }
+    file_size_ = stat_buf.st_size;
+    if (mmap_read_only_ && file_size_ > 0) {
+      void *mapping = mmap(nullptr, file_size_, PROT_READ, MAP_SHARED, db_fd_, 0);
+      if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Cannot map db file " + db_file);
+      }
+      mapping_ = static_cast<char *>(mapping);
+      mapping_size_ = file_size_;
+    }
+    // the meta page tells whether pages carry checksums, so it is verified after reading it
+    ReadPhysicalPage(META_PAGE_ID, meta_data_);
+    DiskFileMetaPage *meta_page = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
+    if (file_size_ == 0) {
+      meta_page->has_checksums_ = page_checksums ? 1 : 0;
+      meta_page->format_version_ = DISK_FILE_FORMAT_VERSION;
+    } else if (meta_page->GetFormatVersion() != DISK_FILE_FORMAT_VERSION) {
+      // the other fields of an older layout mean something else, so nothing else is read
+      throw std::runtime_error("Db file " + db_file +
+                               " was written in an older file format, which this build cannot read");
+    }
+    // a meta page which was never written has no page size yet
+    if (meta_page->GetPageSize() == 0) {
+      meta_page->page_size_ = PAGE_SIZE;
+    } else if (meta_page->GetPageSize() != PAGE_SIZE) {
+      throw std::runtime_error("Db file " + db_file + " has a page size of " +
+                               std::to_string(meta_page->GetPageSize()) + " bytes, this build uses " +
+                               std::to_string(PAGE_SIZE));
+    }
+    page_checksums_ = meta_page->HasChecksums();
+    if (page_checksums_ && file_size_ > 0 && !VerifyPageChecksum(meta_data_)) {
+      throw std::runtime_error("Meta page of db file " + db_file + " does not match its checksum");
+    }
+  } catch (...) {
+    if (mapping_ != nullptr) {
+      munmap(mapping_, mapping_size_);
+      mapping_ = nullptr;
+    }
+    close(db_fd_);
+    db_fd_ = -1;
+    throw;
   }
-  ReadPhysicalPage(META_PAGE_ID, meta_data_);
 }
 
 void DiskManager::Close() {
   std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
-  WritePhysicalPage(META_PAGE_ID, meta_data_);
+  if (!closed && mmap_read_only_) {
+    if (mapping_ != nullptr) {
+      munmap(mapping_, mapping_size_);
+      mapping_ = nullptr;
+    }
+    close(db_fd_);
+    db_fd_ = -1;
+    closed = true;
+  }
   if (!closed) {
-    db_io_.close();
+    async_io_.reset();
+    WriteBackMetadata();
+    close(db_fd_);
+    db_fd_ = -1;
     closed = true;
   }
 }
 
-void DiskManager::ReadPage(page_id_t logical_page_id, char *page_data) {
+void DiskManager::FlushMetadata() {
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  if (!closed && !mmap_read_only_) {
+    WriteBackMetadata();
+  }
+}
+
+void DiskManager::WriteBackMetadata() {
+  for (uint32_t i = 0; i < bitmaps_.size(); i++) {
+    if (bitmap_dirty_[i]) {
+      WritePhysicalPage(GetBitmapPhysicalId(i), bitmaps_[i]->data_);
+      bitmap_dirty_[i] = false;
+    }
+  }
+  WritePhysicalPage(META_PAGE_ID, meta_data_);
+  fsync(db_fd_);
+}
+
+bool DiskManager::ReadPage(page_id_t logical_page_id, char *page_data) {
   ASSERT(logical_page_id >= 0, "Invalid page id.");
-  ReadPhysicalPage(MapPageId(logical_page_id), page_data);
+  return ReadPhysicalPage(MapPageId(logical_page_id), page_data);
 }
 
 void DiskManager::WritePage(page_id_t logical_page_id, const char *page_data) {
@@ -47,44 +162,169 @@ void DiskManager::WritePage(page_id_t logical_page_id, const char *page_data) {
   WritePhysicalPage(MapPageId(logical_page_id), page_data);
 }
 
+bool DiskManager::ReadPages(const std::vector<std::pair<page_id_t, char *>> &pages, std::vector<bool> *valid_pages) {
+  std::vector<IORequest> requests;
+  requests.reserve(pages.size());
+  std::vector<size_t> request_pages;  // index into pages of every request
+  std::vector<bool> valid(pages.size(), true);
+  for (size_t i = 0; i < pages.size(); i++) {
+    auto &page = pages[i];
+    ASSERT(page.first >= 0, "Invalid page id.");
+    page_id_t physical_page_id = MapPageId(page.first);
+    size_t offset = static_cast<size_t>(physical_page_id) * PAGE_SIZE;
+    // pages beyond the end of the file and unaligned O_DIRECT buffers are left to the synchronous path
+    if (offset >= file_size_ || (direct_io_ && !IsAligned(page.second))) {
+      valid[i] = ReadPhysicalPage(physical_page_id, page.second);
+    } else {
+      requests.push_back({false, offset, page.second, 0});
+      request_pages.push_back(i);
+    }
+  }
+  std::vector<bool> valid_requests;
+  SubmitBatch(requests, &valid_requests);
+  for (size_t i = 0; i < requests.size(); i++) {
+    valid[request_pages[i]] = valid_requests[i];
+  }
+  bool is_valid = std::find(valid.begin(), valid.end(), false) == valid.end();
+  if (valid_pages != nullptr) {
+    *valid_pages = std::move(valid);
+  }
+  return is_valid;
+}
+
+void DiskManager::WritePages(const std::vector<std::pair<page_id_t, const char *>> &pages) {
+  if (mmap_read_only_ && !pages.empty()) {
+    throw std::runtime_error("Cannot write to a read-only db file.");
+  }
+  std::vector<IORequest> requests;
+  requests.reserve(pages.size());
+  size_t end = 0;
+  // the caller's pages stay untouched, checksums are stamped into a copy
+  std::unique_ptr<char, decltype(&free)> stamped(nullptr, &free);
+  if (page_checksums_ && !pages.empty()) {
+    stamped.reset(static_cast<char *>(aligned_alloc(DIRECT_IO_ALIGNMENT, pages.size() * PAGE_SIZE)));
+  }
+  for (size_t i = 0; i < pages.size(); i++) {
+    auto &page = pages[i];
+    ASSERT(page.first >= 0, "Invalid page id.");
+    page_id_t physical_page_id = MapPageId(page.first);
+    size_t offset = static_cast<size_t>(physical_page_id) * PAGE_SIZE;
+    char *buffer = const_cast<char *>(page.second);
+    if (page_checksums_) {
+      buffer = stamped.get() + i * PAGE_SIZE;
+      memcpy(buffer, page.second, PAGE_SIZE);
+      StampPageChecksum(buffer);
+    }
+    if (direct_io_ && !IsAligned(buffer)) {
+      WritePhysicalPage(physical_page_id, buffer);
+    } else {
+      requests.push_back({true, offset, buffer, 0});
+      end = std::max(end, offset + PAGE_SIZE);
+    }
+  }
+  SubmitBatch(requests);
+  GrowFileSize(end);
+}
+
+IOBackendType DiskManager::GetIOBackend() {
+  GetAsyncIO();
+  return io_backend_;
+}
+
+const char *DiskManager::GetMappedPage(page_id_t logical_page_id) {
+  ASSERT(logical_page_id >= 0, "Invalid page id.");
+  alignas(DIRECT_IO_ALIGNMENT) static const char zero_page[PAGE_SIZE]{};
+  size_t offset = static_cast<size_t>(MapPageId(logical_page_id)) * PAGE_SIZE;
+  if (offset + PAGE_SIZE > mapping_size_) {
+    return zero_page;
+  }
+  if (page_checksums_ && !VerifyPageChecksum(mapping_ + offset)) {
+    LOG(ERROR) << "Page " << logical_page_id << " does not match its checksum";
+    return nullptr;
+  }
+  return mapping_ + offset;
+}
+
+void DiskManager::WillNeedPages(const std::vector<page_id_t> &logical_page_ids) {
+  static const size_t os_page_size = sysconf(_SC_PAGESIZE);
+  for (auto page_id : logical_page_ids) {
+    if (page_id < 0) {
+      continue;
+    }
+    size_t offset = static_cast<size_t>(MapPageId(page_id)) * PAGE_SIZE;
+    if (offset + PAGE_SIZE > mapping_size_) {
+      continue;
+    }
+    size_t start = offset / os_page_size * os_page_size;
+    madvise(mapping_ + start, offset + PAGE_SIZE - start, MADV_WILLNEED);
+  }
+}
+
 /**
  * Student Implement
  */
 page_id_t DiskManager::AllocatePage() {
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  return AllocatePageLow();
+}
+
+std::vector<std::pair<page_id_t, uint32_t>> DiskManager::AllocatePages(uint32_t num_pages) {
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  std::vector<std::pair<page_id_t, uint32_t>> runs;
+  DiskFileMetaPage *meta_page = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
+  // hand out the whole batch as one chunk if an extent has room for it
+  if (!mmap_read_only_ && num_pages > 1 && meta_page->GetAllocatedPages() + num_pages <= MAX_VALID_PAGE_ID) {
+    for (uint32_t i = free_extent_hint_; i < meta_page->GetExtentNums(); i++) {
+      uint32_t page_offset = 0;
+      if (BITMAP_SIZE - meta_page->GetExtentUsedPage(i) >= num_pages &&
+          GetBitmap(i)->AllocatePages(num_pages, page_offset)) {
+        bitmap_dirty_[i] = true;
+        meta_page->num_allocated_pages_ += num_pages;
+        meta_page->extent_used_page_[i] += num_pages;
+        runs.emplace_back(i * BITMAP_SIZE + page_offset, num_pages);
+        return runs;
+      }
+    }
+  }
+  // an extent hands out its free pages in increasing order, so consecutive pages extend the last run
+  for (uint32_t i = 0; i < num_pages; i++) {
+    page_id_t page_id = AllocatePageLow();
+    if (page_id == INVALID_PAGE_ID) {
+      break;
+    }
+    if (!runs.empty() && runs.back().first + static_cast<page_id_t>(runs.back().second) == page_id) {
+      runs.back().second++;
+    } else {
+      runs.emplace_back(page_id, 1);
+    }
+  }
+  return runs;
+}
+
+page_id_t DiskManager::AllocatePageLow() {
   // get meta page
   DiskFileMetaPage *meta_page = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
   // check if all pages are allocated
-  if (meta_page->GetAllocatedPages() == MAX_VALID_PAGE_ID) {
+  if (mmap_read_only_ || meta_page->GetAllocatedPages() == MAX_VALID_PAGE_ID) {
     return INVALID_PAGE_ID;
   }
-  // find a free page
-  for (uint32_t i = 0; i < meta_page->GetExtentNums(); i++) {
-    if (meta_page -> GetExtentUsedPage(i) < BITMAP_SIZE) {
-      // bitmap page needs to be updated when allocating a page
-      BitmapPage<PAGE_SIZE> *bitmap_page = new BitmapPage<PAGE_SIZE>();
-      // read the bitmap page
-      ReadPhysicalPage(i * (BITMAP_SIZE + 1) + 1, reinterpret_cast<char *>(bitmap_page));
-      // allocate the page
-      uint32_t page_offset = 0;
-      auto res = bitmap_page->AllocatePage(page_offset);
-      ASSERT(res, "BitmapPage AllocatePage failed.");
-      meta_page->num_allocated_pages_++;
-      meta_page->extent_used_page_[i]++;
-      // write the bitmap page back
-      WritePhysicalPage(i * (BITMAP_SIZE + 1) + 1, reinterpret_cast<char *>(bitmap_page));
-      return i * BITMAP_SIZE + page_offset;
-    }
+  // find a free page, the extents before the hint are full
+  uint32_t extent_id = free_extent_hint_;
+  while (extent_id < meta_page->GetExtentNums() && meta_page->GetExtentUsedPage(extent_id) >= BITMAP_SIZE) {
+    extent_id++;
   }
+  free_extent_hint_ = extent_id;
+  BitmapPage<PAGE_USABLE_SIZE> *bitmap_page = GetBitmap(extent_id);
   // create a new extent if there is no free page
-  BitmapPage<PAGE_SIZE> *bitmap_page = new BitmapPage<PAGE_SIZE>();
+  if (extent_id == meta_page->GetExtentNums()) {
+    meta_page->num_extents_++;
+  }
   uint32_t page_offset = 0;
   auto res = bitmap_page->AllocatePage(page_offset);
   ASSERT(res, "BitmapPage AllocatePage failed.");
+  bitmap_dirty_[extent_id] = true;
   meta_page->num_allocated_pages_++;
-  meta_page->num_extents_++;
-  uint32_t extent_id = meta_page->GetExtentNums() - 1;
   meta_page->extent_used_page_[extent_id]++;
-  WritePhysicalPage(extent_id * (BITMAP_SIZE + 1) + 1, reinterpret_cast<char *>(bitmap_page));
   return extent_id * BITMAP_SIZE + page_offset;
 }
 
@@ -92,17 +332,19 @@ page_id_t DiskManager::AllocatePage() {
  * Student Implement
  */
 void DiskManager::DeAllocatePage(page_id_t logical_page_id) {
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
   ASSERT(logical_page_id >= 0, "Invalid page id.");
+  if (mmap_read_only_) {
+    throw std::runtime_error("Cannot deallocate a page of a read-only db file.");
+  }
   DiskFileMetaPage *meta_page = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
-  BitmapPage<PAGE_SIZE> *bitmap_page = new BitmapPage<PAGE_SIZE>();
   uint32_t extent_id = logical_page_id / BITMAP_SIZE;
   uint32_t page_offset = logical_page_id % BITMAP_SIZE;
-  // read the bitmap page
-  ReadPhysicalPage(extent_id * (BITMAP_SIZE + 1) + 1, reinterpret_cast<char *>(bitmap_page));
-  if (bitmap_page->DeAllocatePage(page_offset)) {
+  if (extent_id < meta_page->GetExtentNums() && GetBitmap(extent_id)->DeAllocatePage(page_offset)) {
+    bitmap_dirty_[extent_id] = true;
     meta_page->num_allocated_pages_--;
     meta_page->extent_used_page_[extent_id]--;
-    WritePhysicalPage(extent_id * (BITMAP_SIZE + 1) + 1, reinterpret_cast<char *>(bitmap_page));
+    free_extent_hint_ = std::min(free_extent_hint_, extent_id);
   } else {
     LOG(ERROR) << "DeAllocate Page" << logical_page_id << " failed.";
     throw std::runtime_error("Deallocate page failed.");
@@ -113,19 +355,35 @@ void DiskManager::DeAllocatePage(page_id_t logical_page_id) {
  * Student Implement
  */
 bool DiskManager::IsPageFree(page_id_t logical_page_id) {
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
   ASSERT(logical_page_id >= 0, "Invalid page id.");
   DiskFileMetaPage *meta_page = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
-  BitmapPage<PAGE_SIZE> *bitmap_page = new BitmapPage<PAGE_SIZE>();
   uint32_t extent_id = logical_page_id / BITMAP_SIZE;
   uint32_t page_offset = logical_page_id % BITMAP_SIZE;
-  // read the bitmap page
   if (extent_id >= meta_page->GetExtentNums()) {
     return true;
   }
-  ReadPhysicalPage(extent_id * (BITMAP_SIZE + 1) + 1, reinterpret_cast<char *>(bitmap_page));
-  bool is_free = bitmap_page->IsPageFree(page_offset);
-  delete bitmap_page;
-  return is_free;
+  return GetBitmap(extent_id)->IsPageFree(page_offset);
+}
+
+BitmapPage<PAGE_USABLE_SIZE> *DiskManager::GetBitmap(uint32_t extent_id) {
+  if (extent_id >= bitmaps_.size()) {
+    bitmaps_.resize(extent_id + 1);
+    bitmap_dirty_.resize(extent_id + 1, false);
+  }
+  auto &bitmap = bitmaps_[extent_id];
+  if (bitmap == nullptr) {
+    bitmap = std::make_unique<BitmapFrame>();
+    // whatever is on disk in place of a new extent's bitmap is stale
+    if (extent_id < reinterpret_cast<DiskFileMetaPage *>(meta_data_)->GetExtentNums()) {
+      if (!ReadPhysicalPage(GetBitmapPhysicalId(extent_id), bitmap->data_)) {
+        throw std::runtime_error("Bitmap of extent " + std::to_string(extent_id) + " does not match its checksum");
+      }
+    } else {
+      memset(bitmap->data_, 0, PAGE_SIZE);
+    }
+  }
+  return reinterpret_cast<BitmapPage<PAGE_USABLE_SIZE> *>(bitmap->data_);
 }
 
 /**
@@ -138,45 +396,134 @@ page_id_t DiskManager::MapPageId(page_id_t logical_page_id) {
   return logical_page_id / BITMAP_SIZE * (BITMAP_SIZE + 1) + (logical_page_id % BITMAP_SIZE + 1) + 1;
 }
 
-int DiskManager::GetFileSize(const std::string &file_name) {
-  struct stat stat_buf;
-  int rc = stat(file_name.c_str(), &stat_buf);
-  return rc == 0 ? stat_buf.st_size : -1;
-}
-
-void DiskManager::ReadPhysicalPage(page_id_t physical_page_id, char *page_data) {
-  int offset = physical_page_id * PAGE_SIZE;
+bool DiskManager::ReadPhysicalPage(page_id_t physical_page_id, char *page_data) {
+  size_t offset = static_cast<size_t>(physical_page_id) * PAGE_SIZE;
   // check if read beyond file length
-  if (offset >= GetFileSize(file_name_)) {
+  if (offset >= file_size_) {
 #ifdef ENABLE_BPM_DEBUG
     LOG(INFO) << "Read less than a page" << std::endl;
 #endif
     memset(page_data, 0, PAGE_SIZE);
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    // if file ends before reading PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < PAGE_SIZE) {
+    return true;
+  }
+  char *buffer = direct_io_ && !IsAligned(page_data) ? GetBounceBuffer() : page_data;
+  ssize_t read_count = 0;
+  while (read_count < PAGE_SIZE) {
+    ssize_t res = pread(db_fd_, buffer + read_count, PAGE_SIZE - read_count, offset + read_count);
+    if (res < 0 && errno == EINTR) {
+      continue;
+    }
+    if (res < 0) {
+      LOG(ERROR) << "I/O error while reading: " << strerror(errno);
+    }
+    if (res <= 0) {
+      break;
+    }
+    read_count += res;
+  }
+  if (buffer != page_data) {
+    memcpy(page_data, buffer, PAGE_SIZE);
+  }
+  // if file ends before reading PAGE_SIZE
+  if (read_count < PAGE_SIZE) {
 #ifdef ENABLE_BPM_DEBUG
-      LOG(INFO) << "Read less than a page" << std::endl;
+    LOG(INFO) << "Read less than a page" << std::endl;
 #endif
-      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
-    }
+    memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+  }
+  if (page_checksums_ && !VerifyPageChecksum(page_data)) {
+    LOG(ERROR) << "Physical page " << physical_page_id << " does not match its checksum";
+    return false;
   }
+  return true;
 }
 
 void DiskManager::WritePhysicalPage(page_id_t physical_page_id, const char *page_data) {
+  if (mmap_read_only_) {
+    throw std::runtime_error("Cannot write to a read-only db file.");
+  }
   size_t offset = static_cast<size_t>(physical_page_id) * PAGE_SIZE;
-  // set write cursor to offset
-  db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
-    LOG(ERROR) << "I/O error while writing";
-    return;
-  }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
-}
\ No newline at end of file
+  const char *buffer = page_data;
+  if (page_checksums_ || (direct_io_ && !IsAligned(page_data))) {
+    char *bounce_buffer = GetBounceBuffer();
+    memcpy(bounce_buffer, page_data, PAGE_SIZE);
+    if (page_checksums_) {
+      StampPageChecksum(bounce_buffer);
+    }
+    buffer = bounce_buffer;
+  }
+  ssize_t write_count = 0;
+  while (write_count < PAGE_SIZE) {
+    ssize_t res = pwrite(db_fd_, buffer + write_count, PAGE_SIZE - write_count, offset + write_count);
+    if (res < 0 && errno == EINTR) {
+      continue;
+    }
+    // check for I/O error
+    if (res < 0) {
+      LOG(ERROR) << "I/O error while writing: " << strerror(errno);
+      return;
+    }
+    write_count += res;
+  }
+  GrowFileSize(offset + PAGE_SIZE);
+}
+
+bool DiskManager::SubmitBatch(std::vector<IORequest> &requests, std::vector<bool> *valid_requests) {
+  if (valid_requests != nullptr) {
+    valid_requests->assign(requests.size(), true);
+  }
+  if (requests.empty()) {
+    return true;
+  }
+  AsyncIO *async_io = GetAsyncIO();
+  if (async_io != nullptr) {
+    async_io->SubmitAndWait(requests);
+  } else {
+    // closed, the requests fail synchronously below like any other I/O on the closed file
+    for (auto &request : requests) {
+      request.result = -EBADF;
+    }
+  }
+  bool is_valid = true;
+  for (size_t i = 0; i < requests.size(); i++) {
+    auto &request = requests[i];
+    page_id_t physical_page_id = static_cast<page_id_t>(request.offset / PAGE_SIZE);
+    bool request_valid = true;
+    if (request.result != PAGE_SIZE && request.is_write) {
+      WritePhysicalPage(physical_page_id, request.buffer);
+    } else if (request.result != PAGE_SIZE) {
+      request_valid = ReadPhysicalPage(physical_page_id, request.buffer);
+    } else if (!request.is_write && page_checksums_ && !VerifyPageChecksum(request.buffer)) {
+      LOG(ERROR) << "Physical page " << physical_page_id << " does not match its checksum";
+      request_valid = false;
+    }
+    if (!request_valid && valid_requests != nullptr) {
+      (*valid_requests)[i] = false;
+    }
+    is_valid &= request_valid;
+  }
+  return is_valid;
+}
+
+AsyncIO *DiskManager::GetAsyncIO() {
+  std::call_once(async_io_once_, [this] {
+    if (io_backend_ == IOBackendType::kIOUring) {
+      auto io_uring = std::make_unique<IOUringIO>(db_fd_, DEFAULT_IO_QUEUE_DEPTH);
+      if (io_uring->IsAvailable()) {
+        async_io_ = std::move(io_uring);
+        return;
+      }
+      LOG(WARNING) << "io_uring is not available, falling back to a thread pool";
+      io_backend_ = IOBackendType::kThreadPool;
+    }
+    async_io_ = std::make_unique<ThreadPoolIO>(db_fd_, DEFAULT_IO_QUEUE_DEPTH);
+  });
+  return async_io_.get();
+}
+
+void DiskManager::GrowFileSize(size_t end) {
+  // writers may finish out of order
+  size_t file_size = file_size_.load();
+  while (file_size < end && !file_size_.compare_exchange_weak(file_size, end)) {
+  }
+}
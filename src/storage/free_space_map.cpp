@@ -0,0 +1,204 @@
+#include "storage/free_space_map.h"
+
+#include <algorithm>
+
+#include "glog/logging.h"
+
+FreeSpaceMap::FreeSpaceMap(BufferPoolManager *buffer_pool_manager, page_id_t first_map_page_id)
+    : buffer_pool_manager_(buffer_pool_manager) {
+  std::vector<uint8_t> buckets;
+  page_id_t map_page_id = first_map_page_id;
+  while (map_page_id != INVALID_PAGE_ID) {
+    ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(map_page_id);
+    ASSERT(guard.IsValid(), "Fetch free space map page failed.");
+    auto map_page = guard.As<FreeSpaceMapPage>();
+    map_page_ids_.push_back(map_page_id);
+    for (uint32_t i = 0; i < map_page->GetEntryCount(); i++) {
+      page_indexes_.emplace(map_page->GetTablePageId(i), table_page_ids_.size());
+      table_page_ids_.push_back(map_page->GetTablePageId(i));
+      buckets.push_back(map_page->GetBucket(i));
+    }
+    map_page_id = map_page->GetNextPageId();
+  }
+  Reserve(std::max<size_t>(buckets.size(), 1));
+  std::copy(buckets.begin(), buckets.end(), tree_.begin() + num_leaves_);
+  for (size_t node = num_leaves_ - 1; node > 0; node--) {
+    tree_[node] = std::max(tree_[2 * node], tree_[2 * node + 1]);
+  }
+}
+
+page_id_t FreeSpaceMap::GetFirstPageId() {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return map_page_ids_.empty() ? INVALID_PAGE_ID : map_page_ids_.front();
+}
+
+page_id_t FreeSpaceMap::GetLastPageId() {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return table_page_ids_.empty() ? INVALID_PAGE_ID : table_page_ids_.back();
+}
+
+size_t FreeSpaceMap::GetPageCount() {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return table_page_ids_.size();
+}
+
+page_id_t FreeSpaceMap::FindPage(uint32_t size) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  uint32_t min_bucket = FreeSpaceMapPage::MinBucket(size);
+  if (table_page_ids_.empty() || tree_[1] < min_bucket) {
+    return INVALID_PAGE_ID;
+  }
+  if (hint_ < table_page_ids_.size() && tree_[num_leaves_ + hint_] >= min_bucket) {
+    return table_page_ids_[hint_];
+  }
+  // descend towards the leftmost leaf with enough room
+  size_t node = 1;
+  while (node < num_leaves_) {
+    node = tree_[2 * node] >= min_bucket ? 2 * node : 2 * node + 1;
+  }
+  hint_ = node - num_leaves_;
+  return table_page_ids_[hint_];
+}
+
+void FreeSpaceMap::AddPage(page_id_t table_page_id, uint32_t free_space) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  size_t index = table_page_ids_.size();
+  if (index % FreeSpaceMapPage::MAX_ENTRY_COUNT == 0) {
+    page_id_t map_page_id;
+    WritePageGuard guard = buffer_pool_manager_->NewPageWrite(map_page_id);
+    if (!guard.IsValid()) {
+      LOG(ERROR) << "Cannot allocate a free space map page, page " << table_page_id << " is not tracked";
+      return;
+    }
+    guard.AsMut<FreeSpaceMapPage>()->Init();
+    if (!map_page_ids_.empty()) {
+      WritePageGuard prev_guard = buffer_pool_manager_->FetchPageWrite(map_page_ids_.back());
+      ASSERT(prev_guard.IsValid(), "Fetch free space map page failed.");
+      prev_guard.AsMut<FreeSpaceMapPage>()->SetNextPageId(map_page_id);
+    }
+    map_page_ids_.push_back(map_page_id);
+  }
+  uint8_t bucket = FreeSpaceMapPage::ToBucket(free_space);
+  WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(map_page_ids_.back());
+  ASSERT(guard.IsValid(), "Fetch free space map page failed.");
+  guard.AsMut<FreeSpaceMapPage>()->Append(table_page_id, bucket);
+  guard.Drop();
+  page_indexes_.emplace(table_page_id, index);
+  table_page_ids_.push_back(table_page_id);
+  Reserve(table_page_ids_.size());
+  hint_ = index;
+  SetBucket(index, bucket);
+}
+
+void FreeSpaceMap::GetPagesAfter(page_id_t table_page_id, size_t count, std::vector<page_id_t> *page_ids) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto it = page_indexes_.find(table_page_id);
+  if (it == page_indexes_.end()) {
+    return;
+  }
+  size_t end = std::min(it->second + 1 + count, table_page_ids_.size());
+  for (size_t index = it->second + 1; index < end; index++) {
+    page_ids->push_back(table_page_ids_[index]);
+  }
+}
+
+void FreeSpaceMap::UpdatePage(page_id_t table_page_id, uint32_t free_space) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto it = page_indexes_.find(table_page_id);
+  if (it == page_indexes_.end()) {
+    return;
+  }
+  uint8_t bucket = FreeSpaceMapPage::ToBucket(free_space);
+  if (tree_[num_leaves_ + it->second] == bucket) {
+    return;
+  }
+  size_t index = it->second;
+  page_id_t map_page_id = map_page_ids_[index / FreeSpaceMapPage::MAX_ENTRY_COUNT];
+  WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(map_page_id);
+  ASSERT(guard.IsValid(), "Fetch free space map page failed.");
+  guard.AsMut<FreeSpaceMapPage>()->SetBucket(index % FreeSpaceMapPage::MAX_ENTRY_COUNT, bucket);
+  guard.Drop();
+  SetBucket(index, bucket);
+}
+
+void FreeSpaceMap::Reset(const std::vector<std::pair<page_id_t, uint32_t>> &pages) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  size_t needed_map_pages = (pages.size() + FreeSpaceMapPage::MAX_ENTRY_COUNT - 1) / FreeSpaceMapPage::MAX_ENTRY_COUNT;
+  // an empty map keeps its first page
+  needed_map_pages = std::max<size_t>(needed_map_pages, std::min<size_t>(map_page_ids_.size(), 1));
+  for (size_t i = needed_map_pages; i < map_page_ids_.size(); i++) {
+    buffer_pool_manager_->DeletePage(map_page_ids_[i]);
+  }
+  map_page_ids_.resize(std::min(needed_map_pages, map_page_ids_.size()));
+  while (map_page_ids_.size() < needed_map_pages) {
+    page_id_t map_page_id;
+    WritePageGuard guard = buffer_pool_manager_->NewPageWrite(map_page_id);
+    ASSERT(guard.IsValid(), "Cannot allocate a free space map page.");
+    map_page_ids_.push_back(map_page_id);
+  }
+  table_page_ids_.clear();
+  page_indexes_.clear();
+  Reserve(std::max<size_t>(pages.size(), 1));
+  std::fill(tree_.begin(), tree_.end(), 0);
+  hint_ = 0;
+  for (size_t i = 0; i < map_page_ids_.size(); i++) {
+    WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(map_page_ids_[i]);
+    ASSERT(guard.IsValid(), "Fetch free space map page failed.");
+    auto map_page = guard.AsMut<FreeSpaceMapPage>();
+    map_page->Init();
+    if (i + 1 < map_page_ids_.size()) {
+      map_page->SetNextPageId(map_page_ids_[i + 1]);
+    }
+    size_t end = std::min(pages.size(), (i + 1) * FreeSpaceMapPage::MAX_ENTRY_COUNT);
+    for (size_t index = i * FreeSpaceMapPage::MAX_ENTRY_COUNT; index < end; index++) {
+      uint8_t bucket = FreeSpaceMapPage::ToBucket(pages[index].second);
+      map_page->Append(pages[index].first, bucket);
+      page_indexes_.emplace(pages[index].first, index);
+      table_page_ids_.push_back(pages[index].first);
+      SetBucket(index, bucket);
+    }
+  }
+}
+
+void FreeSpaceMap::Destroy() {
+  std::scoped_lock<std::mutex> lock(latch_);
+  for (auto map_page_id : map_page_ids_) {
+    buffer_pool_manager_->DeletePage(map_page_id);
+  }
+  map_page_ids_.clear();
+  table_page_ids_.clear();
+  page_indexes_.clear();
+  std::fill(tree_.begin(), tree_.end(), 0);
+  hint_ = 0;
+}
+
+void FreeSpaceMap::SetBucket(size_t index, uint8_t bucket) {
+  size_t node = num_leaves_ + index;
+  tree_[node] = bucket;
+  for (node /= 2; node > 0; node /= 2) {
+    uint8_t max_bucket = std::max(tree_[2 * node], tree_[2 * node + 1]);
+    if (tree_[node] == max_bucket) {
+      break;
+    }
+    tree_[node] = max_bucket;
+  }
+}
+
+void FreeSpaceMap::Reserve(size_t num_leaves) {
+  if (num_leaves <= num_leaves_) {
+    return;
+  }
+  size_t new_num_leaves = std::max<size_t>(num_leaves_, 1);
+  while (new_num_leaves < num_leaves) {
+    new_num_leaves *= 2;
+  }
+  std::vector<uint8_t> tree(2 * new_num_leaves, 0);
+  if (num_leaves_ > 0) {
+    std::copy(tree_.begin() + num_leaves_, tree_.end(), tree.begin() + new_num_leaves);
+  }
+  tree_ = std::move(tree);
+  num_leaves_ = new_num_leaves;
+  for (size_t node = num_leaves_ - 1; node > 0; node--) {
+    tree_[node] = std::max(tree_[2 * node], tree_[2 * node + 1]);
+  }
+}
@@ -0,0 +1,177 @@
+#include "storage/io_uring_io.h"
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <thread>
+
+#include "common/config.h"
+#include "glog/logging.h"
+
+namespace {
+
+int SysIOUringSetup(unsigned entries, io_uring_params *params) {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int SysIOUringEnter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+  return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+template <typename T>
+inline T *RingField(void *ring, uint32_t offset) {
+  return reinterpret_cast<T *>(static_cast<char *>(ring) + offset);
+}
+
+}  // namespace
+
+IOUringIO::IOUringIO(int fd, unsigned queue_depth) : fd_(fd) {
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  ring_fd_ = SysIOUringSetup(queue_depth, &params);
+  if (ring_fd_ < 0) {
+    LOG(WARNING) << "io_uring_setup failed: " << strerror(errno);
+    return;
+  }
+  queue_depth_ = std::min(queue_depth, params.sq_entries);
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap) {
+    sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+  }
+  sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                  IORING_OFF_SQ_RING);
+  if (sq_ring_ == MAP_FAILED) {
+    sq_ring_ = nullptr;
+    Release();
+    return;
+  }
+  if (single_mmap) {
+    cq_ring_ = sq_ring_;
+  } else {
+    cq_ring_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                    IORING_OFF_CQ_RING);
+    if (cq_ring_ == MAP_FAILED) {
+      cq_ring_ = nullptr;
+      Release();
+      return;
+    }
+  }
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  void *sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    Release();
+    return;
+  }
+  sqes_ = static_cast<io_uring_sqe *>(sqes);
+  sq_tail_ = RingField<std::atomic<unsigned>>(sq_ring_, params.sq_off.tail);
+  sq_mask_ = *RingField<unsigned>(sq_ring_, params.sq_off.ring_mask);
+  sq_array_ = RingField<unsigned>(sq_ring_, params.sq_off.array);
+  cq_head_ = RingField<std::atomic<unsigned>>(cq_ring_, params.cq_off.head);
+  cq_tail_ = RingField<std::atomic<unsigned>>(cq_ring_, params.cq_off.tail);
+  cq_mask_ = *RingField<unsigned>(cq_ring_, params.cq_off.ring_mask);
+  cqes_ = RingField<io_uring_cqe>(cq_ring_, params.cq_off.cqes);
+}
+
+IOUringIO::~IOUringIO() { Release(); }
+
+void IOUringIO::Release() {
+  if (sqes_ != nullptr) {
+    munmap(sqes_, sqes_size_);
+    sqes_ = nullptr;
+  }
+  if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+    munmap(cq_ring_, cq_ring_size_);
+  }
+  cq_ring_ = nullptr;
+  if (sq_ring_ != nullptr) {
+    munmap(sq_ring_, sq_ring_size_);
+    sq_ring_ = nullptr;
+  }
+  if (ring_fd_ >= 0) {
+    close(ring_fd_);
+    ring_fd_ = -1;
+  }
+}
+
+void IOUringIO::SubmitAndWait(std::vector<IORequest> &requests) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  batch_++;
+  std::vector<iovec> iovecs(requests.size());
+  for (auto &request : requests) {
+    request.result = -ECANCELED;
+  }
+  size_t num_prepared = 0;
+  size_t num_completed = 0;
+  unsigned num_unsubmitted = 0;  // prepared, but not taken by the kernel yet
+  while (num_completed < requests.size()) {
+    // keep the queue full
+    while (num_prepared < requests.size() && num_prepared - num_completed < queue_depth_) {
+      Prepare(requests[num_prepared], &iovecs[num_prepared], num_prepared);
+      num_prepared++;
+      num_unsubmitted++;
+    }
+    int res = SysIOUringEnter(ring_fd_, num_unsubmitted, 1, IORING_ENTER_GETEVENTS);
+    if (res >= 0) {
+      num_unsubmitted -= static_cast<unsigned>(res);
+    } else if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+      LOG(ERROR) << "io_uring_enter failed: " << strerror(errno);
+      // take back the entries the kernel has not seen and wait for the ones it has, they still use the buffers of the
+      // requests. The kernel posts their completions without being entered, so if waiting in io_uring_enter fails as
+      // well the completion queue is polled. Requests which did not complete keep -ECANCELED, the caller redoes them
+      // synchronously.
+      sq_tail_->store(sq_tail_->load(std::memory_order_relaxed) - num_unsubmitted, std::memory_order_release);
+      size_t num_in_flight = num_prepared - num_completed - num_unsubmitted;
+      num_in_flight -= std::min(num_in_flight, Reap(requests));
+      while (num_in_flight > 0) {
+        if (SysIOUringEnter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) {
+          std::this_thread::yield();
+        }
+        num_in_flight -= std::min(num_in_flight, Reap(requests));
+      }
+      return;
+    }
+    num_completed += Reap(requests);
+  }
+}
+
+void IOUringIO::Prepare(IORequest &request, iovec *iov, size_t index) {
+  unsigned tail = sq_tail_->load(std::memory_order_relaxed);
+  unsigned slot = tail & sq_mask_;
+  io_uring_sqe *sqe = &sqes_[slot];
+  memset(sqe, 0, sizeof(*sqe));
+  iov->iov_base = request.buffer;
+  iov->iov_len = PAGE_SIZE;
+  sqe->opcode = request.is_write ? IORING_OP_WRITEV : IORING_OP_READV;
+  sqe->fd = fd_;
+  sqe->addr = reinterpret_cast<uint64_t>(iov);
+  sqe->len = 1;
+  sqe->off = request.offset;
+  sqe->user_data = (static_cast<uint64_t>(batch_) << 32) | index;
+  sq_array_[slot] = slot;
+  // publish the entry before the kernel can see the new tail
+  sq_tail_->store(tail + 1, std::memory_order_release);
+}
+
+size_t IOUringIO::Reap(std::vector<IORequest> &requests) {
+  size_t num_reaped = 0;
+  unsigned head = cq_head_->load(std::memory_order_relaxed);
+  while (head != cq_tail_->load(std::memory_order_acquire)) {
+    io_uring_cqe *cqe = &cqes_[head & cq_mask_];
+    // a completion left over from an earlier batch is dropped, its requests are gone
+    size_t index = cqe->user_data & UINT32_MAX;
+    if (cqe->user_data >> 32 == batch_ && index < requests.size()) {
+      requests[index].result = cqe->res;
+      num_reaped++;
+    }
+    head++;
+  }
+  cq_head_->store(head, std::memory_order_release);
+  return num_reaped;
+}
@@ -1,75 +1,154 @@
 #include "storage/table_heap.h"
 
+TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, Schema *schema,
+                     LogManager *log_manager, LockManager *lock_manager, page_id_t free_space_map_page_id)
+    : buffer_pool_manager_(buffer_pool_manager),
+      first_page_id_(first_page_id),
+      free_space_map_(buffer_pool_manager, free_space_map_page_id),
+      schema_(schema),
+      log_manager_(log_manager),
+      lock_manager_(lock_manager) {
+  if (free_space_map_page_id != INVALID_PAGE_ID) {
+    return;
+  }
+  // a heap without a free space map walks its pages once to build one
+  page_id_t cur_page_id = first_page_id_;
+  while (cur_page_id != INVALID_PAGE_ID) {
+    ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(cur_page_id);
+    ASSERT(guard.IsValid(), "Fetch page failed.");
+    auto page = guard.As<TablePage>();
+    free_space_map_.AddPage(cur_page_id, page->GetFreeSpaceRemaining());
+    cur_page_id = page->GetNextPageId();
+  }
+}
+
 /**
  * @brief Insert a tuple into the table heap with given row.
  */
 bool TableHeap::InsertTuple(Row &row, Txn *txn) {
-  page_id_t cur_page_id = first_page_id_;
-  // find the suitable page to insert the tuple
-  while (cur_page_id != INVALID_PAGE_ID) {
-    auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(cur_page_id));
+  uint32_t serialized_size = row.GetSerializedSize(schema_);
+  if (serialized_size > TablePage::SIZE_MAX_ROW) {
+    return false;
+  }
+  uint32_t space_needed = TablePage::GetSpaceNeeded(serialized_size);
+  // try the pages the free space map has room on. A page which turns out to be fuller is corrected in the map, so it
+  // is not handed out for this size again.
+  page_id_t cur_page_id;
+  while ((cur_page_id = free_space_map_.FindPage(space_needed)) != INVALID_PAGE_ID) {
+    WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(cur_page_id);
     // cannot find page
-    if (page == nullptr) {
+    if (!guard.IsValid()) {
       LOG(ERROR) << "The buffer pool is full and no space to replace" << std::endl;
       return false;
     }
-    page->WLatch();
+    auto page = guard.As<TablePage>();
+    bool is_inserted = page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_);
+    free_space_map_.UpdatePage(cur_page_id, page->GetFreeSpaceRemaining());
     // insert tuple successfully
-    if (page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_)) {
-      page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(cur_page_id, true);
+    if (is_inserted) {
+      guard.MarkDirty();
       return true;
     }
-    // find next page
-    page->WUnlatch();
-    buffer_pool_manager_->UnpinPage(cur_page_id, false);
-    page_id_t nexr_page_id = page->GetNextPageId();
-    if (nexr_page_id == INVALID_PAGE_ID) {
+  }
+  return AppendTuple(row, txn);
+}
+
+size_t TableHeap::InsertTuples(std::vector<Row> &rows, Txn *txn) {
+  size_t inserted = 0;
+  while (inserted < rows.size()) {
+    uint32_t serialized_size = rows[inserted].GetSerializedSize(schema_);
+    if (serialized_size > TablePage::SIZE_MAX_ROW) {
+      break;
+    }
+    page_id_t cur_page_id = free_space_map_.FindPage(TablePage::GetSpaceNeeded(serialized_size));
+    if (cur_page_id == INVALID_PAGE_ID) {
+      if (!AppendTuple(rows[inserted], txn)) {
+        break;
+      }
+      // the following rows find the new page in the free space map
+      inserted++;
+      continue;
+    }
+    WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(cur_page_id);
+    if (!guard.IsValid()) {
+      LOG(ERROR) << "The buffer pool is full and no space to replace" << std::endl;
       break;
     }
-    cur_page_id = nexr_page_id;
+    // fill the page while it is latched, the first row which does not fit goes through the map again
+    auto page = guard.As<TablePage>();
+    size_t page_begin = inserted;
+    while (inserted < rows.size() && rows[inserted].GetSerializedSize(schema_) <= TablePage::SIZE_MAX_ROW &&
+           page->InsertTuple(rows[inserted], schema_, txn, lock_manager_, log_manager_)) {
+      inserted++;
+    }
+    free_space_map_.UpdatePage(cur_page_id, page->GetFreeSpaceRemaining());
+    if (inserted > page_begin) {
+      guard.MarkDirty();
+    }
+  }
+  return inserted;
+}
+
+bool TableHeap::AppendTuple(Row &row, Txn *txn) {
+  std::scoped_lock<std::mutex> lock(append_latch_);
+  // the last page stays latched, so that no other insert can append a page behind it meanwhile
+  WritePageGuard last_guard;
+  page_id_t last_page_id = free_space_map_.GetLastPageId();
+  if (last_page_id != INVALID_PAGE_ID) {
+    last_guard = buffer_pool_manager_->FetchPageWrite(last_page_id);
+    if (!last_guard.IsValid()) {
+      LOG(ERROR) << "The buffer pool is full and no space to replace" << std::endl;
+      return false;
+    }
+    // pages linked behind the last page of the map, e.g. because the map was not flushed, are added to it
+    page_id_t next_page_id;
+    while ((next_page_id = last_guard.As<TablePage>()->GetNextPageId()) != INVALID_PAGE_ID) {
+      last_guard = buffer_pool_manager_->FetchPageWrite(next_page_id);
+      if (!last_guard.IsValid()) {
+        LOG(ERROR) << "The buffer pool is full and no space to replace" << std::endl;
+        return false;
+      }
+      last_page_id = next_page_id;
+      free_space_map_.AddPage(last_page_id, last_guard.As<TablePage>()->GetFreeSpaceRemaining());
+    }
+    // another insert may have appended the last page just now
+    auto last_page = last_guard.As<TablePage>();
+    if (last_page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_)) {
+      last_guard.MarkDirty();
+      free_space_map_.UpdatePage(last_page_id, last_page->GetFreeSpaceRemaining());
+      return true;
+    }
   }
   // Create a new page and insert the tuple
   page_id_t new_page_id = INVALID_PAGE_ID;
-  auto new_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(new_page_id));
+  WritePageGuard new_guard = buffer_pool_manager_->NewPageWrite(new_page_id);
   // Cannot create a new page
-  if (new_page == nullptr) {
+  if (!new_guard.IsValid()) {
     return false;
   }
   // if the heap is not empty, then the new page turns to be the last page
   if (first_page_id_ == INVALID_PAGE_ID) {
     first_page_id_ = new_page_id;
   } else {
-    auto last_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(cur_page_id));
-    last_page->WLatch();
-    last_page->SetNextPageId(new_page_id);
-    last_page->WUnlatch();
-    buffer_pool_manager_->UnpinPage(cur_page_id, true);
-  }
-  new_page->WLatch();
-  new_page->Init(new_page_id, cur_page_id, log_manager_, txn);
-  if (new_page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_)) {
-    new_page->WUnlatch();
-    buffer_pool_manager_->UnpinPage(new_page_id, true);
-    return true;
+    last_guard.AsMut<TablePage>()->SetNextPageId(new_page_id);
+    last_guard.Drop();
   }
-  new_page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(new_page_id, true);
-  return false;
+  auto new_page = new_guard.AsMut<TablePage>();
+  new_page->Init(new_page_id, last_page_id, log_manager_, txn);
+  bool is_inserted = new_page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_);
+  free_space_map_.AddPage(new_page_id, new_page->GetFreeSpaceRemaining());
+  return is_inserted;
 }
 
 bool TableHeap::MarkDelete(const RowId &rid, Txn *txn) {
   // Find the page which contains the tuple.
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
   // If the page could not be found, then abort the recovery.
-  if (page == nullptr) {
+  if (!guard.IsValid()) {
     return false;
   }
   // Otherwise, mark the tuple as deleted.
-  page->WLatch();
-  page->MarkDelete(rid, txn, lock_manager_, log_manager_);
-  page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  guard.AsMut<TablePage>()->MarkDelete(rid, txn, lock_manager_, log_manager_);
   return true;
 }
 
@@ -77,26 +156,19 @@ bool TableHeap::MarkDelete(const RowId &rid, Txn *txn) {
  * @brief Update a tuple in the table heap with given row and rid.
  */
 bool TableHeap::UpdateTuple(Row &row, const RowId &rid, Txn *txn) {
-  page_id_t page_id = rid.GetPageId();
-  TablePage *page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+  WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
   // cannot find page
-  if (page == nullptr) {
+  if (!guard.IsValid()) {
     LOG(ERROR) << "The buffer pool is full and no space to replace" << std::endl;
     return false;
   }
-  page->WLatch();
-  Row *old_row = new Row(rid);
-  // if update successfully
-  if (page->UpdateTuple(row, old_row, schema_, txn, lock_manager_, log_manager_)) {
-    page->WUnlatch();
-    buffer_pool_manager_->UnpinPage(page_id, true);
-    delete old_row;
-    return true;
+  Row old_row(rid);
+  auto page = guard.AsMut<TablePage>();
+  if (!page->UpdateTuple(row, &old_row, schema_, txn, lock_manager_, log_manager_)) {
+    return false;
   }
-  page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page_id, true);
-  delete old_row;
-  return false;
+  free_space_map_.UpdatePage(rid.GetPageId(), page->GetFreeSpaceRemaining());
+  return true;
 }
 
 /**
@@ -105,60 +177,144 @@ bool TableHeap::UpdateTuple(Row &row, const RowId &rid, Txn *txn) {
 void TableHeap::ApplyDelete(const RowId &rid, Txn *txn) {
   // Step1: Find the page which contains the tuple.
   // Step2: Delete the tuple from the page.
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
-  page->WLatch();
+  WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
+  if (!guard.IsValid()) {
+    LOG(ERROR) << "Fetch page " << rid.GetPageId() << " for write failed" << std::endl;
+    return;
+  }
+  auto page = guard.AsMut<TablePage>();
   page->ApplyDelete(rid, txn, nullptr);
-  page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(rid.GetPageId(), true);
+  free_space_map_.UpdatePage(rid.GetPageId(), page->GetFreeSpaceRemaining());
 }
 
 void TableHeap::RollbackDelete(const RowId &rid, Txn *txn) {
   // Find the page which contains the tuple.
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
-  assert(page != nullptr);
+  WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
+  if (!guard.IsValid()) {
+    LOG(ERROR) << "Fetch page " << rid.GetPageId() << " for write failed" << std::endl;
+    return;
+  }
   // Rollback to delete.
-  page->WLatch();
-  page->RollbackDelete(rid, txn, log_manager_);
-  page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  guard.AsMut<TablePage>()->RollbackDelete(rid, txn, log_manager_);
 }
 
 /**
  * @brief Get a tuple from the table heap with given row.
  */
 bool TableHeap::GetTuple(Row *row, Txn *txn) {
-  page_id_t page_id = row->GetRowId().GetPageId();
-  TablePage *page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+  ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(row->GetRowId().GetPageId());
   // cannot find page
-  if (page == nullptr) {
+  if (!guard.IsValid()) {
     LOG(ERROR) << "The buffer pool is full and no space to replace" << std::endl;
     return false;
   }
-  page->RLatch();
-  if (page->GetTuple(row, schema_, txn, lock_manager_)) {
-    page->RUnlatch();
-    if (buffer_pool_manager_->UnpinPage(page_id, false)) {
-      return true;
-    }
-    LOG(WARNING) << "Unknown mistake" << std::endl;
-    return false;
+  if (guard.As<TablePage>()->GetTuple(row, schema_, txn, lock_manager_)) {
+    return true;
   }
-  page->RUnlatch();
   LOG(WARNING) << "Get tuple failed" << std::endl;
   return false;
 }
 
+bool TableHeap::Vacuum(Txn *txn, std::vector<std::pair<RowId, Row>> *moved_rows) {
+  std::scoped_lock<std::mutex> lock(append_latch_);
+  DeleteUnlinkedPages();
+  std::vector<std::pair<page_id_t, uint32_t>> kept_pages;
+  WritePageGuard prev_guard;
+  page_id_t prev_page_id = INVALID_PAGE_ID;
+  page_id_t cur_page_id = first_page_id_;
+  bool finished = true;
+  while (cur_page_id != INVALID_PAGE_ID) {
+    WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(cur_page_id);
+    if (!guard.IsValid()) {
+      LOG(ERROR) << "Fetch page " << cur_page_id << " for write failed, vacuum stopped" << std::endl;
+      if (prev_page_id == INVALID_PAGE_ID) {
+        return false;
+      }
+      // the pages vacuumed so far are linked up, the rest of the chain is left as it is
+      finished = false;
+      break;
+    }
+    auto page = guard.AsMut<TablePage>();
+    page->Vacuum(txn, log_manager_);
+    page->SetPrevPageId(prev_page_id);
+    page_id_t next_page_id = page->GetNextPageId();
+    // tuples of a sparse page, or of a page which fits as a whole, move into the previous page
+    uint32_t used_space = page->GetUsedSpace();
+    if (prev_page_id != INVALID_PAGE_ID &&
+        (used_space <= prev_guard.As<TablePage>()->GetFreeSpaceRemaining() || 2 * used_space < PAGE_USABLE_SIZE)) {
+      auto prev_page = prev_guard.AsMut<TablePage>();
+      RowId rid;
+      for (bool has_tuple = page->GetFirstTupleRid(&rid); has_tuple;) {
+        Row row(rid);
+        page->GetTuple(&row, schema_, txn, lock_manager_);
+        if (!prev_page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_)) {
+          break;
+        }
+        page->ApplyDelete(rid, txn, log_manager_);
+        if (moved_rows != nullptr) {
+          moved_rows->emplace_back(rid, row);
+        }
+        RowId next_rid;
+        has_tuple = page->GetNextTupleRid(rid, &next_rid);
+        rid = next_rid;
+      }
+      // an emptied page is unlinked
+      if (!page->GetFirstTupleRid(&rid)) {
+        prev_page->SetNextPageId(next_page_id);
+        guard.Drop();
+        // a page still pinned by someone else is deleted later, it must not stay allocated
+        if (!buffer_pool_manager_->DeletePage(cur_page_id)) {
+          unlinked_pages_.push_back(cur_page_id);
+        }
+        cur_page_id = next_page_id;
+        continue;
+      }
+      page->Compact();
+    }
+    // the page stays, tuples of the following pages are moved into it
+    if (prev_page_id != INVALID_PAGE_ID) {
+      kept_pages.emplace_back(prev_page_id, prev_guard.As<TablePage>()->GetFreeSpaceRemaining());
+    }
+    prev_guard = std::move(guard);
+    prev_page_id = cur_page_id;
+    cur_page_id = next_page_id;
+  }
+  if (prev_page_id != INVALID_PAGE_ID) {
+    kept_pages.emplace_back(prev_page_id, prev_guard.As<TablePage>()->GetFreeSpaceRemaining());
+  }
+  prev_guard.Drop();
+  free_space_map_.Reset(kept_pages);
+  DeleteUnlinkedPages();
+  return finished;
+}
+
+void TableHeap::DeleteUnlinkedPages() {
+  std::vector<page_id_t> pinned_pages;
+  for (auto page_id : unlinked_pages_) {
+    if (!buffer_pool_manager_->DeletePage(page_id)) {
+      pinned_pages.push_back(page_id);
+    }
+  }
+  if (!pinned_pages.empty()) {
+    LOG(WARNING) << pinned_pages.size() << " unlinked pages are still pinned, they are deleted later" << std::endl;
+  }
+  unlinked_pages_ = std::move(pinned_pages);
+}
+
 void TableHeap::DeleteTable(page_id_t page_id) {
   if (page_id != INVALID_PAGE_ID) {
-    auto temp_table_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));  
+    ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(page_id);
+    page_id_t next_page_id = guard.As<TablePage>()->GetNextPageId();
+    guard.Drop();
     // Delete table_heap recursively.
-    if (temp_table_page->GetNextPageId() != INVALID_PAGE_ID) {
-      DeleteTable(temp_table_page->GetNextPageId());
+    if (next_page_id != INVALID_PAGE_ID) {
+      DeleteTable(next_page_id);
     }
-    buffer_pool_manager_->UnpinPage(page_id, false);
     buffer_pool_manager_->DeletePage(page_id);
   } else {
     DeleteTable(first_page_id_);
+    DeleteUnlinkedPages();
+    free_space_map_.Destroy();
   }
 }
 
@@ -169,20 +325,15 @@ TableIterator TableHeap::Begin(Txn *txn) {
   page_id_t cur_page_id = first_page_id_;
   RowId first_rid;
   while (cur_page_id != INVALID_PAGE_ID) {
-    auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(cur_page_id));
-    ASSERT(page != nullptr, "Fetch page failed.");
-    page->RLatch();
+    ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(cur_page_id);
+    ASSERT(guard.IsValid(), "Fetch page failed.");
+    auto page = guard.As<TablePage>();
     if (page->GetFirstTupleRid(&first_rid)) {
       // if the first tuple is found, then return the iterator
-      page->RUnlatch();
-      buffer_pool_manager_->UnpinPage(cur_page_id, false);
-      Row *row = new Row(first_rid);
-      GetTuple(row, txn);
-      return TableIterator(this, row->GetRowId(), txn);
+      guard.Drop();
+      return TableIterator(this, first_rid, txn);
     }
     // move to the next page
-    page->RUnlatch();
-    buffer_pool_manager_->UnpinPage(cur_page_id, false);
     cur_page_id = page->GetNextPageId();
   }
   // if the table heap is empty, then return the end iterator
@@ -6,7 +6,8 @@
 /**
  * @brief Construct a new Table Iterator object.
  */
-TableIterator::TableIterator(TableHeap *table_heap, RowId rid, Txn *txn) : ite_tableheap(table_heap), ite_txn(txn) {
+TableIterator::TableIterator(TableHeap *table_heap, RowId rid, Txn *txn)
+    : ite_tableheap(table_heap), ite_txn(txn), ite_read_ahead(table_heap != nullptr ? table_heap->MakeReadAhead() : ReadAhead()) {
   if (rid.GetPageId() == INVALID_PAGE_ID) {
     ite_row = nullptr;
   } else {
@@ -15,7 +16,8 @@ TableIterator::TableIterator(TableHeap *table_heap, RowId rid, Txn *txn) : ite_t
   }
 }
 
-TableIterator::TableIterator(const TableIterator &other) : ite_tableheap(other.ite_tableheap), ite_txn(other.ite_txn) {
+TableIterator::TableIterator(const TableIterator &other)
+    : ite_tableheap(other.ite_tableheap), ite_txn(other.ite_txn), ite_read_ahead(other.ite_read_ahead) {
   if (other.ite_row != nullptr) {
     ite_row = new Row(*other.ite_row);
   } else {
@@ -60,6 +62,7 @@ TableIterator &TableIterator::operator=(const TableIterator &itr) noexcept {
   }
   ite_tableheap = itr.ite_tableheap;
   ite_txn = itr.ite_txn;
+  ite_read_ahead = itr.ite_read_ahead;
   if (ite_row != nullptr) {
     delete ite_row;
     ite_row = nullptr;
@@ -77,41 +80,41 @@ TableIterator &TableIterator::operator++() {
   }
   // Find the next tuple.
   RowId next_rid;
-  auto page = reinterpret_cast<TablePage *>(ite_tableheap->buffer_pool_manager_->FetchPage(ite_row->GetRowId().GetPageId()));
-  ASSERT(page != nullptr, "Fetch page failed.");
-  page->RLatch();
+  BufferPoolManager *buffer_pool_manager = ite_tableheap->buffer_pool_manager_;
+  ReadPageGuard guard = buffer_pool_manager->FetchPageRead(ite_row->GetRowId().GetPageId());
+  ASSERT(guard.IsValid(), "Fetch page failed.");
+  auto page = guard.As<TablePage>();
   // Update the current row.
   if (page->GetNextTupleRid(ite_row->GetRowId(), &next_rid)) {
     ite_row->destroy();
     ite_row->SetRowId(next_rid);
-    ASSERT(ite_tableheap->GetTuple(ite_row, ite_txn), "Get tuple failed.");
-    page->RUnlatch();
-    ite_tableheap->buffer_pool_manager_->UnpinPage(page->GetTablePageId(), false);
+    [[maybe_unused]] bool is_found =
+        page->GetTuple(ite_row, ite_tableheap->schema_, ite_txn, ite_tableheap->lock_manager_);
+    ASSERT(is_found, "Get tuple failed.");
     return *this;
   }
   // Find the next page with a valid tuple.
   page_id_t next_page_id = page->GetNextPageId();
-  page->RUnlatch();
-  ite_tableheap->buffer_pool_manager_->UnpinPage(page->GetTablePageId(), false);
+  guard.Drop();
   while (next_page_id != INVALID_PAGE_ID) {
     // Fetch the next page.
-    auto next_page = reinterpret_cast<TablePage *>(ite_tableheap->buffer_pool_manager_->FetchPage(next_page_id));
-    ASSERT(next_page != nullptr, "Fetch page failed.");
-    next_page->RLatch();
+    guard = buffer_pool_manager->FetchPageRead(next_page_id);
+    ASSERT(guard.IsValid(), "Fetch page failed.");
+    auto next_page = guard.As<TablePage>();
+    ite_read_ahead.OnNewPage(buffer_pool_manager, next_page_id, next_page->GetNextPageId());
     // Get the first tuple in the next page.
     if (next_page->GetFirstTupleRid(&next_rid)) {
       // Update the current row.
       ite_row->destroy();
       ite_row->SetRowId(next_rid);
-      ASSERT(ite_tableheap->GetTuple(ite_row, ite_txn), "Get tuple failed.");
-      next_page->RUnlatch();
-      ite_tableheap->buffer_pool_manager_->UnpinPage(next_page->GetTablePageId(), false);
+      [[maybe_unused]] bool is_found =
+          next_page->GetTuple(ite_row, ite_tableheap->schema_, ite_txn, ite_tableheap->lock_manager_);
+      ASSERT(is_found, "Get tuple failed.");
       return *this;
     }
     // Move to the next page.
     next_page_id = next_page->GetNextPageId();
-    next_page->RUnlatch();
-    ite_tableheap->buffer_pool_manager_->UnpinPage(next_page->GetTablePageId(), false);
+    guard.Drop();
   }
   // Set the iterator to end.
   *this = ite_tableheap->End();
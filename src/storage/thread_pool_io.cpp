@@ -0,0 +1,62 @@
+#include "storage/thread_pool_io.h"
+
+#include <unistd.h>
+
+#include <cerrno>
+
+#include "common/config.h"
+
+ThreadPoolIO::ThreadPoolIO(int fd, size_t num_threads) : fd_(fd) {
+  for (size_t i = 0; i < num_threads; i++) {
+    workers_.emplace_back(&ThreadPoolIO::WorkerLoop, this);
+  }
+}
+
+ThreadPoolIO::~ThreadPoolIO() {
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    stop_ = true;
+  }
+  task_cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPoolIO::SubmitAndWait(std::vector<IORequest> &requests) {
+  if (requests.empty()) {
+    return;
+  }
+  Batch batch;
+  batch.num_pending = requests.size();
+  std::unique_lock<std::mutex> lock(latch_);
+  for (auto &request : requests) {
+    tasks_.push_back({&request, &batch});
+  }
+  task_cv_.notify_all();
+  batch.done_cv.wait(lock, [&batch] { return batch.num_pending == 0; });
+}
+
+void ThreadPoolIO::WorkerLoop() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (true) {
+    task_cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+    if (tasks_.empty()) {
+      return;
+    }
+    Task task = tasks_.front();
+    tasks_.pop_front();
+    lock.unlock();
+    IORequest *request = task.request;
+    ssize_t res;
+    do {
+      res = request->is_write ? pwrite(fd_, request->buffer, PAGE_SIZE, request->offset)
+                              : pread(fd_, request->buffer, PAGE_SIZE, request->offset);
+    } while (res < 0 && errno == EINTR);
+    request->result = res < 0 ? -errno : res;
+    lock.lock();
+    if (--task.batch->num_pending == 0) {
+      task.batch->done_cv.notify_all();
+    }
+  }
+}
@@ -1,9 +1,15 @@
 #include "buffer/buffer_pool_manager.h"
 
+#include <atomic>
+#include <chrono>
 #include <cstdio>
 #include <random>
 #include <string>
+#include <thread>
+#include <vector>
 
+#include "buffer/read_ahead.h"
+#include "glog/logging.h"
 #include "gtest/gtest.h"
 
 TEST(BufferPoolManagerTest, BinaryDataTest) {
@@ -71,4 +77,544 @@ TEST(BufferPoolManagerTest, BinaryDataTest) {
 
   delete bpm;
   delete disk_manager;
-}
\ No newline at end of file
+}
+
+TEST(BufferPoolManagerTest, ConcurrentStressTest) {
+  const std::string db_name = "bpm_concurrent_test.db";
+  const size_t buffer_pool_size = 64;
+  const size_t num_instances = 4;
+  const int num_threads = 8;
+  const int pages_per_thread = 32;
+  const int rounds = 2000;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, num_instances);
+  ASSERT_EQ(num_instances, bpm->GetNumInstances());
+
+  // Scenario: every thread creates its own pages and stamps them with their page id.
+  std::vector<std::vector<page_id_t>> thread_pages(num_threads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < pages_per_thread; i++) {
+        page_id_t page_id;
+        Page *page = nullptr;
+        while ((page = bpm->NewPage(page_id)) == nullptr) {
+          std::this_thread::yield();
+        }
+        page->WLatch();
+        snprintf(page->GetData(), PAGE_SIZE, "page-%d", page_id);
+        page->WUnlatch();
+        thread_pages[t].push_back(page_id);
+        EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  threads.clear();
+
+  // Scenario: all threads read each other's pages at random, which forces evictions and write backs.
+  std::vector<page_id_t> all_pages;
+  for (auto &pages : thread_pages) {
+    all_pages.insert(all_pages.end(), pages.begin(), pages.end());
+  }
+  ASSERT_EQ(num_threads * pages_per_thread, all_pages.size());
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t] {
+      std::default_random_engine rng(t);
+      std::uniform_int_distribution<size_t> dist(0, all_pages.size() - 1);
+      char expected[PAGE_SIZE];
+      for (int i = 0; i < rounds; i++) {
+        page_id_t page_id = all_pages[dist(rng)];
+        Page *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          continue;
+        }
+        snprintf(expected, PAGE_SIZE, "page-%d", page_id);
+        page->RLatch();
+        EXPECT_EQ(page_id, page->GetPageId());
+        EXPECT_STREQ(expected, page->GetData());
+        page->RUnlatch();
+        EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  // Scenario: concurrent deletes release both frames and disk pages.
+  threads.clear();
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t] {
+      for (auto page_id : thread_pages[t]) {
+        EXPECT_TRUE(bpm->DeletePage(page_id));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  delete bpm;
+  disk_manager->Close();
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, FlushTest) {
+  const std::string db_name = "bpm_flush_test.db";
+  const size_t buffer_pool_size = 16;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  auto on_disk = [&](page_id_t page_id) {
+    char data[PAGE_SIZE];
+    char expected[PAGE_SIZE];
+    disk_manager->ReadPage(page_id, data);
+    snprintf(expected, PAGE_SIZE, "page-%d", page_id);
+    return strcmp(data, expected) == 0;
+  };
+
+  // Scenario: fill the pool with dirty pages, half of them are pinned again.
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page-%d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+  for (size_t i = 1; i < buffer_pool_size; i += 2) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_ids[i]));
+  }
+
+  // Scenario: the flusher writes back unpinned pages until half of the frames are clean. Pinned pages are left alone.
+  bpm->StartFlusher(0.5, 1);
+  for (int i = 0; i < 1000; i++) {
+    size_t num_clean = 0;
+    for (size_t j = 0; j < buffer_pool_size; j += 2) {
+      num_clean += on_disk(page_ids[j]) ? 1 : 0;
+    }
+    if (num_clean == buffer_pool_size / 2) {
+      break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  bpm->StopFlusher();
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    EXPECT_EQ(i % 2 == 0, on_disk(page_ids[i]));
+  }
+
+  // Scenario: FlushAllPages writes back the pinned pages as well.
+  bpm->FlushAllPages();
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    EXPECT_TRUE(on_disk(page_ids[i]));
+    if (i % 2 != 0) {
+      EXPECT_TRUE(bpm->UnpinPage(page_ids[i], false));
+    }
+  }
+
+  delete bpm;
+  disk_manager->Close();
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, DeleteEvictedPageTest) {
+  const std::string db_name = "bpm_delete_test.db";
+  const size_t buffer_pool_size = 4;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  // Scenario: the first page is evicted by the pages allocated after it.
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < 2 * buffer_pool_size; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+
+  // Scenario: deleting the evicted page and a resident one frees both on disk.
+  EXPECT_TRUE(bpm->DeletePage(page_ids.front()));
+  EXPECT_TRUE(disk_manager->IsPageFree(page_ids.front()));
+  EXPECT_TRUE(bpm->DeletePage(page_ids.back()));
+  EXPECT_TRUE(disk_manager->IsPageFree(page_ids.back()));
+
+  // Scenario: deleting a page twice, or a page which was never allocated, is harmless.
+  EXPECT_TRUE(bpm->DeletePage(page_ids.front()));
+  EXPECT_TRUE(bpm->DeletePage(page_ids.back() + 100));
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, NewPageFullInstanceTest) {
+  const std::string db_name = "bpm_new_page_test.db";
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+
+  // Scenario: a pool smaller than the number of instances asked for gets one instance per frame.
+  auto *bpm = new BufferPoolManager(4, disk_manager, 8);
+  EXPECT_EQ(4, bpm->GetNumInstances());
+  delete bpm;
+
+  // Scenario: the instance owning the lowest free page id has every frame pinned, the page goes to another instance.
+  bpm = new BufferPoolManager(4, disk_manager, 2);
+  std::vector<page_id_t> page_ids;
+  for (int i = 0; i < 4; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(page_id));
+    page_ids.push_back(page_id);
+  }
+  // the instance of the even page ids stays full, the one of the odd page ids has evictable frames
+  for (auto page_id : page_ids) {
+    if (page_id % 2 == 1) {
+      EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    }
+  }
+  page_id_t skipped_page_id = page_ids.back() + 1;
+  ASSERT_EQ(0, skipped_page_id % 2);
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(page_id));
+  EXPECT_EQ(1, page_id % 2);
+  // the id skipped is free again
+  EXPECT_TRUE(bpm->IsPageFree(skipped_page_id));
+  EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+
+  // Scenario: with every frame pinned there is no page to be had, and no id is leaked.
+  page_id_t other_page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(other_page_id));
+  ASSERT_NE(nullptr, bpm->NewPage(page_id));
+  EXPECT_EQ(nullptr, bpm->NewPage(page_id));
+  EXPECT_TRUE(bpm->IsPageFree(skipped_page_id));
+
+  for (auto id : page_ids) {
+    if (id % 2 == 0) {
+      EXPECT_TRUE(bpm->UnpinPage(id, true));
+    }
+  }
+  EXPECT_TRUE(bpm->UnpinPage(other_page_id, true));
+  EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, PrefetchTest) {
+  const std::string db_name = "bpm_prefetch_test.db";
+  const size_t buffer_pool_size = 16;
+  const int num_pages = 32;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, 2);
+  std::vector<page_id_t> page_ids;
+  for (int i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page-%d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+  delete bpm;
+  bpm = new BufferPoolManager(buffer_pool_size, disk_manager, 2);
+  auto wait_for_prefetches = [&](size_t num_prefetches) {
+    for (int i = 0; i < 1000 && bpm->GetNumPrefetches() < num_prefetches; i++) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return bpm->GetNumPrefetches();
+  };
+
+  // Scenario: prefetched pages are served from memory and hold the right data.
+  std::vector<page_id_t> window(page_ids.begin(), page_ids.begin() + 8);
+  bpm->PrefetchPages(window);
+  ASSERT_EQ(8, wait_for_prefetches(8));
+  for (auto page_id : window) {
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page-" + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(0, bpm->GetNumMisses());
+
+  // Scenario: resident pages are not read again.
+  bpm->PrefetchPages(window);
+  bpm->PrefetchPages({page_ids[8]});
+  EXPECT_EQ(9, wait_for_prefetches(9));
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(9, bpm->GetNumPrefetches());
+
+  // Scenario: a sequential walk over the pages widens the read ahead window beyond the next page.
+  ReadAhead read_ahead;
+  size_t num_prefetches = bpm->GetNumPrefetches();
+  for (int i = 9; i < 12; i++) {
+    read_ahead.OnNewPage(bpm, page_ids[i], page_ids[i + 1]);
+  }
+  EXPECT_LE(num_prefetches + READ_AHEAD_MIN_WINDOW, wait_for_prefetches(num_prefetches + READ_AHEAD_MIN_WINDOW));
+
+  // Scenario: the guessed window ends at the last allocated page, free pages are never read.
+  ReadAhead tail_read_ahead;
+  num_prefetches = bpm->GetNumPrefetches();
+  for (int i = num_pages - 5; i < num_pages - 2; i++) {
+    tail_read_ahead.OnNewPage(bpm, page_ids[i], page_ids[i + 1]);
+  }
+  EXPECT_EQ(num_prefetches + 4, wait_for_prefetches(num_prefetches + 4));
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(num_prefetches + 4, bpm->GetNumPrefetches());
+
+  delete bpm;
+  disk_manager->Close();
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, PrefetchChecksumTest) {
+  const std::string db_name = "bpm_prefetch_checksum_test.db";
+  const size_t buffer_pool_size = 16;
+  const int num_pages = 8;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name, false, IOBackendType::kIOUring, false, true);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, 2);
+  std::vector<page_id_t> page_ids;
+  for (int i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page-%d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+  delete bpm;
+  bpm = new BufferPoolManager(buffer_pool_size, disk_manager, 2);
+
+  // tear logical page 3, which is physical page 5 behind the meta page and the first bitmap
+  FILE *file = fopen(db_name.c_str(), "r+b");
+  ASSERT_NE(nullptr, file);
+  std::string torn(512, 'z');
+  ASSERT_EQ(0, fseek(file, 5 * PAGE_SIZE + 1024, SEEK_SET));
+  ASSERT_EQ(torn.size(), fwrite(torn.data(), 1, torn.size(), file));
+  fclose(file);
+
+  // Scenario: a torn page in a prefetch batch is dropped, the other pages of the batch are installed.
+  bpm->PrefetchPages(page_ids);
+  for (int i = 0; i < 1000 && bpm->GetNumPrefetches() < num_pages - 1; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(num_pages - 1, bpm->GetNumPrefetches());
+  for (auto page_id : page_ids) {
+    if (page_id == 3) {
+      continue;
+    }
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page-" + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(0, bpm->GetNumMisses());
+
+  delete bpm;
+  disk_manager->Close();
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, MmapReadOnlyTest) {
+  const std::string db_name = "bpm_mmap_test.db";
+  const size_t buffer_pool_size = 8;
+  const int num_pages = 32;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, 2);
+  for (int i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page-%d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  delete bpm;
+  delete disk_manager;
+
+  // Scenario: pages are served from the mapping, more of them than there are frames.
+  disk_manager = new DiskManager(db_name, false, IOBackendType::kIOUring, true);
+  ASSERT_TRUE(disk_manager->IsMapped());
+  bpm = new BufferPoolManager(buffer_pool_size, disk_manager, 2);
+  EXPECT_TRUE(bpm->IsReadOnly());
+  bpm->PrefetchPages({0, 1, 2, num_pages + 100});
+  for (int round = 0; round < 2; round++) {
+    for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+      Page *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(disk_manager->GetMappedPage(page_id), page->GetData());
+      EXPECT_EQ("page-" + std::to_string(page_id), std::string(page->GetData()));
+      EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+  }
+  // pages beyond the end of the file read as zeros
+  Page *page = bpm->FetchPage(num_pages + 100);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, page->GetData()[0]);
+  EXPECT_TRUE(bpm->UnpinPage(num_pages + 100, false));
+
+  // Scenario: the file can be neither grown nor shrunk.
+  page_id_t page_id;
+  EXPECT_EQ(nullptr, bpm->NewPage(page_id));
+  EXPECT_FALSE(bpm->DeletePage(0));
+  EXPECT_FALSE(disk_manager->IsPageFree(0));
+
+  // Scenario: a dirty unpin is rejected, nothing is written back when the pool is flushed and destroyed.
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  EXPECT_FALSE(bpm->UnpinPage(0, true));
+  EXPECT_FALSE(bpm->UnpinPage(0, false));
+  bpm->FlushAllPages();
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, PageChecksumTest) {
+  const std::string db_name = "bpm_checksum_test.db";
+  const size_t buffer_pool_size = 4;
+  const int num_pages = 4;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name, false, IOBackendType::kIOUring, false, true);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, 1);
+  for (int i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page-%d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  delete bpm;
+  delete disk_manager;
+
+  // logical page 1 is physical page 3, behind the meta page and the first bitmap
+  FILE *file = fopen(db_name.c_str(), "r+b");
+  ASSERT_NE(nullptr, file);
+  ASSERT_EQ(0, fseek(file, 3 * PAGE_SIZE + 100, SEEK_SET));
+  ASSERT_EQ(1U, fwrite("x", 1, 1, file));
+  fclose(file);
+
+  // Scenario: a corrupt page is not handed out, and does not take a frame.
+  disk_manager = new DiskManager(db_name);
+  bpm = new BufferPoolManager(buffer_pool_size, disk_manager, 1);
+  for (int round = 0; round < 2; round++) {
+    EXPECT_EQ(nullptr, bpm->FetchPage(1));
+  }
+  for (page_id_t page_id : {0, 2, 3}) {
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page-" + std::to_string(page_id), std::string(page->GetData()));
+  }
+  for (page_id_t page_id : {0, 2, 3}) {
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, FlushLatchedPageTest) {
+  const std::string db_name = "bpm_flush_test.db";
+  const size_t buffer_pool_size = 4;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name, false, IOBackendType::kIOUring, false, true);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, 1);
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(page_id));
+  EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+
+  // Scenario: a page is rewritten under its write latch while it is flushed, and never written back torn.
+  std::atomic<bool> stop{false};
+  std::thread writer([&] {
+    for (int round = 0; !stop; round++) {
+      Page *page = bpm->FetchPage(page_id);
+      page->WLatch();
+      memset(page->GetData(), round % 128, PAGE_SIZE);
+      page->WUnlatch();
+      bpm->UnpinPage(page_id, true);
+    }
+  });
+  char data[PAGE_SIZE];
+  for (int i = 0; i < 1000; i++) {
+    bpm->FlushAllPages();
+    ASSERT_TRUE(disk_manager->ReadPage(page_id, data));
+    for (size_t j = 0; j < PAGE_SIZE - PAGE_TRAILER_SIZE; j++) {
+      ASSERT_EQ(data[0], data[j]);
+    }
+  }
+  stop = true;
+  writer.join();
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, ConcurrentFetchUnpinBenchmark) {
+  const std::string db_name = "bpm_benchmark_test.db";
+  const size_t buffer_pool_size = 1024;
+  const int num_pages = 512;
+  const int ops_per_run = 200000;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  for (size_t num_instances : {1, 16}) {
+    auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, num_instances);
+    std::vector<page_id_t> pages;
+    for (int i = 0; i < num_pages; i++) {
+      page_id_t page_id;
+      ASSERT_NE(nullptr, bpm->NewPage(page_id));
+      bpm->UnpinPage(page_id, false);
+      pages.push_back(page_id);
+    }
+    for (int num_threads : {1, 2, 4, 8, 16, 32}) {
+      std::vector<std::thread> threads;
+      auto start = std::chrono::steady_clock::now();
+      for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t] {
+          std::default_random_engine rng(t);
+          std::uniform_int_distribution<size_t> dist(0, pages.size() - 1);
+          for (int i = 0; i < ops_per_run / num_threads; i++) {
+            page_id_t page_id = pages[dist(rng)];
+            ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+            bpm->UnpinPage(page_id, false);
+          }
+        });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      auto duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      LOG(INFO) << "instances: " << num_instances << ", threads: " << num_threads
+                << ", fetch/unpin throughput: " << static_cast<int64_t>(ops_per_run / duration) << " ops/s";
+    }
+    EXPECT_TRUE(bpm->CheckAllUnpinned());
+    for (auto page_id : pages) {
+      bpm->DeletePage(page_id);
+    }
+    delete bpm;
+  }
+  disk_manager->Close();
+  delete disk_manager;
+  remove(db_name.c_str());
+}
@@ -0,0 +1,123 @@
+#include "buffer/clock_replacer.h"
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+TEST(CLOCKReplacerTest, SampleTest) {
+  CLOCKReplacer clock_replacer(7);
+
+  // Scenario: unpin six elements, i.e. add them to the replacer.
+  for (frame_id_t frame_id : {1, 2, 3, 4, 5, 6, 1}) {
+    clock_replacer.Unpin(frame_id);
+  }
+  EXPECT_EQ(6, clock_replacer.Size());
+
+  // Scenario: get three victims from the clock.
+  int value;
+  for (frame_id_t expected : {1, 2, 3}) {
+    ASSERT_TRUE(clock_replacer.Victim(&value));
+    EXPECT_EQ(expected, value);
+  }
+
+  // Scenario: pin elements in the replacer.
+  // Note that 3 has already been victimized, so pinning 3 should have no effect.
+  clock_replacer.Pin(3);
+  clock_replacer.Pin(4);
+  EXPECT_EQ(2, clock_replacer.Size());
+
+  // Scenario: unpin 4. 4 gets its reference bit back and is only taken after the hand went past it once.
+  clock_replacer.Unpin(4);
+  for (frame_id_t expected : {5, 6, 4}) {
+    ASSERT_TRUE(clock_replacer.Victim(&value));
+    EXPECT_EQ(expected, value);
+  }
+  EXPECT_FALSE(clock_replacer.Victim(&value));
+  EXPECT_EQ(0, clock_replacer.Size());
+}
+
+TEST(CLOCKReplacerTest, ConcurrentVictimTest) {
+  const size_t num_frames = 1024;
+  const int num_threads = 8;
+  CLOCKReplacer clock_replacer(num_frames);
+  for (size_t i = 0; i < num_frames; i++) {
+    clock_replacer.Unpin(i);
+  }
+
+  // Scenario: every thread takes victims and gives back half of them, no frame may be handed out twice at a time.
+  std::vector<std::atomic<int>> owners(num_frames);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&] {
+      std::vector<frame_id_t> taken;
+      frame_id_t frame_id;
+      for (int i = 0; i < 2000; i++) {
+        if (clock_replacer.Victim(&frame_id)) {
+          EXPECT_EQ(0, owners[frame_id].fetch_add(1));
+          taken.push_back(frame_id);
+        }
+        if (i % 2 == 0 && !taken.empty()) {
+          frame_id = taken.back();
+          taken.pop_back();
+          owners[frame_id].fetch_sub(1);
+          clock_replacer.Unpin(frame_id);
+        }
+      }
+      for (auto id : taken) {
+        owners[id].fetch_sub(1);
+        clock_replacer.Unpin(id);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(num_frames, clock_replacer.Size());
+}
+
+TEST(CLOCKReplacerTest, BufferPoolTest) {
+  const std::string db_name = "clock_replacer_test.db";
+  const size_t buffer_pool_size = 10;
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, 1, ReplacerType::kClock);
+
+  // Scenario: create twice as many pages as there are frames, so that half of them are evicted by the clock.
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < 2 * buffer_pool_size; i++) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page-%d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+  char expected[PAGE_SIZE];
+  for (auto page_id : page_ids) {
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(expected, PAGE_SIZE, "page-%d", page_id);
+    EXPECT_STREQ(expected, page->GetData());
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: with every frame pinned there is nothing left to evict.
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_ids[i]));
+  }
+  page_id_t page_id;
+  EXPECT_EQ(nullptr, bpm->NewPage(page_id));
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    EXPECT_TRUE(bpm->UnpinPage(page_ids[i], false));
+  }
+
+  delete bpm;
+  disk_manager->Close();
+  delete disk_manager;
+  remove(db_name.c_str());
+}
@@ -0,0 +1,180 @@
+#include "buffer/lru_k_replacer.h"
+
+#include <chrono>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/instance.h"
+#include "executor/execute_context.h"
+#include "executor/executors/seq_scan_executor.h"
+#include "executor/plans/seq_scan_plan.h"
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer lru_k_replacer(7, 2, 0);
+
+  // frame 1 is referenced twice, frames 2 and 3 only once
+  for (frame_id_t frame_id : {1, 2, 3, 1, 4}) {
+    lru_k_replacer.Pin(frame_id);
+  }
+  for (frame_id_t frame_id : {1, 2, 3}) {
+    lru_k_replacer.Unpin(frame_id);
+  }
+  EXPECT_EQ(3, lru_k_replacer.Size());
+
+  // frames with less than k references go first, oldest reference first
+  int value;
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(2, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(3, value);
+
+  // frame 5 now has an older second to last reference than frame 1
+  lru_k_replacer.Pin(5);
+  lru_k_replacer.Pin(5);
+  lru_k_replacer.Unpin(5);
+  lru_k_replacer.Pin(1);
+  lru_k_replacer.Unpin(1);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(5, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+
+  // frame 4 is still pinned
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+  lru_k_replacer.Unpin(4);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(4, value);
+  EXPECT_EQ(0, lru_k_replacer.Size());
+}
+
+TEST(LRUKReplacerTest, CorrelatedReferenceTest) {
+  LRUKReplacer lru_k_replacer(7, 2, 4);
+
+  // back to back pins of frame 1 only count as one reference
+  lru_k_replacer.Pin(1);
+  lru_k_replacer.Pin(1);
+  lru_k_replacer.Unpin(1);
+  for (frame_id_t frame_id : {2, 3, 4, 5, 6}) {
+    lru_k_replacer.Pin(frame_id);
+    lru_k_replacer.Unpin(frame_id);
+  }
+  // frame 2 was referenced again after the correlated period
+  lru_k_replacer.Pin(2);
+  lru_k_replacer.Unpin(2);
+
+  int value;
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+  // frames 3 to 6 are still within the correlated period, but are preferred over frame 2
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(3, value);
+
+  // a removed frame starts over without history
+  lru_k_replacer.Remove(2);
+  EXPECT_EQ(3, lru_k_replacer.Size());
+  lru_k_replacer.Pin(2);
+  lru_k_replacer.Unpin(2);
+  for (frame_id_t expected : {4, 5, 6, 2}) {
+    ASSERT_TRUE(lru_k_replacer.Victim(&value));
+    EXPECT_EQ(expected, value);
+  }
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+}
+
+static const std::string db_name = "lru_k_replacer_test.db";
+static const int num_rows = 30000;
+static const int num_hot_keys = 6000;
+
+/**
+ * Load the table and its index with a buffer pool large enough to hold all of it, so that the benchmark does not
+ * spend its time in TableHeap::InsertTuple.
+ */
+static void BuildMixedWorkloadDB() {
+  auto engine = new DBStorageEngine(db_name, true, 4096);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, true),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  TableInfo *table_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, engine->catalog_mgr_->CreateTable("mixed", schema.get(), nullptr, table_info));
+  char name[64];
+  memset(name, 'x', sizeof(name));
+  for (int i = 0; i < num_rows; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, name, sizeof(name), false)};
+    Row row(fields);
+    ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, nullptr));
+  }
+  IndexInfo *index_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, engine->catalog_mgr_->CreateIndex("mixed", "mixed_id", {"id"}, nullptr, index_info, "bptree"));
+  delete engine;
+}
+
+/**
+ * Point lookups over a hot range of keys through the index, interleaved with a sequential scan of the whole table
+ * which is several times larger than the buffer pool. Reports the buffer pool hit ratio of the point lookups.
+ */
+static double RunMixedWorkload(ReplacerType replacer_type) {
+  const int rows_per_lookup = 50;
+  const size_t buffer_pool_size = 256 * 4096 / PAGE_SIZE;  // 1 MB whatever the page size
+  auto engine = new DBStorageEngine(db_name, false, buffer_pool_size, 1, replacer_type);
+  TableInfo *table_info = nullptr;
+  IndexInfo *index_info = nullptr;
+  EXPECT_EQ(DB_SUCCESS, engine->catalog_mgr_->GetTable("mixed", table_info));
+  EXPECT_EQ(DB_SUCCESS, engine->catalog_mgr_->GetIndex("mixed", "mixed_id", index_info));
+
+  std::default_random_engine rng(0);
+  std::uniform_int_distribution<int> dist(0, num_hot_keys - 1);
+  auto point_lookup = [&]() {
+    std::vector<Field> key_fields{Field(TypeId::kTypeInt, dist(rng))};
+    Row key(key_fields);
+    std::vector<RowId> result;
+    index_info->GetIndex()->ScanKey(key, result, nullptr);
+    ASSERT_EQ(1, result.size());
+    Row row(result[0]);
+    ASSERT_TRUE(table_info->GetTableHeap()->GetTuple(&row, nullptr));
+  };
+  // warm up the hot set
+  for (int i = 0; i < num_hot_keys; i++) {
+    point_lookup();
+  }
+
+  auto bpm = engine->bpm_;
+  ExecuteContext exec_ctx(nullptr, engine->catalog_mgr_, bpm);
+  SeqScanPlanNode plan(table_info->GetSchema(), "mixed");
+  SeqScanExecutor executor(&exec_ctx, &plan);
+  executor.Init();
+  Row row;
+  RowId rid;
+  size_t lookup_hits = 0, lookup_misses = 0;
+  size_t start_hits = bpm->GetNumHits(), start_misses = bpm->GetNumMisses();
+  int num_scanned = 0;
+  auto start = std::chrono::steady_clock::now();
+  while (executor.Next(&row, &rid)) {
+    if (++num_scanned % rows_per_lookup != 0) {
+      continue;
+    }
+    size_t hits = bpm->GetNumHits(), misses = bpm->GetNumMisses();
+    point_lookup();
+    lookup_hits += bpm->GetNumHits() - hits;
+    lookup_misses += bpm->GetNumMisses() - misses;
+  }
+  auto duration = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  EXPECT_EQ(num_rows, num_scanned);
+  size_t total_hits = bpm->GetNumHits() - start_hits, total_misses = bpm->GetNumMisses() - start_misses;
+  double hit_ratio = static_cast<double>(lookup_hits) / (lookup_hits + lookup_misses);
+  LOG(INFO) << (replacer_type == ReplacerType::kLRU ? "LRU" : "LRU-K") << ": point lookup hit ratio " << hit_ratio
+            << ", overall hit ratio " << static_cast<double>(total_hits) / (total_hits + total_misses) << ", "
+            << duration << " ms";
+  delete engine;
+  return hit_ratio;
+}
+
+TEST(LRUKReplacerTest, MixedWorkloadBenchmark) {
+  BuildMixedWorkloadDB();
+  double lru_hit_ratio = RunMixedWorkload(ReplacerType::kLRU);
+  double lru_k_hit_ratio = RunMixedWorkload(ReplacerType::kLRUK);
+  EXPECT_GT(lru_k_hit_ratio, lru_hit_ratio);
+}
@@ -0,0 +1,79 @@
+#include "buffer/page_guard.h"
+
+#include <cstdio>
+#include <string>
+#include <utility>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+TEST(PageGuardTest, SampleTest) {
+  const std::string db_name = "page_guard_test.db";
+  const size_t buffer_pool_size = 2;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  // Scenario: a new page is pinned until its guard goes out of scope, and is written back as dirty.
+  page_id_t page_id;
+  {
+    WritePageGuard guard = bpm->NewPageWrite(page_id);
+    ASSERT_TRUE(guard.IsValid());
+    snprintf(guard.GetDataMut(), PAGE_SIZE, "Hello");
+    EXPECT_FALSE(bpm->CheckAllUnpinned());
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  // Scenario: moving a guard hands over the pin, which is released exactly once.
+  {
+    ReadPageGuard guard = bpm->FetchPageRead(page_id);
+    ASSERT_TRUE(guard.IsValid());
+    EXPECT_STREQ("Hello", guard.GetData());
+    ReadPageGuard other = std::move(guard);
+    EXPECT_FALSE(guard.IsValid());
+    EXPECT_TRUE(other.IsValid());
+    guard = std::move(other);
+    guard.Drop();
+    EXPECT_TRUE(bpm->CheckAllUnpinned());
+    guard.Drop();
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  // Scenario: several readers can hold the latch at once.
+  {
+    ReadPageGuard first = bpm->FetchPageRead(page_id);
+    ReadPageGuard second = bpm->FetchPageRead(page_id);
+    EXPECT_EQ(page_id, second.GetPageId());
+  }
+  {
+    WritePageGuard guard = bpm->FetchPageWrite(page_id);
+    EXPECT_STREQ("Hello", guard.As<char>());
+  }
+
+  // Scenario: the dirty page survives eviction.
+  page_id_t other_page_id;
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    WritePageGuard guard = bpm->NewPageWrite(other_page_id);
+    ASSERT_TRUE(guard.IsValid());
+  }
+  {
+    ReadPageGuard guard = bpm->FetchPageRead(page_id);
+    ASSERT_TRUE(guard.IsValid());
+    EXPECT_STREQ("Hello", guard.GetData());
+  }
+
+  // Scenario: when every frame is pinned the guard is invalid.
+  {
+    WritePageGuard first = bpm->NewPageWrite(other_page_id);
+    WritePageGuard second = bpm->NewPageWrite(other_page_id);
+    ReadPageGuard guard = bpm->FetchPageRead(page_id);
+    EXPECT_FALSE(guard.IsValid());
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  delete bpm;
+  disk_manager->Close();
+  delete disk_manager;
+  remove(db_name.c_str());
+}
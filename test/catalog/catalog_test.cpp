@@ -126,4 +126,52 @@ TEST(CatalogTest, CatalogIndexTest) {
     ASSERT_EQ(rid.Get(), ret_02[i].Get());
   }
   delete db_02;
-}
\ No newline at end of file
+}
+
+TEST(CatalogTest, CreateIndexOnTableTest) {
+  /** Stage 1: an index created on a populated table is built from its rows */
+  auto db_01 = new DBStorageEngine(db_file_name, true);
+  auto &catalog_01 = db_01->catalog_mgr_;
+  Txn txn;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  TableInfo *table_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateTable("table-1", schema.get(), &txn, table_info));
+  const int row_nums = 5000;
+  const int name_nums = 100;
+  std::vector<RowId> rids;
+  for (int i = 0; i < row_nums; i++) {
+    std::string name = "name-" + std::to_string(i % name_nums);
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i),
+                              Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)};
+    Row row(fields);
+    ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, nullptr));
+    rids.push_back(row.GetRowId());
+  }
+  IndexInfo *id_index = nullptr;
+  IndexInfo *name_index = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateIndex("table-1", "index-id", {"id"}, &txn, id_index, "bptree"));
+  // the rows have duplicate names, so a unique index cannot be created on them
+  ASSERT_EQ(DB_FAILED, catalog_01->CreateIndex("table-1", "index-name", {"name"}, &txn, name_index, "bptree"));
+  ASSERT_EQ(nullptr, name_index);
+  ASSERT_EQ(DB_INDEX_NOT_FOUND, catalog_01->GetIndex("table-1", "index-name", name_index));
+  std::vector<Field> fields{Field(TypeId::kTypeInt, row_nums)};
+  Row key_row(fields);
+  ASSERT_EQ(DB_SUCCESS, id_index->GetIndex()->InsertEntry(key_row, RowId(1000, 0), nullptr));
+  delete db_01;
+  /** Stage 2: the index is found after loading */
+  auto db_02 = new DBStorageEngine(db_file_name, false);
+  auto &catalog_02 = db_02->catalog_mgr_;
+  ASSERT_EQ(DB_SUCCESS, catalog_02->GetIndex("table-1", "index-id", id_index));
+  ASSERT_EQ(DB_INDEX_NOT_FOUND, catalog_02->GetIndex("table-1", "index-name", name_index));
+  for (int i = 0; i <= row_nums; i++) {
+    std::vector<Field> id_fields{Field(TypeId::kTypeInt, i)};
+    Row id_row(id_fields);
+    std::vector<RowId> result;
+    ASSERT_EQ(DB_SUCCESS, id_index->GetIndex()->ScanKey(id_row, result, nullptr));
+    ASSERT_EQ(1, result.size());
+    ASSERT_EQ(i < row_nums ? rids[i] : RowId(1000, 0), result[0]);
+  }
+  delete db_02;
+}
@@ -0,0 +1,141 @@
+#include "common/memory_arena.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "record/row_view.h"
+#include "storage/table_heap.h"
+#include "storage/table_scanner.h"
+
+using Fields = std::vector<Field>;
+
+TEST(MemoryArenaTest, AllocateTest) {
+  MemoryArena arena(1024);
+  ASSERT_EQ(0, arena.GetBlockCount());
+  auto first = static_cast<char *>(arena.Allocate(10, 1));
+  auto second = static_cast<char *>(arena.Allocate(8, 8));
+  ASSERT_EQ(1, arena.GetBlockCount());
+  ASSERT_EQ(0, reinterpret_cast<uintptr_t>(second) % 8);
+  ASSERT_GE(second, first + 10);
+  ASSERT_EQ(18, arena.GetAllocatedBytes());
+  // a large allocation which does not fit gets its own block, the current block keeps serving small ones
+  arena.Allocate(1000);
+  ASSERT_EQ(2, arena.GetBlockCount());
+  auto third = static_cast<char *>(arena.Allocate(8, 8));
+  ASSERT_EQ(second + 8, third);
+  // fill up the first block
+  for (int i = 0; i < 200; i++) {
+    arena.Allocate(8, 8);
+  }
+  ASSERT_EQ(3, arena.GetBlockCount());
+  std::string chars = "arena";
+  char *copy = arena.CopyBytes(chars.c_str(), chars.size() + 1);
+  ASSERT_STREQ("arena", copy);
+  auto field = arena.New<Field>(TypeId::kTypeInt, 42);
+  ASSERT_EQ(0, reinterpret_cast<uintptr_t>(field) % alignof(Field));
+  ASSERT_EQ(CmpBool::kTrue, field->CompareEquals(Field(TypeId::kTypeInt, 42)));
+  // only the first block survives a reset, and is reused
+  arena.Reset();
+  ASSERT_EQ(1, arena.GetBlockCount());
+  ASSERT_EQ(0, arena.GetAllocatedBytes());
+  ASSERT_EQ(first, arena.Allocate(10, 1));
+  ASSERT_EQ(3, arena.GetBlockAllocations());
+}
+
+TEST(MemoryArenaTest, ArenaRowTest) {
+  MemoryArena arena;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false),
+                                   new Column("account", TypeId::kTypeFloat, 2, true, false)};
+  Schema schema(columns);
+  std::string name = "minisql";
+  Fields fields{Field(TypeId::kTypeInt, 7), Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true),
+                Field(TypeId::kTypeFloat)};
+  Row row(fields);
+  std::vector<char> buf(row.GetSerializedSize(&schema));
+  row.SerializeTo(buf.data(), &schema);
+  RowView view(&schema);
+  view.Reset(buf.data(), RowId(1, 2));
+  Row arena_row;
+  view.ToRow(&arena_row, &arena);
+  ASSERT_EQ(&arena, arena_row.GetArena());
+  ASSERT_GT(arena.GetAllocatedBytes(), 0);
+  // the fields do not point into the serialized row
+  std::fill(buf.begin(), buf.end(), 0);
+  std::vector<Row> copies{arena_row, arena_row};
+  for (auto &copy : copies) {
+    ASSERT_EQ(&arena, copy.GetArena());
+    ASSERT_EQ(RowId(1, 2), copy.GetRowId());
+    ASSERT_EQ(3, copy.GetFieldCount());
+    for (uint32_t i = 0; i < copy.GetFieldCount(); i++) {
+      ASSERT_EQ(fields[i].IsNull(), copy.GetField(i)->IsNull());
+      if (!fields[i].IsNull()) {
+        ASSERT_EQ(CmpBool::kTrue, copy.GetField(i)->CompareEquals(fields[i]));
+      }
+    }
+  }
+  // an arena row can be reused for a heap row
+  view.Reset(buf.data(), RowId(1, 3));
+  row.SerializeTo(buf.data(), &schema);
+  view.ToRow(&arena_row);
+  ASSERT_EQ(nullptr, arena_row.GetArena());
+  ASSERT_EQ(CmpBool::kTrue, arena_row.GetField(1)->CompareEquals(fields[1]));
+}
+
+TEST(MemoryArenaTest, ScanBenchmark) {
+  const std::string db_name = "memory_arena_bench.db";
+  const int row_nums = 1000000;
+  remove(db_name.c_str());
+  auto disk_mgr = new DiskManager(db_name);
+  auto bpm = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 32, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(bpm, schema.get(), nullptr, nullptr, nullptr);
+  std::string name(24, 'x');
+  for (int i = 0; i < row_nums; i += INSERT_BATCH_SIZE) {
+    std::vector<Row> rows;
+    for (int j = i; j < std::min(i + INSERT_BATCH_SIZE, row_nums); j++) {
+      Fields fields{Field(TypeId::kTypeInt, j),
+                    Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)};
+      rows.emplace_back(fields);
+    }
+    ASSERT_EQ(rows.size(), table_heap->InsertTuples(rows, nullptr));
+  }
+  // materialize every row the way a sequential scan does, with fields from the heap and from an arena
+  auto scan = [&](MemoryArena *arena, double *duration) {
+    auto start = std::chrono::steady_clock::now();
+    int count = 0;
+    size_t bytes = 0;
+    Row row;
+    TableScanner scanner(table_heap, nullptr);
+    while (scanner.Next([&](const RowView &view) {
+      view.ToRow(&row, arena);
+      return true;
+    })) {
+      bytes += row.GetField(1)->GetLength();
+      count++;
+    }
+    *duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    ASSERT_EQ(row_nums, count);
+    ASSERT_EQ(row_nums * name.size(), bytes);
+  };
+  double heap_duration, arena_duration;
+  scan(nullptr, &heap_duration);
+  MemoryArena arena;
+  scan(&arena, &arena_duration);
+  // the heap allocates every field and every char payload, the arena one block per ARENA_BLOCK_SIZE bytes
+  size_t heap_allocations = 3 * row_nums;
+  size_t arena_allocations = arena.GetBlockAllocations();
+  LOG(INFO) << "scan of " << row_nums << " rows, heap: at least " << heap_allocations << " allocations, "
+            << static_cast<int64_t>(row_nums / heap_duration) << " rows/s, arena: " << arena_allocations
+            << " allocations, " << static_cast<int64_t>(row_nums / arena_duration) << " rows/s, "
+            << arena.GetAllocatedBytes() << " bytes";
+  ASSERT_LT(arena_allocations * 50, heap_allocations);
+  delete table_heap;
+  delete bpm;
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
@@ -1,6 +1,8 @@
 //
 // Created by njz on 2023/1/26.
 //
+#include <fstream>
+
 #include "executor/plans/delete_plan.h"
 #include "executor/plans/insert_plan.h"
 #include "executor/plans/seq_scan_plan.h"
@@ -8,6 +10,25 @@
 #include "executor/plans/values_plan.h"
 #include "executor_test_util.h"  // NOLINT
 
+extern "C" {
+int yyparse(void);
+#include "parser/minisql_lex.h"
+#include "parser/parser.h"
+}
+
+// parse a single statement and run it on the engine, the way the shell does
+static dberr_t ExecuteSql(ExecuteEngine &engine, const std::string &sql) {
+  YY_BUFFER_STATE bp = yy_scan_string(sql.c_str());
+  yy_switch_to_buffer(bp);
+  MinisqlParserInit();
+  yyparse();
+  dberr_t result = MinisqlParserGetError() ? DB_FAILED : engine.Execute(MinisqlGetParserRootNode());
+  MinisqlParserFinish();
+  yy_delete_buffer(bp);
+  yylex_destroy();
+  return result;
+}
+
 // SELECT id FROM table-1 WHERE id < 500
 TEST_F(ExecutorTest, SimpleSeqScanTest) {
   // Construct query plan
@@ -112,6 +133,106 @@ TEST_F(ExecutorTest, SimpleRawInsertTest) {
   ASSERT_TRUE(result_set[0].GetField(2)->CompareEquals(Field(kTypeFloat, static_cast<float>(2.33))));
 }
 
+// INSERT INTO table-1 VALUES (1000, "aaa", 2.33), (1001, "aaa", 2.33), ... (3499, "aaa", 2.33);
+TEST_F(ExecutorTest, MultiRowInsertTest) {
+  // More rows than an insert hands to the table heap at once
+  const int row_count = 2 * INSERT_BATCH_SIZE + 452;
+  std::vector<std::vector<AbstractExpressionRef>> raw_values{};
+  for (int i = 0; i < row_count; i++) {
+    raw_values.push_back({MakeConstantValueExpression(Field(kTypeInt, 1000 + i)),
+                          MakeConstantValueExpression(Field(kTypeChar, const_cast<char *>("aaa"), 3, false)),
+                          MakeConstantValueExpression(Field(kTypeFloat, static_cast<float>(2.33)))});
+  }
+  auto value_plan = std::make_shared<ValuesPlanNode>(nullptr, raw_values);
+
+  // Create the index
+  IndexInfo *index_info = nullptr;
+  std::vector<std::string> index_keys{"id"};
+  auto r3 =
+      GetExecutorContext()->GetCatalog()->CreateIndex("table-1", "index-1", index_keys, GetTxn(), index_info, "bptree");
+  ASSERT_EQ(DB_SUCCESS, r3);
+
+  // Execute insert plan, every row is inserted
+  TableInfo *table_info;
+  GetExecutorContext()->GetCatalog()->GetTable("table-1", table_info);
+  auto insert_plan = std::make_shared<InsertPlanNode>(nullptr, value_plan, "table-1");
+  std::vector<Row> result_set{};
+  GetExecutionEngine()->ExecutePlan(insert_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), row_count);
+  result_set.clear();
+
+  // SELECT id FROM table-1 WHERE id >= 1000;
+  const Schema *schema = table_info->GetSchema();
+  auto col_a = MakeColumnValueExpression(*schema, 0, "id");
+  auto const1000 = MakeConstantValueExpression(Field(kTypeInt, 1000));
+  auto predicate = MakeComparisonExpression(col_a, const1000, ">=");
+  auto out_schema = MakeOutputSchema({{"id", col_a}});
+  auto scan_plan = make_shared<SeqScanPlanNode>(out_schema, table_info->GetTableName(), predicate);
+  GetExecutionEngine()->ExecutePlan(scan_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), row_count);
+
+  // Every row is in the index
+  for (int i = 0; i < row_count; i++) {
+    std::vector<Field> fields{Field(kTypeInt, 1000 + i)};
+    std::vector<RowId> rids{};
+    index_info->GetIndex()->ScanKey(Row(fields), rids, GetTxn());
+    ASSERT_EQ(rids.size(), 1);
+  }
+}
+
+// INSERT INTO table-1 VALUES (1001, "aaa", 2.33), (1002, "aaa", 2.33), (1001, "aaa", 2.33), (1003, "aaa", 2.33);
+// INSERT INTO table-1 VALUES (1004, "aaa", 2.33), (500, "aaa", 2.33), (1005, "aaa", 2.33);
+TEST_F(ExecutorTest, DuplicateKeyInsertTest) {
+  // Create the index
+  IndexInfo *index_info = nullptr;
+  std::vector<std::string> index_keys{"id"};
+  auto r3 =
+      GetExecutorContext()->GetCatalog()->CreateIndex("table-1", "index-1", index_keys, GetTxn(), index_info, "bptree");
+  ASSERT_EQ(DB_SUCCESS, r3);
+
+  TableInfo *table_info;
+  GetExecutorContext()->GetCatalog()->GetTable("table-1", table_info);
+  auto insert = [&](const std::vector<int> &ids) {
+    std::vector<std::vector<AbstractExpressionRef>> raw_values{};
+    for (int id : ids) {
+      raw_values.push_back({MakeConstantValueExpression(Field(kTypeInt, id)),
+                            MakeConstantValueExpression(Field(kTypeChar, const_cast<char *>("aaa"), 3, false)),
+                            MakeConstantValueExpression(Field(kTypeFloat, static_cast<float>(2.33)))});
+    }
+    auto value_plan = std::make_shared<ValuesPlanNode>(nullptr, raw_values);
+    auto insert_plan = std::make_shared<InsertPlanNode>(nullptr, value_plan, "table-1");
+    std::vector<Row> result_set{};
+    GetExecutionEngine()->ExecutePlan(insert_plan, &result_set, GetTxn(), GetExecutorContext());
+    return result_set.size();
+  };
+  auto count = [&](int id) {
+    std::vector<Field> fields{Field(kTypeInt, id)};
+    std::vector<RowId> rids{};
+    index_info->GetIndex()->ScanKey(Row(fields), rids, GetTxn());
+    const Schema *schema = table_info->GetSchema();
+    auto col_a = MakeColumnValueExpression(*schema, 0, "id");
+    auto const_id = MakeConstantValueExpression(Field(kTypeInt, id));
+    auto predicate = MakeComparisonExpression(col_a, const_id, "=");
+    auto scan_plan = make_shared<SeqScanPlanNode>(schema, table_info->GetTableName(), predicate);
+    std::vector<Row> result_set{};
+    GetExecutionEngine()->ExecutePlan(scan_plan, &result_set, GetTxn(), GetExecutorContext());
+    EXPECT_EQ(rids.size(), result_set.size());
+    return result_set.size();
+  };
+
+  // A key twice in one statement, the insert stops at the second one
+  ASSERT_EQ(insert({1001, 1002, 1001, 1003}), 2);
+  ASSERT_EQ(count(1001), 1);
+  ASSERT_EQ(count(1002), 1);
+  ASSERT_EQ(count(1003), 0);
+
+  // A key of a row in the table, the insert stops at it
+  ASSERT_EQ(insert({1004, 500, 1005}), 1);
+  ASSERT_EQ(count(1004), 1);
+  ASSERT_EQ(count(500), 1);
+  ASSERT_EQ(count(1005), 0);
+}
+
 // UPDATE table-1 SET name = "minisql" where id = 500;
 TEST_F(ExecutorTest, SimpleUpdateTest) {
   // Construct a sequential scan of the table
@@ -155,3 +276,95 @@ TEST_F(ExecutorTest, SimpleUpdateTest) {
     ASSERT_TRUE(row.GetField(1)->CompareEquals(Field(kTypeChar, const_cast<char *>("minisql"), 7, false)));
   }
 }
+
+// DELETE and UPDATE on a database opened read-only are refused and leave the rows as they are
+TEST_F(ExecutorTest, ReadOnlyTest) {
+  ReopenReadOnly();
+  TableInfo *table_info;
+  ASSERT_EQ(DB_SUCCESS, GetExecutorContext()->GetCatalog()->GetTable("table-1", table_info));
+  const Schema *schema = table_info->GetSchema();
+  auto col_id = MakeColumnValueExpression(*schema, 0, "id");
+  auto const50 = MakeConstantValueExpression(Field(kTypeInt, 50));
+  auto predicate = MakeComparisonExpression(col_id, const50, "=");
+  auto scan_plan = std::make_shared<SeqScanPlanNode>(schema, table_info->GetTableName(), predicate);
+
+  // DELETE FROM table-1 WHERE id == 50
+  std::vector<Row> result_set;
+  auto delete_plan = std::make_shared<DeletePlanNode>(schema, scan_plan, table_info->GetTableName());
+  ASSERT_EQ(DB_FAILED, GetExecutionEngine()->ExecutePlan(delete_plan, &result_set, GetTxn(), GetExecutorContext()));
+
+  // UPDATE table-1 SET name = "minisql" where id = 50
+  std::unordered_map<uint32_t, AbstractExpressionRef> update_attrs{};
+  auto content = MakeConstantValueExpression(Field(kTypeChar, const_cast<char *>("minisql"), 7, false));
+  update_attrs.emplace(static_cast<uint32_t>(1), content);
+  auto update_plan = std::make_shared<UpdatePlanNode>(schema, scan_plan, "table-1", update_attrs);
+  ASSERT_EQ(DB_FAILED, GetExecutionEngine()->ExecutePlan(update_plan, &result_set, GetTxn(), GetExecutorContext()));
+
+  // the row is still there and unchanged
+  ASSERT_EQ(DB_SUCCESS, GetExecutionEngine()->ExecutePlan(scan_plan, &result_set, GetTxn(), GetExecutorContext()));
+  ASSERT_EQ(result_set.size(), 1);
+  ASSERT_FALSE(result_set[0].GetField(1)->CompareEquals(Field(kTypeChar, const_cast<char *>("minisql"), 7, false)));
+
+  // the table heap itself refuses to write the pages
+  ASSERT_FALSE(table_info->GetTableHeap()->MarkDelete(result_set[0].GetRowId(), GetTxn()));
+}
+
+// a database file this build cannot open does not keep the engine from opening the others
+TEST(ExecuteEngineTest, UnreadableDatabaseTest) {
+  const std::string bad_db = "./databases/executor_bad_test.db";
+  {
+    std::ofstream out(bad_db, std::ios::binary);
+    std::string meta_page(PAGE_SIZE, '\x01');
+    out.write(meta_page.data(), meta_page.size());
+  }
+  std::unique_ptr<ExecuteEngine> engine;
+  ASSERT_NO_THROW(engine = std::make_unique<ExecuteEngine>());
+  remove(bad_db.c_str());
+}
+
+// after VACUUM moved the rows, the index finds every row under its new rid
+TEST(ExecuteEngineTest, VacuumTest) {
+  const std::string db_name = "executor_vacuum_test";
+  remove(("./databases/" + db_name).c_str());
+  auto engine = std::make_unique<ExecuteEngine>();
+  ASSERT_EQ(DB_SUCCESS, ExecuteSql(*engine, "create database " + db_name + ";"));
+  ASSERT_EQ(DB_SUCCESS, ExecuteSql(*engine, "use " + db_name + ";"));
+  ASSERT_EQ(DB_SUCCESS, ExecuteSql(*engine, "create table t(id int, name char(16), primary key(id));"));
+  for (int i = 0; i < 1000; i++) {
+    auto sql = "insert into t values(" + std::to_string(i) + ", \"name-" + std::to_string(i) + "\");";
+    ASSERT_EQ(DB_SUCCESS, ExecuteSql(*engine, sql));
+  }
+  ASSERT_EQ(DB_SUCCESS, ExecuteSql(*engine, "delete from t where id < 900;"));
+  ASSERT_EQ(DB_SUCCESS, ExecuteSql(*engine, "vacuum t;"));
+  engine.reset();
+
+  // reopen the database to check what reached the file
+  auto db = std::make_unique<DBStorageEngine>(db_name, false);
+  TableInfo *table_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, db->catalog_mgr_->GetTable("t", table_info));
+  std::vector<IndexInfo *> indexes;
+  ASSERT_EQ(DB_SUCCESS, db->catalog_mgr_->GetTableIndexes("t", indexes));
+  ASSERT_FALSE(indexes.empty());
+  auto table_heap = table_info->GetTableHeap();
+  size_t rows = 0;
+  size_t rows_on_first_page = 0;
+  for (auto it = table_heap->Begin(nullptr); it != table_heap->End(); ++it) {
+    rows++;
+    if (it->GetRowId().GetPageId() == table_heap->GetFirstPageId()) {
+      rows_on_first_page++;
+    }
+    for (auto index : indexes) {
+      Row key_row;
+      it->GetKeyFromRow(table_info->GetSchema(), index->GetIndexKeySchema(), key_row);
+      std::vector<RowId> result;
+      ASSERT_EQ(DB_SUCCESS, index->GetIndex()->ScanKey(key_row, result, nullptr));
+      ASSERT_EQ(1, result.size());
+      ASSERT_EQ(it->GetRowId(), result[0]);
+    }
+  }
+  ASSERT_EQ(100, rows);
+  // the rows left on the last pages moved to the front
+  ASSERT_EQ(100, rows_on_first_page);
+  db.reset();
+  remove(("./databases/" + db_name).c_str());
+}
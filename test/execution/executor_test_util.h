@@ -36,6 +36,11 @@ class ExecutorTest : public ::testing::Test {
   void SetUp() override {
     ::testing::Test::SetUp();
 
+    // Construct the executor engine for the test, before the test database is created, since the engine opens every
+    // database it finds
+    remove("./databases/executor_test.db");
+    execution_engine_ = std::make_unique<ExecuteEngine>();
+
     // Initialize the database subsystems
     db_test_ = new DBStorageEngine("executor_test.db", true);
     auto &catalog_01 = db_test_->catalog_mgr_;
@@ -59,14 +64,20 @@ class ExecutorTest : public ::testing::Test {
     }
     // Create an executor context for our executors
     exec_ctx_ = std::make_unique<ExecuteContext>(txn_, db_test_->catalog_mgr_, db_test_->bpm_);
-
-    // Construct the executor engine for the test
-    execution_engine_ = std::make_unique<ExecuteEngine>();
   }
 
   /** Called after every executor test. */
   void TearDown() override { delete db_test_; };
 
+  /** Close the test database and open it again with the file mapped read-only. */
+  void ReopenReadOnly() {
+    exec_ctx_.reset();
+    delete db_test_;
+    db_test_ = new DBStorageEngine("executor_test.db", false, DEFAULT_BUFFER_POOL_SIZE, DEFAULT_BUFFER_POOL_INSTANCES,
+                                   ReplacerType::kLRU, false, true);
+    exec_ctx_ = std::make_unique<ExecuteContext>(txn_, db_test_->catalog_mgr_, db_test_->bpm_);
+  }
+
   /** @return The executor context for our test instance. */
   ExecuteContext *GetExecutorContext() { return exec_ctx_.get(); }
 
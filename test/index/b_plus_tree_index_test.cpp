@@ -27,6 +27,78 @@ TEST(BPlusTreeTests, BPlusTreeIndexGenericKeyTest) {
   ASSERT_EQ(0, KP.CompareKeys(k1, k2));
 }
 
+TEST(BPlusTreeTests, NormalizedKeyTest) {
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, true, false),
+                                   new Column("account", TypeId::kTypeFloat, 1, true, false),
+                                   new Column("name", TypeId::kTypeChar, 8, 2, true, false)};
+  const TableSchema compact_schema(columns);
+  auto *compact_key_schema = Schema::ShallowCopySchema(&compact_schema, {0, 1, 2});
+  KeyManager compact_km(compact_key_schema, 32);
+  ASSERT_EQ(5 + 5 + 11, KeyManager::GetNormalizedKeySize(compact_key_schema));
+  std::vector<int32_t> ints{INT32_MIN, -65537, -1, 0, 1, 188, INT32_MAX};
+  std::vector<float> floats{-1e30f, -2.5f, -0.0f, 0.0f, 1e-10f, 19.99f, 1e30f};
+  std::vector<std::string> names{"", "a", std::string("a\0", 2), "ab", "b", "zzzzzzzz"};
+  auto make_row = [&](int i, int f, int n) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, ints[i]), Field(TypeId::kTypeFloat, floats[f]),
+                              Field(TypeId::kTypeChar, const_cast<char *>(names[n].data()), names[n].size(), true)};
+    return Row(fields);
+  };
+  auto sign = [](int x) { return (x > 0) - (x < 0); };
+  // the order of the fields, nulls are not generated here
+  auto compare_rows = [](const Row &lhs_row, const Row &rhs_row) {
+    for (uint32_t i = 0; i < lhs_row.GetFieldCount(); i++) {
+      if (lhs_row.GetField(i)->CompareLessThan(*rhs_row.GetField(i)) == CmpBool::kTrue) {
+        return -1;
+      }
+      if (lhs_row.GetField(i)->CompareGreaterThan(*rhs_row.GetField(i)) == CmpBool::kTrue) {
+        return 1;
+      }
+    }
+    return 0;
+  };
+  GenericKey *lhs = compact_km.InitKey();
+  GenericKey *rhs = compact_km.InitKey();
+  // the bytes of normalized keys sort like the fields
+  for (int round = 0; round < 5000; round++) {
+    int a[3] = {rand() % 7, rand() % 7, rand() % 6};
+    int b[3] = {rand() % 7, rand() % 7, rand() % 6};
+    // share a prefix of the columns now and then
+    for (int i = 0; i < 3 && rand() % 2 == 0; i++) {
+      b[i] = a[i];
+    }
+    Row lhs_row = make_row(a[0], a[1], a[2]);
+    Row rhs_row = make_row(b[0], b[1], b[2]);
+    compact_km.SerializeFromKey(lhs, lhs_row, compact_key_schema);
+    compact_km.SerializeFromKey(rhs, rhs_row, compact_key_schema);
+    ASSERT_EQ(compare_rows(lhs_row, rhs_row), sign(compact_km.CompareKeys(lhs, rhs)));
+  }
+  // a key decodes to its fields
+  Row row = make_row(1, 0, 2);
+  compact_km.SerializeFromKey(lhs, row, compact_key_schema);
+  Row decoded;
+  compact_km.DeserializeToKey(lhs, decoded, compact_key_schema);
+  ASSERT_EQ(3, decoded.GetFieldCount());
+  for (uint32_t i = 0; i < 3; i++) {
+    ASSERT_EQ(CmpBool::kTrue, decoded.GetField(i)->CompareEquals(*row.GetField(i)));
+  }
+  // nulls sort first
+  std::vector<Field> null_fields{Field(TypeId::kTypeInt, INT32_MIN), Field(TypeId::kTypeFloat),
+                                 Field(TypeId::kTypeChar)};
+  Row null_row(null_fields);
+  compact_km.SerializeFromKey(rhs, null_row, compact_key_schema);
+  compact_km.SerializeFromKey(lhs, make_row(0, 0, 0), compact_key_schema);
+  ASSERT_GT(compact_km.CompareKeys(lhs, rhs), 0);
+  Row decoded_null;
+  compact_km.DeserializeToKey(rhs, decoded_null, compact_key_schema);
+  ASSERT_FALSE(decoded_null.GetField(0)->IsNull());
+  ASSERT_TRUE(decoded_null.GetField(1)->IsNull());
+  ASSERT_TRUE(decoded_null.GetField(2)->IsNull());
+  for (auto key : {lhs, rhs}) {
+    free(key);
+  }
+  delete compact_key_schema;
+}
+
 TEST(BPlusTreeTests, BPlusTreeIndexSimpleTest) {
   auto disk_mgr_ = new DiskManager(db_name);
   auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
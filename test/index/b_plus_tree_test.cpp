@@ -1,8 +1,18 @@
 #include "index/b_plus_tree.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <thread>
+
 #include "common/instance.h"
 #include "gtest/gtest.h"
 #include "index/comparator.h"
+#include "index/key_sorter.h"
+#include "page/index_roots_page.h"
 #include "utils/tree_file_mgr.h"
 #include "utils/utils.h"
 
@@ -197,4 +207,628 @@ TEST(BPlusTreeTests, DeletaAllTest) {
   for (int i = 0; i < n; i++) {
     ASSERT_FALSE(tree.GetValue(delete_seq[i], ans));
   }
-}
\ No newline at end of file
+}
+
+TEST(BPlusTreeTests, IndexBenchmark) {
+  // Init engine
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {
+      new Column("int", TypeId::kTypeInt, 0, false, false),
+  };
+  Schema *table_schema = new Schema(columns);
+  // wide keys, as the fan-out of a page is what the page size changes
+  KeyManager KP(table_schema, 64);
+  BPlusTree tree(0, engine.bpm_, KP);
+  // Prepare data
+  const int n = 2e4;
+  vector<GenericKey *> keys;
+  for (int i = 0; i < n; i++) {
+    GenericKey *key = KP.InitKey();
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    KP.SerializeFromKey(key, Row(fields), table_schema);
+    keys.push_back(key);
+  }
+  ShuffleArray(keys);
+  // Insert data
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(tree.Insert(keys[i], RowId(i)));
+  }
+  auto insert_duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  // Search keys
+  vector<RowId> ans;
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(tree.GetValue(keys[i], ans));
+  }
+  auto lookup_duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  LOG(INFO) << "page size: " << PAGE_SIZE << ", insert throughput: " << static_cast<int64_t>(n / insert_duration)
+            << " keys/s, lookup throughput: " << static_cast<int64_t>(n / lookup_duration) << " keys/s";
+  ASSERT_TRUE(tree.Check());
+  for (auto key : keys) {
+    free(key);
+  }
+}
+
+TEST(BPlusTreeTests, KeyComparatorBenchmark) {
+  DBStorageEngine engine(db_name);
+  const int n = 2e4;
+  // keys of an int and a char column, compared as normalized bytes
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 16, 1, false, false)};
+  Schema *key_schema = new Schema(columns);
+  KeyManager KP(key_schema, 32);
+  BPlusTree tree(0, engine.bpm_, KP);
+  vector<GenericKey *> keys;
+  for (int i = 0; i < n; i++) {
+    GenericKey *key = KP.InitKey();
+    std::string name = "name-" + std::to_string(i % 100);
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i / 100),
+                              Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), false)};
+    KP.SerializeFromKey(key, Row(fields), key_schema);
+    keys.push_back(key);
+  }
+  ShuffleArray(keys);
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(tree.Insert(keys[i], RowId(i)));
+  }
+  auto insert_duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  vector<RowId> ans;
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(tree.GetValue(keys[i], ans));
+    ASSERT_EQ(RowId(i), ans.back());
+  }
+  auto lookup_duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  LOG(INFO) << "insert throughput: " << static_cast<int64_t>(n / insert_duration)
+            << " keys/s, lookup throughput: " << static_cast<int64_t>(n / lookup_duration) << " keys/s";
+  ASSERT_TRUE(tree.Check());
+  tree.Destroy();
+  for (auto key : keys) {
+    free(key);
+  }
+  delete key_schema;
+}
+
+TEST(BPlusTreeTests, IntKeySearchBenchmark) {
+  std::vector<Column *> columns = {new Column("int", TypeId::kTypeInt, 0, true, false)};
+  Schema *key_schema = new Schema(columns);
+  KeyManager int_km(key_schema, 16);
+  KeyManager generic_km(key_schema, 16, KeyKind::kGeneric);
+  ASSERT_EQ(KeyKind::kInt32, int_km.GetKeyKind());
+  // a full leaf of even keys, some negative, with a null key first
+  auto leaf = reinterpret_cast<LeafPage *>(new char[PAGE_SIZE]);
+  int max_size = (PAGE_USABLE_SIZE - LEAF_PAGE_HEADER_SIZE) / (int_km.GetKeySize() + sizeof(RowId));
+  leaf->Init(0, INVALID_PAGE_ID, int_km.GetKeySize(), max_size);
+  GenericKey *key = int_km.InitKey();
+  for (int i = 0; i < max_size; i++) {
+    std::vector<Field> fields{i == 0 ? Field(TypeId::kTypeInt) : Field(TypeId::kTypeInt, 2 * (i - max_size / 2))};
+    int_km.SerializeFromKey(key, Row(fields), key_schema);
+    leaf->SetKeyAt(i, key);
+    leaf->SetValueAt(i, RowId(i));
+  }
+  leaf->SetSize(max_size);
+  // both searches agree on keys in the leaf, between its keys and outside of it
+  const char *pairs = reinterpret_cast<const char *>(leaf->KeyAt(0));
+  size_t stride = int_km.GetKeySize() + sizeof(RowId);
+  vector<GenericKey *> targets;
+  for (int i = -max_size - 2; i <= max_size + 2; i++) {
+    GenericKey *target = int_km.InitKey();
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    int_km.SerializeFromKey(target, Row(fields), key_schema);
+    targets.push_back(target);
+    ASSERT_EQ(generic_km.LowerBound(pairs, max_size, stride, target), int_km.LowerBound(pairs, max_size, stride, target));
+    ASSERT_EQ(generic_km.UpperBound(pairs, max_size, stride, target), int_km.UpperBound(pairs, max_size, stride, target));
+  }
+  std::vector<Field> null_fields{Field(TypeId::kTypeInt)};
+  int_km.SerializeFromKey(key, Row(null_fields), key_schema);
+  ASSERT_EQ(0, leaf->KeyIndex(key, int_km));
+  ASSERT_EQ(0, leaf->KeyIndex(key, generic_km));
+  // node search throughput
+  const int rounds = 1000000;
+  for (auto km : {&generic_km, &int_km}) {
+    int64_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+      sum += leaf->KeyIndex(targets[i % targets.size()], *km);
+    }
+    auto duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    ASSERT_GT(sum, 0);
+    LOG(INFO) << (km == &int_km ? "int32" : "generic") << " search in a leaf of " << max_size
+              << " keys: " << static_cast<int64_t>(rounds / duration) << " searches/s";
+  }
+  // the same keys in whole trees
+  DBStorageEngine engine(db_name);
+  const int n = 1e5;
+  vector<GenericKey *> keys;
+  for (int i = 0; i < n; i++) {
+    GenericKey *tree_key = int_km.InitKey();
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i - n / 2)};
+    int_km.SerializeFromKey(tree_key, Row(fields), key_schema);
+    keys.push_back(tree_key);
+  }
+  ShuffleArray(keys);
+  for (auto km : {&generic_km, &int_km}) {
+    BPlusTree tree(km == &int_km ? 1 : 0, engine.bpm_, *km);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++) {
+      ASSERT_TRUE(tree.Insert(keys[i], RowId(i)));
+    }
+    auto insert_duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    vector<RowId> ans;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++) {
+      ASSERT_TRUE(tree.GetValue(keys[i], ans));
+      ASSERT_EQ(RowId(i), ans.back());
+    }
+    auto lookup_duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    LOG(INFO) << (km == &int_km ? "int32" : "generic") << " tree, insert throughput: "
+              << static_cast<int64_t>(n / insert_duration)
+              << " keys/s, lookup throughput: " << static_cast<int64_t>(n / lookup_duration) << " keys/s";
+    ASSERT_TRUE(tree.Check());
+    tree.Destroy();
+  }
+  for (auto k : keys) {
+    free(k);
+  }
+  for (auto k : targets) {
+    free(k);
+  }
+  free(key);
+  delete[] reinterpret_cast<char *>(leaf);
+  delete key_schema;
+}
+
+TEST(BPlusTreeTests, ConcurrentStressTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("int", TypeId::kTypeInt, 0, false, false)};
+  Schema *key_schema = new Schema(columns);
+  KeyManager KP(key_schema, 16);
+  // small pages, so that nearly every operation splits or merges somewhere
+  BPlusTree tree(0, engine.bpm_, KP, 8, 8);
+  const int n = 4e4;
+  const int num_threads = 8;
+  vector<GenericKey *> keys;
+  for (int i = 0; i < n; i++) {
+    GenericKey *key = KP.InitKey();
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    KP.SerializeFromKey(key, Row(fields), key_schema);
+    keys.push_back(key);
+  }
+  // every thread owns the keys i % num_threads == t and visits them in its own order
+  auto run = [&](const std::function<void(int, const vector<int> &, std::atomic<int> &)> &work) {
+    std::atomic<int> failures{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+      threads.emplace_back([&, t] {
+        vector<int> owned;
+        for (int i = t; i < n; i += num_threads) {
+          owned.push_back(i);
+        }
+        std::shuffle(owned.begin(), owned.end(), std::mt19937(t));
+        work(t, owned, failures);
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    return failures.load();
+  };
+  // concurrent inserts, every key is found right after its insert, and so is one inserted before
+  ASSERT_EQ(0, run([&](int, const vector<int> &owned, std::atomic<int> &failures) {
+    vector<RowId> ans;
+    for (size_t j = 0; j < owned.size(); j++) {
+      ans.clear();
+      int earlier = owned[j / 2];
+      if (!tree.Insert(keys[owned[j]], RowId(owned[j])) || !tree.GetValue(keys[owned[j]], ans) ||
+          !tree.GetValue(keys[earlier], ans) || !(ans[1] == RowId(earlier))) {
+        failures++;
+      }
+    }
+  }));
+  ASSERT_TRUE(tree.Check());
+  // concurrent removes of the odd keys, the even keys of all threads stay visible and cannot be inserted again
+  ASSERT_EQ(0, run([&](int t, const vector<int> &owned, std::atomic<int> &failures) {
+    std::mt19937 rng(t);
+    vector<RowId> ans;
+    for (int i : owned) {
+      if (i % 2 == 1) {
+        tree.Remove(keys[i]);
+        ans.clear();
+        if (tree.GetValue(keys[i], ans)) {
+          failures++;
+        }
+      }
+      int even = 2 * static_cast<int>(rng() % (n / 2));
+      ans.clear();
+      if (!tree.GetValue(keys[even], ans) || !(ans[0] == RowId(even)) || tree.Insert(keys[even], RowId(0))) {
+        failures++;
+      }
+    }
+  }));
+  ASSERT_TRUE(tree.Check());
+  vector<RowId> ans;
+  for (int i = 0; i < n; i++) {
+    ASSERT_EQ(i % 2 == 0, tree.GetValue(keys[i], ans));
+  }
+  // concurrent inserts of the odd keys and removes of the even ones empty half of the tree and refill the other
+  ASSERT_EQ(0, run([&](int, const vector<int> &owned, std::atomic<int> &failures) {
+    for (int i : owned) {
+      if (i % 2 == 0) {
+        tree.Remove(keys[i]);
+      } else if (!tree.Insert(keys[i], RowId(i))) {
+        failures++;
+      }
+    }
+  }));
+  ASSERT_TRUE(tree.Check());
+  for (int i = 0; i < n; i++) {
+    ans.clear();
+    ASSERT_EQ(i % 2 == 1, tree.GetValue(keys[i], ans));
+  }
+  // and all keys are removed concurrently
+  ASSERT_EQ(0, run([&](int, const vector<int> &owned, std::atomic<int> &) {
+    for (int i : owned) {
+      tree.Remove(keys[i]);
+    }
+  }));
+  ASSERT_TRUE(tree.IsEmpty());
+  ASSERT_TRUE(tree.Check());
+  for (auto key : keys) {
+    free(key);
+  }
+  delete key_schema;
+}
+
+TEST(BPlusTreeTests, ConcurrentScalingBenchmark) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("int", TypeId::kTypeInt, 0, false, false)};
+  Schema *key_schema = new Schema(columns);
+  KeyManager KP(key_schema, 16);
+  BPlusTree tree(0, engine.bpm_, KP);
+  const int n = 1e5;
+  const int ops = 2e5;
+  const int max_threads = 8;
+  // the first n keys are loaded up front, the others are inserted by the benchmark
+  vector<GenericKey *> keys;
+  for (int i = 0; i < n + ops * 4; i++) {
+    GenericKey *key = KP.InitKey();
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    KP.SerializeFromKey(key, Row(fields), key_schema);
+    keys.push_back(key);
+  }
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(tree.Insert(keys[i], RowId(i)));
+  }
+  // every thread runs ops / num_threads operations, one insert of a new key for every four lookups
+  int next_key = n;
+  for (int num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+    int per_thread = ops / num_threads;
+    std::atomic<int> failures{0};
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < num_threads; t++) {
+      threads.emplace_back([&, t] {
+        std::mt19937 rng(t);
+        vector<RowId> ans;
+        for (int j = 0; j < per_thread; j++) {
+          bool ok;
+          if (j % 5 == 0) {
+            int i = next_key + t * per_thread + j;
+            ok = tree.Insert(keys[i], RowId(i));
+          } else {
+            ans.clear();
+            int i = static_cast<int>(rng() % n);
+            ok = tree.GetValue(keys[i], ans) && ans[0] == RowId(i);
+          }
+          if (!ok) {
+            failures++;
+          }
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    auto duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    next_key += num_threads * per_thread;
+    ASSERT_EQ(0, failures.load());
+    LOG(INFO) << num_threads << " threads: " << static_cast<int64_t>(num_threads * per_thread / duration)
+              << " ops/s (" << std::thread::hardware_concurrency() << " hardware threads)";
+  }
+  ASSERT_TRUE(tree.Check());
+  for (auto key : keys) {
+    free(key);
+  }
+  delete key_schema;
+}
+
+TEST(BPlusTreeTests, OptimisticReadTest) {
+  DBStorageEngine engine(db_name);
+  // the version of a page is odd while it is write latched, read latches leave it alone
+  page_id_t page_id;
+  Page *page = engine.bpm_->NewPage(page_id);
+  uint64_t version = page->GetVersion();
+  ASSERT_EQ(0, version % 2);
+  {
+    ReadPageGuard guard = engine.bpm_->FetchPageRead(page_id);
+    ASSERT_TRUE(page->ValidateVersion(version));
+  }
+  {
+    WritePageGuard guard = engine.bpm_->FetchPageWrite(page_id);
+    ASSERT_EQ(version + 1, page->GetVersion());
+    ASSERT_FALSE(page->ValidateVersion(page->GetVersion()));
+  }
+  ASSERT_FALSE(page->ValidateVersion(version));
+  ASSERT_EQ(version + 2, page->GetVersion());
+  engine.bpm_->UnpinPage(page_id, false);
+  // readers always find the keys i % 4 == 0 while writers keep inserting and removing the keys around them
+  std::vector<Column *> columns = {new Column("int", TypeId::kTypeInt, 0, false, false)};
+  Schema *key_schema = new Schema(columns);
+  KeyManager KP(key_schema, 16);
+  BPlusTree tree(0, engine.bpm_, KP, 8, 8);
+  const int n = 2e4;
+  const int num_readers = 4;
+  const int num_writers = 3;
+  const int rounds = 3;
+  vector<GenericKey *> keys;
+  for (int i = 0; i < n; i++) {
+    GenericKey *key = KP.InitKey();
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    KP.SerializeFromKey(key, Row(fields), key_schema);
+    keys.push_back(key);
+    if (i % 4 == 0) {
+      ASSERT_TRUE(tree.Insert(key, RowId(i)));
+    }
+  }
+  std::atomic<int> writers_left{num_writers};
+  std::atomic<int> failures{0};
+  std::atomic<int64_t> reads{0};
+  std::vector<std::thread> threads;
+  for (int w = 0; w < num_writers; w++) {
+    threads.emplace_back([&, w] {
+      for (int round = 0; round < rounds; round++) {
+        for (int i = w + 1; i < n; i += 4) {
+          failures += !tree.Insert(keys[i], RowId(i));
+        }
+        for (int i = w + 1; i < n; i += 4) {
+          tree.Remove(keys[i]);
+        }
+      }
+      writers_left--;
+    });
+  }
+  for (int r = 0; r < num_readers; r++) {
+    threads.emplace_back([&, r] {
+      std::mt19937 rng(r);
+      vector<RowId> ans;
+      while (writers_left.load() > 0) {
+        int i = 4 * static_cast<int>(rng() % (n / 4));
+        ans.clear();
+        if (!tree.GetValue(keys[i], ans) || !(ans[0] == RowId(i)) || tree.Begin(keys[i]) == tree.End()) {
+          failures++;
+        }
+        reads++;
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(0, failures.load());
+  ASSERT_GT(reads.load(), 0);
+  ASSERT_TRUE(tree.Check());
+  vector<RowId> ans;
+  for (int i = 0; i < n; i++) {
+    ASSERT_EQ(i % 4 == 0, tree.GetValue(keys[i], ans));
+  }
+  for (auto key : keys) {
+    free(key);
+  }
+  delete key_schema;
+}
+
+TEST(BPlusTreeTests, ConcurrentReadBenchmark) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("int", TypeId::kTypeInt, 0, false, false)};
+  Schema *key_schema = new Schema(columns);
+  KeyManager KP(key_schema, 16);
+  BPlusTree tree(0, engine.bpm_, KP);
+  const int n = 1e5;
+  const int ops = 4e5;
+  const int max_threads = 8;
+  vector<GenericKey *> keys;
+  for (int i = 0; i < n; i++) {
+    GenericKey *key = KP.InitKey();
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    KP.SerializeFromKey(key, Row(fields), key_schema);
+    keys.push_back(key);
+    ASSERT_TRUE(tree.Insert(key, RowId(i)));
+  }
+  // lookups with read latch coupling and with page versions, by ever more threads
+  for (bool optimistic : {false, true}) {
+    tree.SetOptimisticReads(optimistic);
+    for (int num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+      int per_thread = ops / num_threads;
+      std::atomic<int> failures{0};
+      std::vector<std::thread> threads;
+      auto start = std::chrono::steady_clock::now();
+      for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t] {
+          std::mt19937 rng(t);
+          vector<RowId> ans;
+          for (int j = 0; j < per_thread; j++) {
+            ans.clear();
+            int i = static_cast<int>(rng() % n);
+            if (!tree.GetValue(keys[i], ans) || !(ans[0] == RowId(i))) {
+              failures++;
+            }
+          }
+        });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      auto duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      ASSERT_EQ(0, failures.load());
+      LOG(INFO) << (optimistic ? "versioned" : "latched") << " lookups, " << num_threads << " threads: "
+                << static_cast<int64_t>(num_threads * per_thread / duration) << " lookups/s ("
+                << std::thread::hardware_concurrency() << " hardware threads)";
+    }
+  }
+  ASSERT_TRUE(tree.Check());
+  for (auto key : keys) {
+    free(key);
+  }
+  delete key_schema;
+}
+
+TEST(BPlusTreeTests, BulkLoadTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("int", TypeId::kTypeInt, 0, false, false)};
+  Schema *key_schema = new Schema(columns);
+  KeyManager KP(key_schema, 16);
+  const int max_size = 8;
+  // every node but the root is at least half full and knows its parent, returns the number of leaves below
+  std::function<int(page_id_t, page_id_t)> check_node = [&](page_id_t page_id, page_id_t parent_id) {
+    auto *page = reinterpret_cast<BPlusTreePage *>(engine.bpm_->FetchPage(page_id)->GetData());
+    EXPECT_EQ(parent_id, page->GetParentPageId());
+    EXPECT_LE(page->GetSize(), max_size);
+    if (parent_id != INVALID_PAGE_ID) {
+      EXPECT_GE(page->GetSize(), page->GetMinSize());
+    }
+    int leaf_count = 1;
+    if (!page->IsLeafPage()) {
+      auto *internal_page = reinterpret_cast<InternalPage *>(page);
+      leaf_count = 0;
+      for (int i = 0; i < internal_page->GetSize(); i++) {
+        leaf_count += check_node(internal_page->ValueAt(i), page_id);
+      }
+    }
+    engine.bpm_->UnpinPage(page_id, false);
+    return leaf_count;
+  };
+  index_id_t index_id = 0;
+  // trees of a single leaf, of two levels and of several
+  for (int n : {0, 1, 8, 9, 100, 5000}) {
+    for (double fill_factor : {1.0, 0.7}) {
+      BPlusTree tree(index_id, engine.bpm_, KP, max_size, max_size);
+      // the even keys are loaded, the odd ones inserted afterwards
+      vector<GenericKey *> keys;
+      for (int i = 0; i < 2 * n; i++) {
+        GenericKey *key = KP.InitKey();
+        std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+        KP.SerializeFromKey(key, Row(fields), key_schema);
+        keys.push_back(key);
+      }
+      int next = 0;
+      auto load = [&](GenericKey *key, RowId *value) {
+        if (next == n) {
+          return false;
+        }
+        memcpy(key, keys[2 * next], KP.GetKeySize());
+        *value = RowId(2 * next++);
+        return true;
+      };
+      ASSERT_TRUE(tree.BulkLoad(load, fill_factor));
+      ASSERT_EQ(n == 0, tree.IsEmpty());
+      ASSERT_TRUE(tree.Check());
+      if (n > 0) {
+        page_id_t root_id;
+        auto *roots_page = reinterpret_cast<IndexRootsPage *>(engine.bpm_->FetchPage(INDEX_ROOTS_PAGE_ID)->GetData());
+        ASSERT_TRUE(roots_page->GetRootId(index_id, &root_id));
+        engine.bpm_->UnpinPage(INDEX_ROOTS_PAGE_ID, false);
+        int leaf_count = check_node(root_id, INVALID_PAGE_ID);
+        if (fill_factor == 1.0) {
+          ASSERT_EQ((n + max_size - 1) / max_size, leaf_count);
+        }
+      }
+      int count = 0;
+      for (auto it = tree.Begin(); it != tree.End(); ++it) {
+        ASSERT_EQ(RowId(2 * count++), (*it).second);
+      }
+      ASSERT_EQ(n, count);
+      vector<RowId> ans;
+      for (int i = 0; i < n; i++) {
+        ASSERT_TRUE(tree.GetValue(keys[2 * i], ans));
+        ASSERT_EQ(RowId(2 * i), ans.back());
+      }
+      // a loaded tree takes inserts and removes like any other, but is not loaded twice
+      for (int i = 0; i < n; i++) {
+        ASSERT_TRUE(tree.Insert(keys[2 * i + 1], RowId(2 * i + 1)));
+      }
+      ASSERT_EQ(n > 0, !tree.BulkLoad([](GenericKey *, RowId *) { return false; }));
+      count = 0;
+      for (auto it = tree.Begin(); it != tree.End(); ++it) {
+        ASSERT_EQ(RowId(count++), (*it).second);
+      }
+      ASSERT_EQ(2 * n, count);
+      ShuffleArray(keys);
+      for (auto key : keys) {
+        tree.Remove(key);
+      }
+      ASSERT_TRUE(tree.IsEmpty());
+      ASSERT_TRUE(tree.Check());
+      for (auto key : keys) {
+        free(key);
+      }
+      index_id++;
+    }
+  }
+  delete key_schema;
+}
+
+TEST(BPlusTreeTests, BulkLoadBenchmark) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("int", TypeId::kTypeInt, 0, false, false)};
+  Schema *key_schema = new Schema(columns);
+  KeyManager KP(key_schema, 16);
+  const int n = 1e5;
+  vector<int> ids(n);
+  std::iota(ids.begin(), ids.end(), 0);
+  std::shuffle(ids.begin(), ids.end(), std::mt19937(42));
+  GenericKey *key = KP.InitKey();
+  auto serialize = [&](int id) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, id)};
+    KP.SerializeFromKey(key, Row(fields), key_schema);
+  };
+  // the keys in table order inserted one by one, and sorted then loaded bottom-up, in memory and spilled to disk
+  double insert_duration;
+  {
+    auto start = std::chrono::steady_clock::now();
+    BPlusTree tree(0, engine.bpm_, KP);
+    for (int id : ids) {
+      serialize(id);
+      ASSERT_TRUE(tree.Insert(key, RowId(id)));
+    }
+    insert_duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    tree.Destroy();
+  }
+  index_id_t index_id = 1;
+  for (size_t memory_limit : {INDEX_SORT_MEMORY, static_cast<size_t>(1024 * 1024)}) {
+    auto start = std::chrono::steady_clock::now();
+    BPlusTree tree(index_id++, engine.bpm_, KP);
+    KeySorter sorter(KP, memory_limit);
+    for (int id : ids) {
+      serialize(id);
+      sorter.Add(key, RowId(id));
+    }
+    sorter.Sort();
+    ASSERT_TRUE(tree.BulkLoad([&](GenericKey *entry_key, RowId *value) { return sorter.Next(entry_key, value); }));
+    auto bulk_duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    LOG(INFO) << n << " keys, inserted one by one: " << static_cast<int64_t>(insert_duration * 1000)
+              << " ms, sorted in " << sorter.GetRunCount() << " runs and bulk loaded: "
+              << static_cast<int64_t>(bulk_duration * 1000) << " ms";
+    ASSERT_TRUE(tree.Check());
+    vector<RowId> ans;
+    for (int i = 0; i < n; i += 997) {
+      serialize(i);
+      ASSERT_TRUE(tree.GetValue(key, ans));
+      ASSERT_EQ(RowId(i), ans.back());
+    }
+    tree.Destroy();
+  }
+  free(key);
+  delete key_schema;
+}
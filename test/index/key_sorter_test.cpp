@@ -0,0 +1,60 @@
+#include "index/key_sorter.h"
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+TEST(KeySorterTest, SortTest) {
+  const int n = 10000;
+  std::vector<int> ids(n);
+  std::iota(ids.begin(), ids.end(), 0);
+  std::shuffle(ids.begin(), ids.end(), std::mt19937(42));
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false)};
+  Schema key_schema(columns);
+  KeyManager KP(&key_schema, 16);
+  // sorted in memory, and spilled to many runs which are merged
+  for (size_t memory_limit : {INDEX_SORT_MEMORY, static_cast<size_t>(4096)}) {
+    KeySorter sorter(KP, memory_limit);
+    GenericKey *key = KP.InitKey();
+    // every key is added twice, the copy added first has the row id of the key
+    for (int round = 0; round < 2; round++) {
+      for (int id : ids) {
+        std::vector<Field> fields{Field(TypeId::kTypeInt, id)};
+        KP.SerializeFromKey(key, Row(fields), &key_schema);
+        sorter.Add(key, RowId(round * n + id));
+      }
+    }
+    sorter.Sort();
+    if (memory_limit == INDEX_SORT_MEMORY) {
+      ASSERT_EQ(0, sorter.GetRunCount());
+    } else {
+      ASSERT_GT(sorter.GetRunCount(), 10);
+    }
+    RowId value;
+    for (int i = 0; i < n; i++) {
+      ASSERT_TRUE(sorter.Next(key, &value));
+      Row row;
+      KP.DeserializeToKey(key, row, &key_schema);
+      ASSERT_EQ(CmpBool::kTrue, row.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, i)));
+      ASSERT_EQ(RowId(i), value);
+    }
+    ASSERT_FALSE(sorter.Next(key, &value));
+    ASSERT_EQ(n, sorter.GetDuplicateCount());
+    free(key);
+  }
+}
+
+TEST(KeySorterTest, EmptyTest) {
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false)};
+  Schema key_schema(columns);
+  KeyManager KP(&key_schema, 16);
+  KeySorter sorter(KP);
+  sorter.Sort();
+  GenericKey *key = KP.InitKey();
+  RowId value;
+  ASSERT_FALSE(sorter.Next(key, &value));
+  free(key);
+}
@@ -1,10 +1,13 @@
+#include <chrono>
 #include <cstring>
+#include <memory>
 
 #include "common/instance.h"
 #include "gtest/gtest.h"
 #include "page/table_page.h"
 #include "record/field.h"
 #include "record/row.h"
+#include "record/row_view.h"
 #include "record/schema.h"
 
 char *chars[] = {const_cast<char *>(""), const_cast<char *>("hello"), const_cast<char *>("world!"),
@@ -194,4 +197,133 @@ TEST(TupleTest, RowTest) {
   }
   ASSERT_TRUE(table_page.MarkDelete(row.GetRowId(), nullptr, nullptr, nullptr));
   table_page.ApplyDelete(row.GetRowId(), nullptr, nullptr);
-}
\ No newline at end of file
+}
+
+TEST(TupleTest, RowViewTest) {
+  char buffer[PAGE_SIZE];
+  memset(buffer, 0, sizeof(buffer));
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false),
+                                   new Column("nick", TypeId::kTypeChar, 64, 2, true, false),
+                                   new Column("account", TypeId::kTypeFloat, 3, true, false)};
+  std::vector<Field> fields = {Field(TypeId::kTypeInt, 188),
+                               Field(TypeId::kTypeChar, const_cast<char *>("minisql"), strlen("minisql"), false),
+                               Field(TypeId::kTypeChar), Field(TypeId::kTypeFloat, 19.99f)};
+  auto schema = std::make_shared<Schema>(columns);
+  Row row(fields);
+  row.SerializeTo(buffer, schema.get());
+  RowView view(schema.get());
+  view.Reset(buffer, RowId(1, 2));
+  ASSERT_EQ(RowId(1, 2), view.GetRowId());
+  ASSERT_EQ(4, view.GetFieldCount());
+  // fields can be decoded in any order
+  for (uint32_t i : {3, 0, 2, 1}) {
+    Field field = view.GetField(i);
+    ASSERT_EQ(fields[i].IsNull(), view.IsNull(i));
+    ASSERT_EQ(fields[i].IsNull(), field.IsNull());
+    if (!fields[i].IsNull()) {
+      ASSERT_EQ(CmpBool::kTrue, field.CompareEquals(fields[i]));
+    }
+  }
+  // a char field points into the row, the first one right behind the fixed part
+  ASSERT_EQ(buffer + schema->GetFixedRowSize(), view.GetField(1).GetData());
+  // the materialized rows own their fields
+  Row full_row;
+  Row projected_row;
+  view.ToRow(&full_row);
+  view.ToRow({3, 1}, &projected_row);
+  memset(buffer, 0, sizeof(buffer));
+  ASSERT_EQ(RowId(1, 2), full_row.GetRowId());
+  ASSERT_EQ(4, full_row.GetFieldCount());
+  ASSERT_EQ(CmpBool::kTrue, full_row.GetField(1)->CompareEquals(fields[1]));
+  ASSERT_TRUE(full_row.GetField(2)->IsNull());
+  ASSERT_EQ(2, projected_row.GetFieldCount());
+  ASSERT_EQ(CmpBool::kTrue, projected_row.GetField(0)->CompareEquals(fields[3]));
+  ASSERT_EQ(CmpBool::kTrue, projected_row.GetField(1)->CompareEquals(fields[1]));
+}
+
+TEST(TupleTest, RowFormatTest) {
+  std::vector<Column *> columns = {new Column("name", TypeId::kTypeChar, 64, 0, true, false),
+                                   new Column("id", TypeId::kTypeInt, 1, false, false),
+                                   new Column("nick", TypeId::kTypeChar, 64, 2, true, false),
+                                   new Column("account", TypeId::kTypeFloat, 3, true, false),
+                                   new Column("empty", TypeId::kTypeChar, 64, 4, true, false),
+                                   new Column("age", TypeId::kTypeInt, 5, true, false),
+                                   new Column("alias", TypeId::kTypeChar, 64, 6, true, false),
+                                   new Column("score", TypeId::kTypeFloat, 7, true, false),
+                                   new Column("note", TypeId::kTypeChar, 64, 8, true, false)};
+  Schema schema(columns);
+  std::vector<Field> fields = {Field(TypeId::kTypeChar, const_cast<char *>("minisql"), strlen("minisql"), false),
+                               Field(TypeId::kTypeInt, 188),
+                               Field(TypeId::kTypeChar),
+                               Field(TypeId::kTypeFloat, 19.99f),
+                               Field(TypeId::kTypeChar, const_cast<char *>(""), 0, false),
+                               Field(TypeId::kTypeInt),
+                               Field(TypeId::kTypeChar, const_cast<char *>("db"), strlen("db"), false),
+                               Field(TypeId::kTypeFloat),
+                               Field(TypeId::kTypeChar, const_cast<char *>("note"), strlen("note"), false)};
+  Row row(fields);
+  // 2 bytes of bitmap, 4 fixed columns, 5 char end offsets and 13 chars
+  ASSERT_EQ(2 + 4 * 4 + 5 * 2 + 13, row.GetSerializedSize(&schema));
+  char buffer[PAGE_SIZE];
+  memset(buffer, 0xff, sizeof(buffer));
+  ASSERT_EQ(row.GetSerializedSize(&schema), row.SerializeTo(buffer, &schema));
+  Row copy;
+  ASSERT_EQ(row.GetSerializedSize(&schema), copy.DeserializeFrom(buffer, &schema));
+  RowView view(&schema);
+  view.Reset(buffer, RowId(1, 2));
+  // the view is read back to front
+  for (uint32_t i = fields.size(); i-- > 0;) {
+    ASSERT_EQ(fields[i].IsNull(), copy.GetField(i)->IsNull());
+    ASSERT_EQ(fields[i].IsNull(), view.IsNull(i));
+    if (!fields[i].IsNull()) {
+      ASSERT_EQ(CmpBool::kTrue, copy.GetField(i)->CompareEquals(fields[i]));
+      ASSERT_EQ(CmpBool::kTrue, view.GetField(i).CompareEquals(fields[i]));
+    }
+  }
+  ASSERT_EQ(0, view.GetField(4).GetLength());
+  // a deserialized schema lays out its rows the same way
+  char schema_buffer[PAGE_SIZE];
+  ASSERT_EQ(schema.GetSerializedSize(), schema.SerializeTo(schema_buffer));
+  Schema *loaded = nullptr;
+  ASSERT_EQ(schema.GetSerializedSize(), Schema::DeserializeFrom(schema_buffer, loaded));
+  ASSERT_EQ(schema.GetColumnCount(), loaded->GetColumnCount());
+  ASSERT_EQ(schema.GetFixedRowSize(), loaded->GetFixedRowSize());
+  for (uint32_t i = 0; i < schema.GetColumnCount(); i++) {
+    ASSERT_EQ(schema.GetColumnOffset(i), loaded->GetColumnOffset(i));
+  }
+  delete loaded;
+}
+
+TEST(TupleTest, RowFormatBenchmark) {
+  // a wide row, the last column is read from every row
+  const int column_nums = 32;
+  const int rounds = 1000000;
+  std::vector<Column *> columns;
+  std::vector<Field> fields;
+  std::string name(16, 'x');
+  for (int i = 0; i < column_nums; i++) {
+    if (i % 2 == 0) {
+      columns.push_back(new Column("c" + std::to_string(i), TypeId::kTypeChar, 64, i, true, false));
+      fields.emplace_back(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), false);
+    } else {
+      columns.push_back(new Column("c" + std::to_string(i), TypeId::kTypeInt, i, true, false));
+      fields.emplace_back(TypeId::kTypeInt, i);
+    }
+  }
+  Schema schema(columns);
+  Row row(fields);
+  char buffer[PAGE_SIZE];
+  row.SerializeTo(buffer, &schema);
+  RowView view(&schema);
+  int64_t sum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < rounds; i++) {
+    view.Reset(buffer, RowId(1, i));
+    sum += view.GetField(column_nums - 1).CompareEquals(fields.back()) == CmpBool::kTrue;
+  }
+  auto duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  ASSERT_EQ(rounds, sum);
+  LOG(INFO) << "row size " << row.GetSerializedSize(&schema) << " bytes, last of " << column_nums
+            << " columns: " << static_cast<int64_t>(rounds / duration) << " reads/s";
+}
@@ -1,8 +1,43 @@
 #include "storage/disk_manager.h"
 
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <random>
+#include <thread>
 #include <unordered_set>
+#include <vector>
 
+#include "glog/logging.h"
 #include "gtest/gtest.h"
+#include "storage/io_uring_io.h"
+#include "storage/page_checksum.h"
+#include "storage/thread_pool_io.h"
+
+/**
+ * Closes a file descriptor of a test when it goes out of scope, also when an ASSERT returns early.
+ */
+class ScopedFd {
+ public:
+  explicit ScopedFd(int fd) : fd_(fd) {}
+
+  ~ScopedFd() { Close(); }
+
+  DISALLOW_COPY_AND_MOVE(ScopedFd);
+
+  inline int Get() const { return fd_; }
+
+  void Close() {
+    if (fd_ >= 0) {
+      close(fd_);
+      fd_ = -1;
+    }
+  }
+
+ private:
+  int fd_;
+};
 
 TEST(DiskManagerTest, BitMapPageTest) {
   const size_t size = 512;
@@ -34,6 +69,92 @@ TEST(DiskManagerTest, BitMapPageTest) {
   ASSERT_FALSE(bitmap->AllocatePage(ofs));
 }
 
+TEST(DiskManagerTest, BitMapPageRunTest) {
+  const size_t size = 512;
+  char buf[size];
+  memset(buf, 0, size);
+  BitmapPage<size> *bitmap = reinterpret_cast<BitmapPage<size> *>(buf);
+  auto num_pages = bitmap->GetMaxSupportedSize();
+  uint32_t ofs;
+  ASSERT_TRUE(bitmap->AllocatePages(100, ofs));
+  ASSERT_EQ(0, ofs);
+  ASSERT_TRUE(bitmap->AllocatePages(num_pages - 200, ofs));
+  ASSERT_EQ(100, ofs);
+  ASSERT_FALSE(bitmap->AllocatePages(101, ofs));
+  // holes of 1, 2 and 70 pages, the last one crossing a word boundary
+  ASSERT_TRUE(bitmap->DeAllocatePage(3));
+  ASSERT_TRUE(bitmap->DeAllocatePage(10));
+  ASSERT_TRUE(bitmap->DeAllocatePage(11));
+  for (uint32_t i = 50; i < 120; i++) {
+    ASSERT_TRUE(bitmap->DeAllocatePage(i));
+  }
+  ASSERT_TRUE(bitmap->AllocatePages(2, ofs));
+  ASSERT_EQ(10, ofs);
+  ASSERT_TRUE(bitmap->AllocatePages(70, ofs));
+  ASSERT_EQ(50, ofs);
+  ASSERT_TRUE(bitmap->AllocatePages(100, ofs));
+  ASSERT_EQ(num_pages - 100, ofs);
+  // the hint still points at the small hole
+  ASSERT_TRUE(bitmap->AllocatePage(ofs));
+  ASSERT_EQ(3, ofs);
+  ASSERT_FALSE(bitmap->AllocatePage(ofs));
+  for (uint32_t i = 0; i < num_pages; i++) {
+    ASSERT_FALSE(bitmap->IsPageFree(i));
+  }
+}
+
+TEST(DiskManagerTest, BitMapPageSkipTest) {
+  // a full word of allocated pages is skipped, the free ones behind it are found; configure with
+  // -DMINISQL_ENABLE_AVX2=ON to cover the vectorized skip
+  char buf[PAGE_SIZE];
+  memset(buf, 0, PAGE_SIZE);
+  BitmapPage<PAGE_SIZE> *bitmap = reinterpret_cast<BitmapPage<PAGE_SIZE> *>(buf);
+  uint32_t ofs;
+  for (uint32_t i = 0; i < 64; i++) {
+    ASSERT_TRUE(bitmap->AllocatePage(ofs));
+  }
+  ASSERT_TRUE(bitmap->DeAllocatePage(5));
+  ASSERT_TRUE(bitmap->AllocatePage(ofs));
+  ASSERT_EQ(5, ofs);
+  ASSERT_TRUE(bitmap->AllocatePage(ofs));
+  ASSERT_EQ(64, ofs);
+  // and allocated pages behind free words when looking for allocated ones
+  for (uint32_t i = 0; i <= 64; i++) {
+    ASSERT_TRUE(bitmap->DeAllocatePage(i));
+  }
+  ASSERT_TRUE(bitmap->AllocatePages(300, ofs));
+  for (uint32_t i = 0; i < 299; i++) {
+    ASSERT_TRUE(bitmap->DeAllocatePage(i));
+  }
+  for (uint32_t i = 0; i < bitmap->GetMaxSupportedSize(); i++) {
+    ASSERT_EQ(i != 299, bitmap->IsPageFree(i));
+  }
+}
+
+TEST(DiskManagerTest, BitMapPageScanBenchmark) {
+  char buf[PAGE_SIZE];
+  memset(buf, 0, PAGE_SIZE);
+  BitmapPage<PAGE_SIZE> *bitmap = reinterpret_cast<BitmapPage<PAGE_SIZE> *>(buf);
+  const uint32_t num_pages = bitmap->GetMaxSupportedSize();
+  uint32_t ofs;
+  for (uint32_t i = 0; i < num_pages; i++) {
+    ASSERT_TRUE(bitmap->AllocatePage(ofs));
+  }
+  // Scenario: a nearly full extent, the only free pages are at the end and the scan starts at the front each time.
+  const int num_rounds = 20000;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_rounds; i++) {
+    ASSERT_TRUE(bitmap->DeAllocatePage(0));
+    ASSERT_TRUE(bitmap->DeAllocatePage(num_pages - 1 - i % 8));
+    ASSERT_TRUE(bitmap->AllocatePage(ofs));
+    ASSERT_EQ(0, ofs);
+    ASSERT_TRUE(bitmap->AllocatePage(ofs));
+    ASSERT_EQ(num_pages - 1 - i % 8, ofs);
+  }
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  LOG(INFO) << "nearly full extent: " << elapsed.count() / num_rounds / 2 << " ns per allocation";
+}
+
 TEST(DiskManagerTest, FreePageAllocationTest) {
   std::string db_name = "disk_test.db";
   remove(db_name.c_str());
@@ -87,4 +208,364 @@ TEST(DiskManagerTest, IsPageFreeTest) {
   EXPECT_EQ(DiskManager::BITMAP_SIZE - 2, meta_page->GetExtentUsedPage(0));
   EXPECT_EQ(DiskManager::BITMAP_SIZE - 3, meta_page->GetExtentUsedPage(1));
   remove(db_name.c_str());
-}
\ No newline at end of file
+}
+
+TEST(DiskManagerTest, FlushMetadataTest) {
+  std::string db_name = "disk_flush_meta_test.db";
+  remove(db_name.c_str());
+  DiskManager disk_mgr(db_name);
+  uint32_t page_nums = DiskManager::BITMAP_SIZE + 10;
+  for (uint32_t i = 0; i < page_nums; i++) {
+    ASSERT_EQ(i, disk_mgr.AllocatePage());
+  }
+  disk_mgr.DeAllocatePage(3);
+  // the allocation is on disk while the file is still open, as if it was opened again after a crash
+  disk_mgr.FlushMetadata();
+  {
+    DiskManager reopened(db_name);
+    DiskFileMetaPage *meta_page = reinterpret_cast<DiskFileMetaPage *>(reopened.GetMetaData());
+    EXPECT_EQ(page_nums - 1, meta_page->GetAllocatedPages());
+    EXPECT_EQ(2, meta_page->GetExtentNums());
+    for (uint32_t i = 0; i < page_nums; i++) {
+      EXPECT_EQ(i == 3, reopened.IsPageFree(i));
+    }
+    EXPECT_TRUE(reopened.IsPageFree(page_nums));
+  }
+  disk_mgr.Close();
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, ReadWritePageTest) {
+  std::string db_name = "disk_rw_test.db";
+  for (bool direct_io : {false, true}) {
+    remove(db_name.c_str());
+    DiskManager *disk_mgr = new DiskManager(db_name, direct_io);
+    // one byte off, so that O_DIRECT has to go through the bounce buffer
+    char buf[PAGE_SIZE + 1];
+    char *data = buf + 1;
+    const int num_pages = 64;
+    for (int i = 0; i < num_pages; i++) {
+      memset(data, 'a' + i % 26, PAGE_SIZE);
+      disk_mgr->WritePage(i, data);
+    }
+    // pages past the end of the file read as zeros
+    disk_mgr->ReadPage(num_pages, data);
+    EXPECT_EQ(0, data[0]);
+    EXPECT_EQ(0, data[PAGE_SIZE - 1]);
+    disk_mgr->Close();
+    delete disk_mgr;
+
+    // Scenario: the pages survive reopening and can be read by several threads at once.
+    disk_mgr = new DiskManager(db_name, direct_io);
+    std::vector<std::thread> threads;
+    std::vector<int> num_errors(4, 0);
+    for (size_t t = 0; t < num_errors.size(); t++) {
+      threads.emplace_back([&, t] {
+        char page[PAGE_SIZE];
+        for (int i = 0; i < num_pages; i++) {
+          disk_mgr->ReadPage(i, page);
+          if (page[0] != 'a' + i % 26 || page[PAGE_SIZE - 1] != 'a' + i % 26) {
+            num_errors[t]++;
+          }
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    for (int errors : num_errors) {
+      EXPECT_EQ(0, errors);
+    }
+    delete disk_mgr;
+  }
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, BatchReadWriteTest) {
+  std::string db_name = "disk_batch_test.db";
+  for (auto io_backend : {IOBackendType::kIOUring, IOBackendType::kThreadPool}) {
+    remove(db_name.c_str());
+    DiskManager *disk_mgr = new DiskManager(db_name, true, io_backend);
+    const int num_pages = 256;
+    std::vector<std::vector<char>> pages(num_pages, std::vector<char>(PAGE_SIZE + 1));
+    std::vector<std::pair<page_id_t, const char *>> writes;
+    for (int i = 0; i < num_pages; i++) {
+      // odd pages are one byte off, so that part of the batch needs the synchronous path
+      char *data = pages[i].data() + i % 2;
+      memset(data, 'a' + i % 26, PAGE_SIZE);
+      writes.emplace_back(i, data);
+    }
+    disk_mgr->WritePages(writes);
+    for (auto &page : pages) {
+      memset(page.data(), 0, page.size());
+    }
+    std::vector<std::pair<page_id_t, char *>> reads;
+    for (int i = num_pages - 1; i >= 0; i--) {
+      reads.emplace_back(i, pages[i].data() + i % 2);
+    }
+    disk_mgr->ReadPages(reads);
+    for (int i = 0; i < num_pages; i++) {
+      char *data = pages[i].data() + i % 2;
+      ASSERT_EQ('a' + i % 26, data[0]);
+      ASSERT_EQ('a' + i % 26, data[PAGE_SIZE - 1]);
+    }
+    delete disk_mgr;
+  }
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, QueueDepthBenchmark) {
+  std::string db_name = "disk_qd_test.db";
+  remove(db_name.c_str());
+  const size_t num_pages = 1024;
+  const size_t num_reads = 4096;
+  {
+    DiskManager disk_mgr(db_name);
+    char data[PAGE_SIZE];
+    memset(data, 'x', PAGE_SIZE);
+    for (size_t i = 0; i < num_pages; i++) {
+      disk_mgr.WritePage(i, data);
+    }
+  }
+  int direct_fd = open(db_name.c_str(), O_RDONLY | O_DIRECT);
+  ScopedFd fd(direct_fd >= 0 ? direct_fd : open(db_name.c_str(), O_RDONLY));
+  ASSERT_GE(fd.Get(), 0);
+  std::unique_ptr<char, decltype(&free)> buffers(static_cast<char *>(aligned_alloc(4096, num_reads * PAGE_SIZE)),
+                                                 &free);
+  std::mt19937 rng(0);
+  std::vector<IORequest> requests(num_reads);
+  for (size_t i = 0; i < num_reads; i++) {
+    requests[i] = {false, (rng() % num_pages + 1) * PAGE_SIZE, buffers.get() + i * PAGE_SIZE, 0};
+  }
+  for (unsigned queue_depth : {1, 2, 4, 8, 16, 32, 64}) {
+    IOUringIO io_uring(fd.Get(), queue_depth);
+    ThreadPoolIO thread_pool(fd.Get(), queue_depth);
+    std::vector<std::pair<const char *, AsyncIO *>> backends{{"thread pool", &thread_pool}};
+    if (io_uring.IsAvailable()) {
+      backends.emplace_back("io_uring", &io_uring);
+    }
+    for (auto &backend : backends) {
+      auto start = std::chrono::steady_clock::now();
+      backend.second->SubmitAndWait(requests);
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      for (auto &request : requests) {
+        ASSERT_EQ(static_cast<ssize_t>(PAGE_SIZE), request.result);
+      }
+      LOG(INFO) << backend.first << " queue depth " << queue_depth << ": "
+                << static_cast<size_t>(num_reads / elapsed.count()) << " reads/s";
+    }
+  }
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, AllocatePagesTest) {
+  std::string db_name = "disk_alloc_test.db";
+  remove(db_name.c_str());
+  DiskManager *disk_mgr = new DiskManager(db_name);
+  // a batch spanning two extents comes back as one run
+  auto runs = disk_mgr->AllocatePages(DiskManager::BITMAP_SIZE + 10);
+  ASSERT_EQ(1, runs.size());
+  EXPECT_EQ(0, runs[0].first);
+  EXPECT_EQ(DiskManager::BITMAP_SIZE + 10, runs[0].second);
+  // a batch goes to the first hole which fits it as a whole
+  disk_mgr->DeAllocatePage(DiskManager::BITMAP_SIZE + 3);
+  disk_mgr->DeAllocatePage(5);
+  disk_mgr->DeAllocatePage(6);
+  runs = disk_mgr->AllocatePages(4);
+  ASSERT_EQ(1, runs.size());
+  EXPECT_EQ(std::make_pair(static_cast<page_id_t>(DiskManager::BITMAP_SIZE + 10), 4u), runs[0]);
+  // single pages fill the holes, lowest extent first
+  runs = disk_mgr->AllocatePages(1);
+  ASSERT_EQ(1, runs.size());
+  EXPECT_EQ(std::make_pair(5, 1u), runs[0]);
+  disk_mgr->DeAllocatePage(7);
+  delete disk_mgr;
+
+  // Scenario: the cached bitmaps are written back on close.
+  disk_mgr = new DiskManager(db_name);
+  DiskFileMetaPage *meta_page = reinterpret_cast<DiskFileMetaPage *>(disk_mgr->GetMetaData());
+  EXPECT_EQ(DiskManager::BITMAP_SIZE + 11, meta_page->GetAllocatedPages());
+  EXPECT_TRUE(disk_mgr->IsPageFree(6));
+  EXPECT_TRUE(disk_mgr->IsPageFree(7));
+  EXPECT_FALSE(disk_mgr->IsPageFree(8));
+  EXPECT_TRUE(disk_mgr->IsPageFree(DiskManager::BITMAP_SIZE + 3));
+  EXPECT_EQ(6, disk_mgr->AllocatePage());
+  EXPECT_EQ(7, disk_mgr->AllocatePage());
+  EXPECT_EQ(DiskManager::BITMAP_SIZE + 3, disk_mgr->AllocatePage());
+  EXPECT_EQ(DiskManager::BITMAP_SIZE + 14, disk_mgr->AllocatePage());
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, PageChecksumTest) {
+  EXPECT_EQ(0xE3069283, Crc32c("123456789", 9));
+  std::string db_name = "disk_checksum_test.db";
+  remove(db_name.c_str());
+  DiskManager *disk_mgr = new DiskManager(db_name, false, IOBackendType::kIOUring, false, true);
+  ASSERT_TRUE(disk_mgr->HasChecksums());
+  char data[PAGE_SIZE];
+  const int num_pages = 8;
+  for (int i = 0; i < num_pages; i++) {
+    memset(data, 'a' + i, PAGE_SIZE);
+    disk_mgr->WritePage(i, data);
+  }
+  // the caller's page is not touched by stamping the checksum
+  EXPECT_EQ('a' + num_pages - 1, data[PAGE_SIZE - 1]);
+  delete disk_mgr;
+
+  // Scenario: an existing file keeps its setting, and pages verify after reopening.
+  disk_mgr = new DiskManager(db_name);
+  ASSERT_TRUE(disk_mgr->HasChecksums());
+  for (int i = 0; i < num_pages; i++) {
+    ASSERT_TRUE(disk_mgr->ReadPage(i, data));
+    EXPECT_EQ('a' + i, data[0]);
+    EXPECT_EQ('a' + i, data[PAGE_USABLE_SIZE - 1]);
+  }
+  // pages which were never written read as zeros
+  ASSERT_TRUE(disk_mgr->ReadPage(num_pages + 100, data));
+  EXPECT_EQ(0, data[0]);
+
+  // Scenario: a torn write is detected by single and batched reads.
+  ScopedFd fd(open(db_name.c_str(), O_WRONLY));
+  ASSERT_GE(fd.Get(), 0);
+  char torn[512];
+  memset(torn, 'z', sizeof(torn));
+  // logical page 3 is physical page 5, behind the meta page and the first bitmap
+  ASSERT_EQ(static_cast<ssize_t>(sizeof(torn)), pwrite(fd.Get(), torn, sizeof(torn), 5 * PAGE_SIZE + 1024));
+  fd.Close();
+  EXPECT_FALSE(disk_mgr->ReadPage(3, data));
+  EXPECT_TRUE(disk_mgr->ReadPage(2, data));
+  std::vector<std::vector<char>> pages(num_pages, std::vector<char>(PAGE_SIZE));
+  std::vector<std::pair<page_id_t, char *>> reads;
+  for (int i = 0; i < num_pages; i++) {
+    reads.emplace_back(i, pages[i].data());
+  }
+  std::vector<bool> valid_pages;
+  EXPECT_FALSE(disk_mgr->ReadPages(reads, &valid_pages));
+  // only the torn page is reported, the rest of the batch is good
+  ASSERT_EQ(reads.size(), valid_pages.size());
+  for (int i = 0; i < num_pages; i++) {
+    EXPECT_EQ(i != 3, valid_pages[i]);
+  }
+  reads.erase(reads.begin() + 3);
+  EXPECT_TRUE(disk_mgr->ReadPages(reads));
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, Crc32cTest) {
+  // one bit at a time, without the tables and the combined stripes of Crc32c
+  auto crc32c_bitwise = [](const char *data, size_t len) {
+    uint32_t crc = ~0U;
+    for (size_t i = 0; i < len; i++) {
+      crc ^= static_cast<uint8_t>(data[i]);
+      for (int j = 0; j < 8; j++) {
+        crc = (crc >> 1) ^ (crc & 1 ? 0x82F63B78 : 0);
+      }
+    }
+    return ~crc;
+  };
+  std::mt19937 rng(0);
+  std::vector<char> data(4 * PAGE_SIZE + 1);
+  for (auto &c : data) {
+    c = static_cast<char>(rng());
+  }
+  // short tails, and inputs of one, two and three blocks of three stripes of a third of 4 KB each
+  std::vector<size_t> lens{4079, 4080, 4081, 4087, 4088, PAGE_USABLE_SIZE, 8159, 8160, 8167, 12240, 12247};
+  lens.push_back(4 * PAGE_SIZE);
+  for (size_t len = 0; len <= 64; len++) {
+    lens.push_back(len);
+  }
+  for (size_t len : lens) {
+    // at an aligned and at an unaligned start
+    EXPECT_EQ(crc32c_bitwise(data.data(), len), Crc32c(data.data(), len)) << "length " << len;
+    EXPECT_EQ(crc32c_bitwise(data.data() + 1, len), Crc32c(data.data() + 1, len)) << "length " << len;
+  }
+}
+
+TEST(DiskManagerTest, PageChecksumBenchmark) {
+  const int num_pages = 1024;
+  const int num_rounds = 20;
+  char data[PAGE_SIZE];
+  memset(data, 'x', PAGE_SIZE);
+  double seconds[2];
+  for (bool page_checksums : {false, true}) {
+    std::string db_name = "disk_checksum_bench.db";
+    remove(db_name.c_str());
+    DiskManager disk_mgr(db_name, false, IOBackendType::kIOUring, false, page_checksums);
+    for (int i = 0; i < num_pages; i++) {
+      disk_mgr.WritePage(i, data);
+    }
+    // Scenario: the pages are in the OS page cache, so the read path is all CPU.
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < num_rounds; round++) {
+      for (int i = 0; i < num_pages; i++) {
+        ASSERT_TRUE(disk_mgr.ReadPage(i, data));
+      }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    seconds[page_checksums] = elapsed.count();
+    remove(db_name.c_str());
+  }
+  auto start = std::chrono::steady_clock::now();
+  uint32_t crc = 0;
+  for (int i = 0; i < num_pages * num_rounds; i++) {
+    crc ^= Crc32c(data, PAGE_USABLE_SIZE);
+  }
+  std::chrono::duration<double> crc_seconds = std::chrono::steady_clock::now() - start;
+  LOG(INFO) << "cached page reads: " << static_cast<size_t>(num_pages * num_rounds / seconds[0]) << " reads/s plain, "
+            << static_cast<size_t>(num_pages * num_rounds / seconds[1]) << " reads/s with checksums, overhead "
+            << (seconds[1] / seconds[0] - 1) * 100 << "%; crc32c " << num_pages * num_rounds / crc_seconds.count()
+            << " pages/s (" << crc << ")";
+}
+
+TEST(DiskManagerTest, PageSizeTest) {
+  std::string db_name = "disk_page_size_test.db";
+  remove(db_name.c_str());
+  DiskManager *disk_mgr = new DiskManager(db_name);
+  char data[PAGE_SIZE];
+  memset(data, 'a', PAGE_SIZE);
+  disk_mgr->WritePage(disk_mgr->AllocatePage(), data);
+  delete disk_mgr;
+
+  // the meta page records the page size of the build which created the file
+  ScopedFd fd(open(db_name.c_str(), O_RDWR));
+  ASSERT_GE(fd.Get(), 0);
+  uint32_t page_size;
+  off_t offset = offsetof(DiskFileMetaPage, page_size_);
+  ASSERT_EQ(static_cast<ssize_t>(sizeof(page_size)), pread(fd.Get(), &page_size, sizeof(page_size), offset));
+  EXPECT_EQ(static_cast<uint32_t>(PAGE_SIZE), page_size);
+
+  // Scenario: a file with another page size is refused.
+  page_size = PAGE_SIZE * 2;
+  ASSERT_EQ(static_cast<ssize_t>(sizeof(page_size)), pwrite(fd.Get(), &page_size, sizeof(page_size), offset));
+  fd.Close();
+  EXPECT_THROW(DiskManager{db_name}, std::runtime_error);
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, FormatVersionTest) {
+  std::string db_name = "disk_format_version_test.db";
+  remove(db_name.c_str());
+  DiskManager *disk_mgr = new DiskManager(db_name);
+  disk_mgr->AllocatePage();
+  delete disk_mgr;
+  disk_mgr = new DiskManager(db_name);
+  DiskFileMetaPage *meta_page = reinterpret_cast<DiskFileMetaPage *>(disk_mgr->GetMetaData());
+  EXPECT_EQ(DISK_FILE_FORMAT_VERSION, meta_page->GetFormatVersion());
+  delete disk_mgr;
+
+  // Scenario: a file of the unversioned layout, with one page in three extents each, is refused.
+  ScopedFd fd(open(db_name.c_str(), O_RDWR));
+  ASSERT_GE(fd.Get(), 0);
+  uint32_t legacy_meta[] = {3, 3, 1, 1, 1};
+  ASSERT_EQ(static_cast<ssize_t>(sizeof(legacy_meta)), pwrite(fd.Get(), legacy_meta, sizeof(legacy_meta), 0));
+  fd.Close();
+  try {
+    DiskManager legacy_mgr(db_name);
+    FAIL() << "A file of the unversioned layout is opened";
+  } catch (const std::runtime_error &e) {
+    EXPECT_NE(std::string::npos, std::string(e.what()).find("older file format"));
+  }
+  remove(db_name.c_str());
+}
@@ -1,17 +1,75 @@
 #include "storage/table_heap.h"
 
+#include <chrono>
+#include <map>
+#include <set>
 #include <unordered_map>
 #include <vector>
 
 #include "common/instance.h"
 #include "gtest/gtest.h"
+#include "planner/expressions/column_value_expression.h"
+#include "planner/expressions/comparison_expression.h"
+#include "planner/expressions/constant_value_expression.h"
 #include "record/field.h"
 #include "record/schema.h"
+#include "storage/table_scanner.h"
 #include "utils/utils.h"
 
 static string db_file_name = "table_heap_test.db";
 using Fields = std::vector<Field>;
 
+/**
+ * A table heap of (id, name) rows in a db file of its own, which is removed again when the test ends.
+ */
+class TestTableHeap {
+ public:
+  explicit TestTableHeap(std::string db_name) : db_name_(std::move(db_name)) {
+    remove(db_name_.c_str());
+    std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                     new Column("name", TypeId::kTypeChar, 256, 1, true, false)};
+    schema_ = std::make_shared<Schema>(columns);
+    Open();
+    table_heap_ = TableHeap::Create(bpm_, schema_.get(), nullptr, nullptr, nullptr);
+  }
+
+  ~TestTableHeap() {
+    Close();
+    remove(db_name_.c_str());
+  }
+
+  /** Close the db file and open the heap in it again, with its free space map. */
+  void Reopen() {
+    page_id_t first_page_id = table_heap_->GetFirstPageId();
+    page_id_t map_page_id = table_heap_->GetFreeSpaceMapPageId();
+    Close();
+    Open();
+    table_heap_ = TableHeap::Create(bpm_, first_page_id, schema_.get(), nullptr, nullptr, map_page_id);
+  }
+
+  inline TableHeap *GetTableHeap() { return table_heap_; }
+
+  inline BufferPoolManager *GetBufferPoolManager() { return bpm_; }
+
+ private:
+  void Open() {
+    disk_mgr_ = new DiskManager(db_name_);
+    bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  }
+
+  void Close() {
+    delete table_heap_;
+    delete bpm_;
+    delete disk_mgr_;
+  }
+
+  std::string db_name_;
+  std::shared_ptr<Schema> schema_;
+  DiskManager *disk_mgr_{nullptr};
+  BufferPoolManager *bpm_{nullptr};
+  TableHeap *table_heap_{nullptr};
+};
+
 TEST(TableHeapTest, Reset){
   std::string db_name = "table_heap_test.db";
   std::ofstream f(db_name, std::ios::trunc);
@@ -149,4 +207,346 @@ TEST(TableHeapTest, TableHeapSelfTest) {
     ASSERT_EQ(CmpBool::kTrue, testUpdated.GetField(i)->CompareEquals(updated_fields->at(i)));
   }
   LOG(INFO)<<"Done!";
-}
\ No newline at end of file
+}
+
+TEST(TableHeapTest, ScanBenchmark) {
+  const int row_nums = 10000;
+  const int num_rounds = 10;
+  TestTableHeap table("table_heap_bench.db");
+  TableHeap *table_heap = table.GetTableHeap();
+  std::string name(200, 'x');
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i),
+                  Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+  }
+  auto start = std::chrono::steady_clock::now();
+  for (int round = 0; round < num_rounds; round++) {
+    int count = 0;
+    for (auto it = table_heap->Begin(nullptr); it != table_heap->End(); ++it) {
+      count++;
+    }
+    ASSERT_EQ(row_nums, count);
+  }
+  auto duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  LOG(INFO) << "page size: " << PAGE_SIZE
+            << ", scan throughput: " << static_cast<int64_t>(row_nums * num_rounds / duration) << " rows/s";
+}
+
+TEST(TableHeapTest, RowViewScanBenchmark) {
+  const int row_nums = 10000;
+  const int num_rounds = 10;
+  TestTableHeap table("table_heap_view_bench.db");
+  TableHeap *table_heap = table.GetTableHeap();
+  std::string name(200, 'x');
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i),
+                  Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+  }
+  // id < row_nums / 10, evaluated on deserialized rows and on views
+  auto predicate = std::make_shared<ComparisonExpression>(
+      std::make_shared<ColumnValueExpression>(0, 0, TypeId::kTypeInt),
+      std::make_shared<ConstantValueExpression>(Field(TypeId::kTypeInt, row_nums / 10)), "<");
+  auto start = std::chrono::steady_clock::now();
+  for (int round = 0; round < num_rounds; round++) {
+    int count = 0;
+    for (auto it = table_heap->Begin(nullptr); it != table_heap->End(); ++it) {
+      if (predicate->Evaluate(&*it).CompareEquals(Field(TypeId::kTypeInt, 1)) == CmpBool::kTrue) {
+        count++;
+      }
+    }
+    ASSERT_EQ(row_nums / 10, count);
+  }
+  auto row_duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  start = std::chrono::steady_clock::now();
+  for (int round = 0; round < num_rounds; round++) {
+    int count = 0;
+    TableScanner scanner(table_heap, nullptr);
+    while (scanner.Next([&](const RowView &view) {
+      return predicate->Evaluate(view).CompareEquals(Field(TypeId::kTypeInt, 1)) == CmpBool::kTrue;
+    })) {
+      count++;
+    }
+    ASSERT_EQ(row_nums / 10, count);
+  }
+  auto view_duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  LOG(INFO) << "filtered scan throughput, rows: " << static_cast<int64_t>(row_nums * num_rounds / row_duration)
+            << " rows/s, views: " << static_cast<int64_t>(row_nums * num_rounds / view_duration) << " rows/s";
+}
+
+TEST(TableHeapTest, FreeSpaceMapTest) {
+  const int row_nums = 2000;
+  TestTableHeap table("table_heap_fsm_test.db");
+  TableHeap *table_heap = table.GetTableHeap();
+  std::string name(100, 'x');
+  auto insert_row = [&](int id) {
+    Fields fields{Field(TypeId::kTypeInt, id),
+                  Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)};
+    Row row(fields);
+    EXPECT_TRUE(table_heap->InsertTuple(row, nullptr));
+    return row.GetRowId();
+  };
+  std::vector<RowId> rids;
+  std::set<page_id_t> pages;
+  for (int i = 0; i < row_nums; i++) {
+    rids.push_back(insert_row(i));
+    pages.insert(rids.back().GetPageId());
+  }
+  ASSERT_GT(pages.size(), 10U);
+
+  // Scenario: space freed by deletes is reused before the heap grows.
+  for (int i = 0; i < row_nums; i += 2) {
+    ASSERT_TRUE(table_heap->MarkDelete(rids[i], nullptr));
+    table_heap->ApplyDelete(rids[i], nullptr);
+  }
+  for (int i = 0; i < row_nums / 2; i++) {
+    RowId rid = insert_row(row_nums + i);
+    ASSERT_EQ(1U, pages.count(rid.GetPageId()));
+  }
+
+  // Scenario: the map is stored with the heap. After reopening, an insert goes to the page which has room.
+  page_id_t target_page_id = rids[row_nums / 2].GetPageId();
+  auto it = table_heap->Begin(nullptr);
+  std::vector<RowId> target_rids;
+  for (; it != table_heap->End(); ++it) {
+    if (it->GetRowId().GetPageId() == target_page_id) {
+      target_rids.push_back(it->GetRowId());
+    }
+  }
+  for (auto &rid : target_rids) {
+    ASSERT_TRUE(table_heap->MarkDelete(rid, nullptr));
+    table_heap->ApplyDelete(rid, nullptr);
+  }
+  ASSERT_NE(INVALID_PAGE_ID, table_heap->GetFreeSpaceMapPageId());
+  table.Reopen();
+  table_heap = table.GetTableHeap();
+  EXPECT_EQ(target_page_id, insert_row(0).GetPageId());
+}
+
+TEST(TableHeapTest, InsertBenchmark) {
+  const int rows_per_round = 20000;
+  const int num_rounds = 5;
+  TestTableHeap table("table_heap_insert_bench.db");
+  TableHeap *table_heap = table.GetTableHeap();
+  std::string name(200, 'x');
+  // the cost of an insert must not grow with the table
+  for (int round = 0; round < num_rounds; round++) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rows_per_round; i++) {
+      Fields fields{Field(TypeId::kTypeInt, round * rows_per_round + i),
+                    Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)};
+      Row row(fields);
+      ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    }
+    auto duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    LOG(INFO) << "table size: " << round * rows_per_round
+              << " rows, insert throughput: " << static_cast<int64_t>(rows_per_round / duration) << " rows/s";
+  }
+}
+
+TEST(TableHeapTest, InsertTuplesTest) {
+  const int row_nums = 3000;
+  TestTableHeap table("table_heap_insert_tuples_test.db");
+  TableHeap *table_heap = table.GetTableHeap();
+  std::string name(100, 'x');
+  std::vector<Row> rows;
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i),
+                  Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)};
+    rows.emplace_back(fields);
+  }
+  // the first half fills the heap, the second half goes into the room left on its last page
+  std::vector<Row> first_half(rows.begin(), rows.begin() + row_nums / 2);
+  std::vector<Row> second_half(rows.begin() + row_nums / 2, rows.end());
+  ASSERT_EQ(first_half.size(), table_heap->InsertTuples(first_half, nullptr));
+  ASSERT_EQ(second_half.size(), table_heap->InsertTuples(second_half, nullptr));
+  std::vector<Row> inserted(first_half);
+  inserted.insert(inserted.end(), second_half.begin(), second_half.end());
+  // the rows are packed in order, a page is only left for the next one when it is full
+  std::unordered_map<page_id_t, int> rows_per_page;
+  for (int i = 0; i < row_nums; i++) {
+    RowId rid = inserted[i].GetRowId();
+    ASSERT_NE(INVALID_PAGE_ID, rid.GetPageId());
+    if (i > 0 && rid.GetPageId() == inserted[i - 1].GetRowId().GetPageId()) {
+      ASSERT_EQ(inserted[i - 1].GetRowId().GetSlotNum() + 1, rid.GetSlotNum());
+    }
+    rows_per_page[rid.GetPageId()]++;
+    Row row(rid);
+    ASSERT_TRUE(table_heap->GetTuple(&row, nullptr));
+    ASSERT_EQ(CmpBool::kTrue, row.GetField(0)->CompareEquals(*inserted[i].GetField(0)));
+  }
+  int rows_per_full_page = rows_per_page[inserted[0].GetRowId().GetPageId()];
+  ASSERT_EQ((row_nums + rows_per_full_page - 1) / rows_per_full_page, rows_per_page.size());
+  // single inserts find the same pages
+  Row row(rows[0]);
+  ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+  ASSERT_EQ(inserted.back().GetRowId().GetPageId(), row.GetRowId().GetPageId());
+}
+
+TEST(TableHeapTest, InsertTuplesBenchmark) {
+  const int rows_per_round = 20000;
+  const int num_rounds = 5;
+  TestTableHeap table("table_heap_insert_tuples_bench.db");
+  TableHeap *table_heap = table.GetTableHeap();
+  std::string name(200, 'x');
+  // same rows as InsertBenchmark, handed to the heap INSERT_BATCH_SIZE at a time
+  for (int round = 0; round < num_rounds; round++) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rows_per_round; i += INSERT_BATCH_SIZE) {
+      std::vector<Row> rows;
+      for (int j = i; j < std::min(i + INSERT_BATCH_SIZE, rows_per_round); j++) {
+        Fields fields{Field(TypeId::kTypeInt, round * rows_per_round + j),
+                      Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)};
+        rows.emplace_back(fields);
+      }
+      ASSERT_EQ(rows.size(), table_heap->InsertTuples(rows, nullptr));
+    }
+    auto duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    LOG(INFO) << "table size: " << round * rows_per_round
+              << " rows, batch insert throughput: " << static_cast<int64_t>(rows_per_round / duration) << " rows/s";
+  }
+}
+
+TEST(TableHeapTest, PageCompactionTest) {
+  const int row_nums = 1000;
+  TestTableHeap table("table_heap_compaction_test.db");
+  TableHeap *table_heap = table.GetTableHeap();
+  auto make_row = [&](int id, const std::string &name) {
+    Fields fields{Field(TypeId::kTypeInt, id),
+                  Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)};
+    return Row(fields);
+  };
+  auto check_row = [&](const RowId &rid, int id, const std::string &name) {
+    Row row(rid);
+    ASSERT_TRUE(table_heap->GetTuple(&row, nullptr));
+    Row expected = make_row(id, name);
+    ASSERT_EQ(CmpBool::kTrue, row.GetField(0)->CompareEquals(*expected.GetField(0)));
+    ASSERT_EQ(CmpBool::kTrue, row.GetField(1)->CompareEquals(*expected.GetField(1)));
+  };
+  std::string short_name(20, 'a');
+  std::string long_name(200, 'b');
+  std::vector<RowId> rids;
+  for (int i = 0; i < row_nums; i++) {
+    Row row = make_row(i, short_name);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    rids.push_back(row.GetRowId());
+  }
+
+  // Scenario: a page reuses the slots of its deleted tuples, the tuples are found after the holes were compacted away.
+  std::map<page_id_t, std::set<uint32_t>> freed_slots;
+  size_t freed_count = 0;
+  for (int i = 0; i < row_nums; i += 3) {
+    ASSERT_TRUE(table_heap->MarkDelete(rids[i], nullptr));
+    table_heap->ApplyDelete(rids[i], nullptr);
+    freed_slots[rids[i].GetPageId()].insert(rids[i].GetSlotNum());
+    freed_count++;
+  }
+  size_t reused_count = 0;
+  for (int i = 0; i < row_nums; i += 3) {
+    Row row = make_row(i, short_name);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    auto &page_slots = freed_slots[row.GetRowId().GetPageId()];
+    if (!page_slots.empty()) {
+      ASSERT_EQ(1U, page_slots.erase(row.GetRowId().GetSlotNum()));
+      reused_count++;
+    }
+    rids[i] = row.GetRowId();
+  }
+  ASSERT_GT(2 * reused_count, freed_count);
+  for (int i = 0; i < row_nums; i++) {
+    check_row(rids[i], i, short_name);
+  }
+
+  // Scenario: tuples grow in place into the space freed by deleting their neighbours.
+  page_id_t page_id = rids[1].GetPageId();
+  std::vector<int> page_rows;
+  for (int i = 0; i < row_nums; i++) {
+    if (rids[i].GetPageId() == page_id) {
+      page_rows.push_back(i);
+    }
+  }
+  ASSERT_GT(page_rows.size(), 20U);
+  std::vector<int> kept;
+  for (size_t j = 0; j < page_rows.size(); j++) {
+    if (j % 10 == 0) {
+      kept.push_back(page_rows[j]);
+      continue;
+    }
+    ASSERT_TRUE(table_heap->MarkDelete(rids[page_rows[j]], nullptr));
+    table_heap->ApplyDelete(rids[page_rows[j]], nullptr);
+  }
+  for (auto i : kept) {
+    Row row = make_row(i, long_name);
+    ASSERT_TRUE(table_heap->UpdateTuple(row, rids[i], nullptr));
+  }
+  for (auto i : kept) {
+    check_row(rids[i], i, long_name);
+  }
+}
+
+TEST(TableHeapTest, VacuumTest) {
+  const int row_nums = 5000;
+  TestTableHeap table("table_heap_vacuum_test.db");
+  TableHeap *table_heap = table.GetTableHeap();
+  std::string name(100, 'x');
+  auto insert_row = [&](int id) {
+    Fields fields{Field(TypeId::kTypeInt, id),
+                  Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)};
+    Row row(fields);
+    EXPECT_TRUE(table_heap->InsertTuple(row, nullptr));
+    return row.GetRowId();
+  };
+  auto count_pages = [&]() {
+    size_t page_count = 0;
+    for (page_id_t page_id = table_heap->GetFirstPageId(); page_id != INVALID_PAGE_ID; page_count++) {
+      ReadPageGuard guard = table.GetBufferPoolManager()->FetchPageRead(page_id);
+      page_id = guard.As<TablePage>()->GetNextPageId();
+    }
+    return page_count;
+  };
+  std::vector<RowId> rids;
+  for (int i = 0; i < row_nums; i++) {
+    rids.push_back(insert_row(i));
+  }
+  size_t page_count = count_pages();
+  // deleted tuples are only marked, like the delete executor leaves them
+  for (int i = 0; i < row_nums; i++) {
+    if (i % 10 != 0) {
+      ASSERT_TRUE(table_heap->MarkDelete(rids[i], nullptr));
+    }
+  }
+  std::vector<std::pair<RowId, Row>> moved_rows;
+  ASSERT_TRUE(table_heap->Vacuum(nullptr, &moved_rows));
+  ASSERT_LE(count_pages(), page_count / 10 + 1);
+  ASSERT_FALSE(moved_rows.empty());
+  std::unordered_map<int64_t, int> rid_ids;
+  for (int i = 0; i < row_nums; i++) {
+    rid_ids.emplace(rids[i].Get(), i);
+  }
+  for (auto &[old_rid, row] : moved_rows) {
+    int id = rid_ids.at(old_rid.Get());
+    ASSERT_EQ(0, id % 10);
+    ASSERT_EQ(CmpBool::kTrue, row.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, id)));
+    rids[id] = row.GetRowId();
+  }
+  for (int i = 0; i < row_nums; i += 10) {
+    Row row(rids[i]);
+    ASSERT_TRUE(table_heap->GetTuple(&row, nullptr));
+    ASSERT_EQ(CmpBool::kTrue, row.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, i)));
+  }
+  int live_count = 0;
+  std::set<page_id_t> pages;
+  for (auto it = table_heap->Begin(nullptr); it != table_heap->End(); ++it) {
+    live_count++;
+    pages.insert(it->GetRowId().GetPageId());
+  }
+  ASSERT_EQ(row_nums / 10, live_count);
+
+  // the free space map only knows the remaining pages, also after reopening
+  table.Reopen();
+  table_heap = table.GetTableHeap();
+  ASSERT_EQ(1U, pages.count(insert_row(row_nums).GetPageId()));
+}